@@ -0,0 +1,298 @@
+//------------------------------------------------------------------------------
+//  AnimCompression.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "AnimCompression.h"
+#include "Core/Assertion.h"
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <math.h>
+
+namespace Oryol {
+
+// components other than the largest of a unit quaternion are in this range
+static const float QuatRange = 0.70710678f;
+
+//------------------------------------------------------------------------------
+static int
+numCurveValues(AnimCurveFormat::Enum fmt) {
+    switch (fmt) {
+        case AnimCurveFormat::Float:        return 1;
+        case AnimCurveFormat::Float2:       return 2;
+        case AnimCurveFormat::Float3:       return 3;
+        case AnimCurveFormat::Float4:       return 4;
+        case AnimCurveFormat::Quaternion:   return 4;
+        default:                            return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+static glm::vec4
+rawKey(const AnimClip& clip, const AnimCurve& curve, int frame, int numValues) {
+    if (curve.Static) {
+        return curve.StaticValue;
+    }
+    glm::vec4 v(0.0f);
+    const float* src = &clip.Keys[frame * clip.KeyStride + curve.KeyIndex];
+    for (int i = 0; i < numValues; i++) {
+        v[i] = src[i];
+    }
+    return v;
+}
+
+//------------------------------------------------------------------------------
+static void
+encodeQuat(glm::vec4 q, uint16_t* dst) {
+    q = glm::normalize(q);
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (fabsf(q[i]) > fabsf(q[largest])) {
+            largest = i;
+        }
+    }
+    // q and -q are the same rotation, make the dropped component positive
+    if (q[largest] < 0.0f) {
+        q = -q;
+    }
+    uint64_t bits = uint64_t(largest);
+    for (int i = 0; i < 4; i++) {
+        if (i != largest) {
+            const float n = glm::clamp((q[i] / QuatRange) * 0.5f + 0.5f, 0.0f, 1.0f);
+            bits = (bits << 15) | uint64_t(n * 32767.0f + 0.5f);
+        }
+    }
+    dst[0] = uint16_t(bits);
+    dst[1] = uint16_t(bits >> 16);
+    dst[2] = uint16_t(bits >> 32);
+}
+
+//------------------------------------------------------------------------------
+static glm::vec4
+decodeQuat(const uint16_t* src) {
+    const uint64_t bits = uint64_t(src[0]) | (uint64_t(src[1]) << 16) | (uint64_t(src[2]) << 32);
+    const int largest = int(bits >> 45) & 3;
+    glm::vec4 q;
+    float sum = 0.0f;
+    int shift = 30;
+    for (int i = 0; i < 4; i++) {
+        if (i != largest) {
+            const float n = float((bits >> shift) & 0x7FFF) / 32767.0f;
+            q[i] = (n * 2.0f - 1.0f) * QuatRange;
+            sum += q[i] * q[i];
+            shift -= 15;
+        }
+    }
+    q[largest] = sqrtf(glm::max(0.0f, 1.0f - sum));
+    return q;
+}
+
+//------------------------------------------------------------------------------
+static glm::vec4
+decodeKey(const CompressedAnimLibrary::Curve& curve, const uint16_t* src) {
+    if (AnimKeyEncoding::Quat48 == curve.Encoding) {
+        return decodeQuat(src);
+    }
+    glm::vec4 v = curve.Min;
+    for (int i = 0; i < curve.NumValues; i++) {
+        v[i] += float(src[i]) * curve.Scale[i];
+    }
+    return v;
+}
+
+//------------------------------------------------------------------------------
+static int
+numKeyWords(const CompressedAnimLibrary::Curve& curve) {
+    return (AnimKeyEncoding::Quat48 == curve.Encoding) ? 3 : curve.NumValues;
+}
+
+//------------------------------------------------------------------------------
+static glm::vec4
+interpolate(AnimKeyEncoding::Code enc, const glm::vec4& v0, const glm::vec4& v1, float w) {
+    if (AnimKeyEncoding::Quat48 == enc) {
+        // normalized lerp along the shortest path
+        const glm::vec4 v1s = (glm::dot(v0, v1) < 0.0f) ? -v1 : v1;
+        return glm::normalize(glm::mix(v0, v1s, w));
+    }
+    else {
+        return glm::mix(v0, v1, w);
+    }
+}
+
+//------------------------------------------------------------------------------
+static bool
+withinError(AnimKeyEncoding::Code enc, const glm::vec4& v, const glm::vec4& ref, int numValues, float maxError) {
+    const glm::vec4 r = ((AnimKeyEncoding::Quat48 == enc) && (glm::dot(v, ref) < 0.0f)) ? -ref : ref;
+    for (int i = 0; i < numValues; i++) {
+        if (fabsf(v[i] - r[i]) > maxError) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+AnimCompression::Compress(const AnimLibrary& lib, const Params& params, CompressedAnimLibrary& out) {
+    out = CompressedAnimLibrary();
+    out.SampleStride = 0;
+    for (const auto& fmt : lib.CurveLayout) {
+        out.CurveLayout.Add(fmt);
+        out.SampleStride += numCurveValues(fmt);
+    }
+    const int numCurves = out.CurveLayout.Size();
+
+    Array<glm::vec4> orig;
+    Array<glm::vec4> decoded;
+    Array<uint16_t> words;
+    for (const AnimClip& srcClip : lib.Clips) {
+        o_assert_dbg(srcClip.Curves.Size() == numCurves);
+        out.UncompressedByteSize += srcClip.Keys.Size() * sizeof(srcClip.Keys[0]);
+        auto& dstClip = out.Clips.Add();
+        dstClip.Name = srcClip.Name;
+        dstClip.Length = srcClip.Length;
+        dstClip.KeyDuration = srcClip.KeyDuration;
+        dstClip.FirstCurve = out.Curves.Size();
+        for (int curveIndex = 0; curveIndex < numCurves; curveIndex++) {
+            const AnimCurve& srcCurve = srcClip.Curves[curveIndex];
+            const AnimCurveFormat::Enum fmt = out.CurveLayout[curveIndex];
+            auto& dst = out.Curves.Add();
+            dst.NumValues = uint8_t(numCurveValues(fmt));
+            dst.FirstKey = out.KeyFrames.Size();
+            dst.FirstData = out.Data.Size();
+
+            // gather original keys and value range
+            orig.Clear();
+            glm::vec4 minVal(0.0f), maxVal(0.0f);
+            for (int frame = 0; frame < srcClip.Length; frame++) {
+                const glm::vec4 v = rawKey(srcClip, srcCurve, frame, dst.NumValues);
+                orig.Add(v);
+                minVal = (0 == frame) ? v : glm::min(minVal, v);
+                maxVal = (0 == frame) ? v : glm::max(maxVal, v);
+            }
+            if (srcCurve.Static || (srcClip.Length < 2) || (minVal == maxVal)) {
+                dst.Encoding = AnimKeyEncoding::Static;
+                dst.Min = srcCurve.Static ? srcCurve.StaticValue : minVal;
+                continue;
+            }
+
+            // quantize all keys
+            words.Clear();
+            decoded.Clear();
+            const float maxError = (AnimCurveFormat::Quaternion == fmt) ? params.MaxQuatError : params.MaxError;
+            if (AnimCurveFormat::Quaternion == fmt) {
+                dst.Encoding = AnimKeyEncoding::Quat48;
+                for (const auto& v : orig) {
+                    uint16_t w[3];
+                    encodeQuat(v, w);
+                    words.Add(w[0]); words.Add(w[1]); words.Add(w[2]);
+                    decoded.Add(decodeQuat(w));
+                }
+            }
+            else {
+                dst.Encoding = AnimKeyEncoding::Range16;
+                dst.Min = minVal;
+                dst.Scale = (maxVal - minVal) / 65535.0f;
+                for (const auto& v : orig) {
+                    uint16_t w[4] = { };
+                    for (int i = 0; i < dst.NumValues; i++) {
+                        if (dst.Scale[i] > 0.0f) {
+                            w[i] = uint16_t(glm::clamp((v[i] - minVal[i]) / dst.Scale[i] + 0.5f, 0.0f, 65535.0f));
+                        }
+                        words.Add(w[i]);
+                    }
+                    decoded.Add(decodeKey(dst, w));
+                }
+            }
+
+            // greedy key reduction: extend each segment as long as all
+            // skipped keys are reconstructed within the error bound, the
+            // first and last key are always kept
+            const int wordsPerKey = numKeyWords(dst);
+            int numKeys = 0;
+            int a = 0;
+            while (true) {
+                out.KeyFrames.Add(uint16_t(a));
+                for (int i = 0; i < wordsPerKey; i++) {
+                    out.Data.Add(words[a * wordsPerKey + i]);
+                }
+                numKeys++;
+                if (a == (srcClip.Length - 1)) {
+                    break;
+                }
+                int b = a + 1;
+                while ((b + 1) < srcClip.Length) {
+                    const int cand = b + 1;
+                    bool ok = true;
+                    for (int f = a + 1; ok && (f < cand); f++) {
+                        const float w = float(f - a) / float(cand - a);
+                        const glm::vec4 v = interpolate(dst.Encoding, decoded[a], decoded[cand], w);
+                        ok = withinError(dst.Encoding, v, orig[f], dst.NumValues, maxError);
+                    }
+                    if (!ok) {
+                        break;
+                    }
+                    b = cand;
+                }
+                a = b;
+            }
+            o_assert_dbg(numKeys < (1<<16));
+            dst.NumKeys = uint16_t(numKeys);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AnimCompression::Sample(const CompressedAnimLibrary& lib, int clipIndex, double time, float* outSamples, const uint8_t* curveMask) {
+    o_assert_dbg(outSamples);
+    const auto& clip = lib.Clips[clipIndex];
+    const int numCurves = lib.CurveLayout.Size();
+    float framePos = float(fmod(time / clip.KeyDuration, double(clip.Length)));
+    if (framePos < 0.0f) {
+        framePos += float(clip.Length);
+    }
+    const CompressedAnimLibrary::Curve* curves = &lib.Curves[clip.FirstCurve];
+    float* dst = outSamples;
+    for (int curveIndex = 0; curveIndex < numCurves; curveIndex++) {
+        const auto& curve = curves[curveIndex];
+        if (curveMask && !curveMask[curveIndex]) {
+            dst += curve.NumValues;
+            continue;
+        }
+        glm::vec4 v;
+        if (AnimKeyEncoding::Static == curve.Encoding) {
+            v = curve.Min;
+        }
+        else {
+            // find the last key at or before the sample position
+            const uint16_t* frames = &lib.KeyFrames[curve.FirstKey];
+            int lo = 0;
+            int hi = curve.NumKeys - 1;
+            while (lo < hi) {
+                const int mid = (lo + hi + 1) >> 1;
+                if (float(frames[mid]) <= framePos) {
+                    lo = mid;
+                }
+                else {
+                    hi = mid - 1;
+                }
+            }
+            // looping clip, the last key interpolates towards the first
+            const int k0 = lo;
+            const int k1 = ((k0 + 1) < curve.NumKeys) ? (k0 + 1) : 0;
+            const float f0 = float(frames[k0]);
+            const float f1 = (k1 > 0) ? float(frames[k1]) : float(clip.Length);
+            const float w = (framePos - f0) / (f1 - f0);
+            const int wordsPerKey = numKeyWords(curve);
+            const uint16_t* data = &lib.Data[curve.FirstData];
+            const glm::vec4 v0 = decodeKey(curve, data + k0 * wordsPerKey);
+            const glm::vec4 v1 = decodeKey(curve, data + k1 * wordsPerKey);
+            v = interpolate(curve.Encoding, v0, v1, w);
+        }
+        for (int i = 0; i < curve.NumValues; i++) {
+            *dst++ = v[i];
+        }
+    }
+}
+
+} // namespace Oryol
@@ -0,0 +1,95 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::AnimCompression
+    @brief compress and sample the animation keys of an AnimLibrary
+
+    Compression works per curve:
+
+    - curves where all keys are identical become static
+    - quaternion keys are stored as 'smallest three' (the index of the
+      largest component in 2 bits, the other 3 components in 15 bits
+      each, packed into three 16-bit words)
+    - all other keys are stored as 16-bit values normalized to the
+      value range of the curve
+    - keys which can be reconstructed by linear interpolation between
+      their neighbours within an error bound are removed, each curve
+      stores the frame indices of the remaining keys
+
+    Sample() produces the same sample layout as the Anim module
+    (curves in CurveLayout order, 1..4 floats per curve). An optional
+    curve mask allows to skip curves, their samples are not written.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/String/StringAtom.h"
+#include "Anim/AnimTypes.h"
+#include <glm/vec4.hpp>
+
+namespace Oryol {
+
+/// how the keys of a compressed curve are stored
+struct AnimKeyEncoding {
+    enum Code : uint8_t {
+        Static,     // no keys, value in Curve::Min
+        Quat48,     // smallest-three quaternion in 3 words
+        Range16,    // 1 word per component, normalized to curve range
+    };
+};
+
+struct CompressedAnimLibrary {
+    struct Curve {
+        AnimKeyEncoding::Code Encoding = AnimKeyEncoding::Static;
+        uint8_t NumValues = 0;
+        /// number of keys remaining after key reduction
+        uint16_t NumKeys = 0;
+        /// index of first key frame index in KeyFrames
+        int FirstKey = 0;
+        /// index of first data word in Data
+        int FirstData = 0;
+        /// static value, or range minimum
+        glm::vec4 Min;
+        /// range extent / 65535
+        glm::vec4 Scale;
+    };
+    struct Clip {
+        StringAtom Name;
+        int Length = 0;
+        float KeyDuration = 0.0f;
+        int FirstCurve = 0;
+    };
+    /// number of floats in one sample (all curves)
+    int SampleStride = 0;
+    Array<AnimCurveFormat::Enum> CurveLayout;
+    Array<Clip> Clips;
+    Array<Curve> Curves;
+    Array<uint16_t> KeyFrames;
+    Array<uint16_t> Data;
+    /// byte size of the uncompressed keys
+    int UncompressedByteSize = 0;
+
+    /// number of curves per clip
+    int NumCurves() const {
+        return this->CurveLayout.Size();
+    }
+    /// byte size of the compressed keys
+    int ByteSize() const {
+        return this->Curves.Size() * sizeof(Curve) + (this->KeyFrames.Size() + this->Data.Size()) * sizeof(uint16_t);
+    }
+};
+
+class AnimCompression {
+public:
+    /// compression parameters
+    struct Params {
+        /// max absolute error of non-quaternion curves
+        float MaxError = 0.001f;
+        /// max per-component error of quaternion curves
+        float MaxQuatError = 0.0005f;
+    };
+    /// compress the keys of an anim library (the keys must have been written)
+    static void Compress(const AnimLibrary& lib, const Params& params, CompressedAnimLibrary& outLib);
+    /// sample a looping clip at a point in time, writes SampleStride floats
+    static void Sample(const CompressedAnimLibrary& lib, int clipIndex, double time, float* outSamples, const uint8_t* curveMask=nullptr);
+};
+
+} // namespace Oryol
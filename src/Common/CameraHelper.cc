@@ -91,6 +91,37 @@ CameraHelper::UpdateTransforms() {
     this->EyePos = (glm::euclidean(this->Orbital) * this->Distance) + this->Center;
     this->View = glm::lookAt(this->EyePos, this->Center, glm::vec3(0.0f, 1.0f, 0.0f));
     this->ViewProj = this->Proj * this->View;
+
+    // extract frustum planes from the view-proj matrix
+    const glm::mat4& m = this->ViewProj;
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    this->FrustumPlanes[0] = row3 + row0;
+    this->FrustumPlanes[1] = row3 - row0;
+    this->FrustumPlanes[2] = row3 + row1;
+    this->FrustumPlanes[3] = row3 - row1;
+    this->FrustumPlanes[4] = row3 + row2;
+    this->FrustumPlanes[5] = row3 - row2;
+    for (auto& plane : this->FrustumPlanes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+CameraHelper::BoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+    for (const auto& plane : this->FrustumPlanes) {
+        // test the box corner furthest along the plane normal
+        const glm::vec3 p((plane.x > 0.0f) ? max.x : min.x,
+                          (plane.y > 0.0f) ? max.y : min.y,
+                          (plane.z > 0.0f) ? max.z : min.z);
+        if ((glm::dot(glm::vec3(plane), p) + plane.w) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
 }
 
 } // namespace Oryol
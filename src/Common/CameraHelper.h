@@ -20,6 +20,8 @@ public:
     void UpdateTransforms();
     /// handle input
     void HandleInput();
+    /// test if a world-space bounding box is at least partially inside the view frustum
+    bool BoxVisible(const glm::vec3& min, const glm::vec3& max) const;
 
     bool Paused = false;
     float MinCamDist = 5.0f;
@@ -38,6 +40,8 @@ public:
     glm::mat4 Proj;
     glm::mat4 InvProj;
     glm::mat4 ViewProj;
+    /// view frustum planes (left, right, bottom, top, near, far), xyz pointing inside
+    glm::vec4 FrustumPlanes[6];
 
     int fbWidth = -1;
     int fbHeight = -1;
@@ -0,0 +1,437 @@
+//------------------------------------------------------------------------------
+//  CrowdAnim.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "CrowdAnim.h"
+#include "Core/Assertion.h"
+#include "Anim/Anim.h"
+#include "Common/HalfFloat.h"
+#include "Common/DualQuatSkin.h"
+#include <glm/gtc/quaternion.hpp>
+#include <math.h>
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::Setup(Id skeleton, const CompressedAnimLibrary* animLib, int maxNumInstances, int width, int height, bool useHalfFloat, bool useDualQuat) {
+    o_assert_dbg(!this->IsValid());
+    o_assert_dbg(animLib && (maxNumInstances > 0));
+
+    const AnimSkeleton& skel = Anim::Skeleton(skeleton);
+    o_assert(animLib->NumCurves() == skel.NumBones * 3);
+    this->lib = animLib;
+    this->numBones = skel.NumBones;
+    this->parentIndices.Reserve(skel.NumBones);
+    this->invBindPose.Reserve(skel.NumBones);
+    for (int i = 0; i < skel.NumBones; i++) {
+        this->parentIndices.Add(skel.ParentIndices[i]);
+        this->invBindPose.Add(skel.InvBindPose[i]);
+        this->isLeaf.Add(true);
+    }
+
+    // leaf bones and their local bind pose transforms for bone LOD
+    for (int i = 0; i < skel.NumBones; i++) {
+        const int parent = this->parentIndices[i];
+        if (parent != -1) {
+            this->isLeaf[parent] = false;
+            this->restPose.Add(glm::inverse(skel.BindPose[parent]) * skel.BindPose[i]);
+        }
+        else {
+            this->restPose.Add(skel.BindPose[i]);
+        }
+    }
+    this->numNonLeafBones = 0;
+    for (int i = 0; i < skel.NumBones; i++) {
+        // translate, rotate, scale curve per bone
+        const uint8_t mask = this->isLeaf[i] ? 0 : 1;
+        for (int j = 0; j < 3; j++) {
+            this->nonLeafCurveMask.Add(mask);
+        }
+        this->numNonLeafBones += mask;
+    }
+    this->evalList.Reserve(maxNumInstances);
+    for (auto& buf : this->scratchBuffers) {
+        buf.samples.Reserve(animLib->SampleStride);
+        for (int i = 0; i < animLib->SampleStride; i++) {
+            buf.samples.Add(0.0f);
+        }
+        buf.pose.Reserve(skel.NumBones);
+        for (int i = 0; i < skel.NumBones; i++) {
+            buf.pose.Add();
+        }
+    }
+
+    // each instance owns 3 texels per bone in the skin matrix table,
+    // instances don't straddle rows
+    this->skinTableWidth = width;
+    this->skinTableHeight = height;
+    this->halfFloat = useHalfFloat;
+    this->dualQuat = useDualQuat;
+    this->texelsPerBone = useDualQuat ? 2 : 3;
+    const int numTableValues = width * height * 4;
+    if (this->halfFloat) {
+        this->halfSkinTable.Reserve(numTableValues);
+        for (int i = 0; i < numTableValues; i++) {
+            this->halfSkinTable.Add(0);
+        }
+    }
+    else {
+        this->skinTable.Reserve(numTableValues);
+        for (int i = 0; i < numTableValues; i++) {
+            this->skinTable.Add(0.0f);
+        }
+    }
+    this->instancesPerRow = width / (this->numBones * this->texelsPerBone);
+    o_assert(this->instancesPerRow > 0);
+    o_assert(((maxNumInstances + this->instancesPerRow - 1) / this->instancesPerRow) <= height);
+    this->instances.Reserve(maxNumInstances);
+    for (int i = 0; i < maxNumInstances; i++) {
+        instance& inst = this->instances.Add();
+        this->blockLocation(i, inst.tableOffset, inst.row, inst.shaderInfo);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::SetupPoseSharing(int maxNumSharedPoses, double quantum) {
+    o_assert_dbg(this->IsValid() && this->sharedPoses.Empty());
+    o_assert_dbg((maxNumSharedPoses > 0) && (quantum > 0.0));
+
+    // shared pose blocks follow the instance blocks
+    const int numBlocks = this->instances.Size() + maxNumSharedPoses;
+    o_assert(((numBlocks + this->instancesPerRow - 1) / this->instancesPerRow) <= this->skinTableHeight);
+    this->sharedPoses.Reserve(maxNumSharedPoses);
+    for (int i = 0; i < maxNumSharedPoses; i++) {
+        sharedPose& pose = this->sharedPoses.Add();
+        this->blockLocation(this->instances.Size() + i, pose.tableOffset, pose.row, pose.shaderInfo);
+    }
+
+    // one pose key per clip and quantized clip position
+    this->phaseQuantum = quantum;
+    int numKeys = 0;
+    for (const auto& clip : this->lib->Clips) {
+        const int numClipKeys = int(ceil((clip.Length * clip.KeyDuration) / quantum));
+        this->clipFirstPoseKey.Add(numKeys);
+        this->clipNumPoseKeys.Add(numClipKeys);
+        numKeys += numClipKeys;
+    }
+    this->poseKeySharedPose.Reserve(numKeys);
+    this->poseKeyFrame.Reserve(numKeys);
+    for (int i = 0; i < numKeys; i++) {
+        this->poseKeySharedPose.Add(-1);
+        this->poseKeyFrame.Add(0);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::blockLocation(int blockIndex, int& outTableOffset, int& outRow, glm::vec4& outShaderInfo) const {
+    // each block has 2 or 3 texels per bone, blocks don't straddle rows
+    const int x = (blockIndex % this->instancesPerRow) * this->numBones * this->texelsPerBone;
+    const int y = blockIndex / this->instancesPerRow;
+    const float w = float(this->skinTableWidth);
+    const float h = float(this->skinTableHeight);
+    outTableOffset = (y * this->skinTableWidth + x) * 4;
+    outRow = y;
+    outShaderInfo = glm::vec4((x + 0.5f) / w, (y + 0.5f) / h, w, 0.0f);
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::Discard() {
+    o_assert_dbg(this->IsValid());
+    this->lib = nullptr;
+    this->numBones = 0;
+    this->parentIndices.Clear();
+    this->invBindPose.Clear();
+    this->restPose.Clear();
+    this->isLeaf.Clear();
+    this->nonLeafCurveMask.Clear();
+    this->evalList.Clear();
+    this->instances.Clear();
+    this->sharedPoses.Clear();
+    this->clipFirstPoseKey.Clear();
+    this->clipNumPoseKeys.Clear();
+    this->poseKeySharedPose.Clear();
+    this->poseKeyFrame.Clear();
+    this->skinTable.Clear();
+    this->halfSkinTable.Clear();
+    this->firstDirtyRow = 0;
+    this->numDirtyRows = 0;
+    for (auto& buf : this->scratchBuffers) {
+        buf.samples.Clear();
+        buf.pose.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+CrowdAnim::IsValid() const {
+    return nullptr != this->lib;
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::Play(int instIndex, int clipIndex, double startTime) {
+    o_assert_dbg((clipIndex >= 0) && (clipIndex < this->lib->Clips.Size()));
+    instance& inst = this->instances[instIndex];
+    inst.clipIndex = clipIndex;
+    inst.startTime = startTime;
+    inst.valid = false;
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::SetLod(int instIndex, int lod) {
+    o_assert_dbg((lod >= 0) && (lod <= MaxLod));
+    this->instances[instIndex].lod = lod;
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::Evaluate(const int* instIndices, int numInstances, double time, WorkerPool* pool, int numThreads) {
+    o_assert_dbg(this->IsValid());
+
+    // select the instances which need an update this frame, instances
+    // with the same LOD are staggered over frames by their index
+    this->evalList.Clear();
+    this->minDirtyRow = this->skinTableHeight;
+    this->maxDirtyRow = -1;
+    this->NumBoneEvals = 0;
+    this->NumFullBoneEvals = numInstances * this->numBones;
+    this->NumSharedPoses = 0;
+    const bool sharePoses = this->SharePoses && !this->sharedPoses.Empty();
+    for (int i = 0; i < numInstances; i++) {
+        const int instIndex = instIndices[i];
+        instance& inst = this->instances[instIndex];
+        const bool wasListed = (inst.lastListedFrame + 1) == this->frameIndex;
+        inst.lastListedFrame = this->frameIndex;
+        if (sharePoses) {
+            // instance must be re-evaluated when pose sharing is switched off
+            inst.valid = false;
+            this->addPoseJob(instIndex, time);
+            continue;
+        }
+        const uint32_t periodMask = (1 << inst.lod) - 1;
+        if (!inst.valid || !wasListed || (0 == ((this->frameIndex + instIndex) & periodMask))) {
+            inst.valid = true;
+            this->addPoseJob(instIndex, time);
+        }
+    }
+    this->frameIndex++;
+    this->NumEvaluatedInstances = this->evalList.Size();
+    this->firstDirtyRow = 0;
+    this->numDirtyRows = 0;
+    if (this->evalList.Empty()) {
+        return;
+    }
+    this->firstDirtyRow = this->minDirtyRow;
+    this->numDirtyRows = this->maxDirtyRow - this->minDirtyRow + 1;
+
+    const poseJob* list = &this->evalList[0];
+    const int num = this->evalList.Size();
+    if (pool && (numThreads > 1)) {
+        const int numBatches = (num + BatchSize - 1) / BatchSize;
+        pool->Run(numBatches, numThreads, [this, list, num](int batchIndex, int threadIndex) {
+            const int first = batchIndex * BatchSize;
+            const int last = (first + BatchSize) < num ? (first + BatchSize) : num;
+            scratch& buf = this->scratchBuffers[threadIndex];
+            for (int i = first; i < last; i++) {
+                this->evaluatePose(list[i], buf);
+            }
+        });
+    }
+    else {
+        for (int i = 0; i < num; i++) {
+            this->evaluatePose(list[i], this->scratchBuffers[0]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::addPoseJob(int instIndex, double time) {
+    instance& inst = this->instances[instIndex];
+    double clipTime = time - inst.startTime;
+    int tableOffset = inst.tableOffset;
+    int row = inst.row;
+    bool skipLeafs = this->SkipLeafBones && (inst.lod > 0);
+    inst.sharedPose = -1;
+    if (this->SharePoses && !this->sharedPoses.Empty()) {
+        const auto& clip = this->lib->Clips[inst.clipIndex];
+        const double clipDuration = clip.Length * clip.KeyDuration;
+        double phase = fmod(clipTime, clipDuration);
+        if (phase < 0.0) {
+            phase += clipDuration;
+        }
+        if (phase >= clipDuration) {
+            phase = 0.0;
+        }
+        // rounding can push the last step past the clip's key count
+        int step = int(phase / this->phaseQuantum);
+        const int maxStep = this->clipNumPoseKeys[inst.clipIndex] - 1;
+        if (step > maxStep) {
+            step = maxStep;
+        }
+        const int key = this->clipFirstPoseKey[inst.clipIndex] + step;
+        if ((this->poseKeyFrame[key] == this->frameIndex) && (this->poseKeySharedPose[key] >= 0)) {
+            // pose is already evaluated this frame
+            inst.sharedPose = this->poseKeySharedPose[key];
+            return;
+        }
+        if (this->NumSharedPoses < this->sharedPoses.Size()) {
+            inst.sharedPose = this->NumSharedPoses++;
+            this->poseKeyFrame[key] = this->frameIndex;
+            this->poseKeySharedPose[key] = inst.sharedPose;
+            const sharedPose& pose = this->sharedPoses[inst.sharedPose];
+            clipTime = step * this->phaseQuantum;
+            tableOffset = pose.tableOffset;
+            row = pose.row;
+            skipLeafs = false;
+        }
+        // otherwise out of shared poses, evaluate into the instance's own block
+    }
+    poseJob& job = this->evalList.Add();
+    job.clipIndex = inst.clipIndex;
+    job.clipTime = clipTime;
+    job.tableOffset = tableOffset;
+    job.skipLeafBones = skipLeafs;
+    this->minDirtyRow = row < this->minDirtyRow ? row : this->minDirtyRow;
+    this->maxDirtyRow = row > this->maxDirtyRow ? row : this->maxDirtyRow;
+    this->NumBoneEvals += skipLeafs ? this->numNonLeafBones : this->numBones;
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::evaluatePose(const poseJob& job, scratch& buf) {
+    float* smp = &buf.samples[0];
+    glm::mat4* pose = &buf.pose[0];
+    const bool skipLeafBones = job.skipLeafBones;
+    const uint8_t* curveMask = skipLeafBones ? &this->nonLeafCurveMask[0] : nullptr;
+    AnimCompression::Sample(*this->lib, job.clipIndex, job.clipTime, smp, curveMask);
+
+    float* dst = this->halfFloat ? nullptr : &this->skinTable[job.tableOffset];
+    uint16_t* halfDst = this->halfFloat ? &this->halfSkinTable[job.tableOffset] : nullptr;
+    for (int boneIndex = 0; boneIndex < this->numBones; boneIndex++, smp += 10) {
+        glm::mat4 m;
+        if (skipLeafBones && this->isLeaf[boneIndex]) {
+            m = this->restPose[boneIndex];
+        }
+        else {
+            // local bone transform from translate, rotate (xyzw) and scale samples
+            const glm::quat r(smp[6], smp[3], smp[4], smp[5]);
+            m = glm::mat4_cast(r);
+            m[0] *= smp[7];
+            m[1] *= smp[8];
+            m[2] *= smp[9];
+            m[3] = glm::vec4(smp[0], smp[1], smp[2], 1.0f);
+        }
+        const int parent = this->parentIndices[boneIndex];
+        if (parent != -1) {
+            m = pose[parent] * m;
+        }
+        pose[boneIndex] = m;
+
+        // skin matrix as 3 transposed rows, or as dual quaternion
+        const glm::mat4 skin = m * this->invBindPose[boneIndex];
+        float values[12];
+        const int numValues = this->texelsPerBone * 4;
+        if (this->dualQuat) {
+            DualQuatSkin::FromMatrix(skin, values);
+        }
+        else {
+            for (int row = 0; row < 3; row++) {
+                values[row * 4 + 0] = skin[0][row];
+                values[row * 4 + 1] = skin[1][row];
+                values[row * 4 + 2] = skin[2][row];
+                values[row * 4 + 3] = skin[3][row];
+            }
+        }
+        if (halfDst) {
+            HalfFloat::Convert(values, halfDst, numValues);
+            halfDst += numValues;
+        }
+        else {
+            for (int i = 0; i < numValues; i++) {
+                *dst++ = values[i];
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+CrowdAnim::NumBones() const {
+    return this->numBones;
+}
+
+//------------------------------------------------------------------------------
+int
+CrowdAnim::NumTexelsPerBone() const {
+    return this->texelsPerBone;
+}
+
+//------------------------------------------------------------------------------
+int
+CrowdAnim::NumTableRows(int numBones, int numTexelsPerBone, int numBlocks, int width) {
+    const int blocksPerRow = width / (numBones * numTexelsPerBone);
+    o_assert(blocksPerRow > 0);
+    return (numBlocks + blocksPerRow - 1) / blocksPerRow;
+}
+
+//------------------------------------------------------------------------------
+bool
+CrowdAnim::IsHalfFloat() const {
+    return this->halfFloat;
+}
+
+//------------------------------------------------------------------------------
+const void*
+CrowdAnim::SkinMatrixTable() const {
+    if (this->halfFloat) {
+        return &this->halfSkinTable[0];
+    }
+    else {
+        return &this->skinTable[0];
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+CrowdAnim::SkinMatrixTableByteSize() const {
+    if (this->halfFloat) {
+        return this->halfSkinTable.Size() * sizeof(uint16_t);
+    }
+    else {
+        return this->skinTable.Size() * sizeof(float);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+CrowdAnim::DirtyRows(int& outFirstRow, int& outNumRows) const {
+    outFirstRow = this->firstDirtyRow;
+    outNumRows = this->numDirtyRows;
+}
+
+//------------------------------------------------------------------------------
+int
+CrowdAnim::DirtyByteSize() const {
+    const int texelSize = this->halfFloat ? 4 * sizeof(uint16_t) : 4 * sizeof(float);
+    return this->numDirtyRows * this->skinTableWidth * texelSize;
+}
+
+//------------------------------------------------------------------------------
+const glm::vec4&
+CrowdAnim::ShaderInfo(int instIndex) const {
+    const instance& inst = this->instances[instIndex];
+    if (inst.sharedPose >= 0) {
+        return this->sharedPoses[inst.sharedPose].shaderInfo;
+    }
+    else {
+        return inst.shaderInfo;
+    }
+}
+
+} // namespace Oryol
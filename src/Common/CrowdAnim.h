@@ -0,0 +1,174 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::CrowdAnim
+    @brief evaluate many instances of one skinned character
+
+    CrowdAnim samples compressed animation clips (see AnimCompression),
+    computes the skeleton pose and writes the skinning matrices into a
+    skin matrix table with the same layout as the Anim module's
+    AnimSkinMatrixInfo (3 RGBA32F texels per bone, each instance owns a
+    fixed range of texels in the table). Optionally the table is packed
+    as RGBA16F, which halves the texture upload size. The rows written
+    by the last Evaluate() call can be queried with DirtyRows().
+
+    With dual-quaternion output, each bone is written as 2 texels (see
+    DualQuatSkin) instead of 3 matrix rows.
+
+    Each instance plays one looping clip, the clip position is
+    computed from the time passed to Evaluate() and the start time
+    passed to Play().
+
+    Evaluate() can split the instance list into batches which are
+    evaluated in parallel on a WorkerPool, each batch writes only to
+    the skin matrix table rows of its own instances.
+
+    Instances can have an animation level-of-detail: LOD 1 instances
+    are evaluated every 2nd frame, LOD 2 instances every 4th frame
+    (staggered by instance index), in between they keep their previous
+    skin matrices. With SkipLeafBones, LOD 1 and 2 instances don't sample
+    leaf bones but use their bind pose. Instances which were not in the
+    instance list of the previous Evaluate() call (for instance because
+    they were culled) are always evaluated.
+
+    With pose sharing enabled (see SetupPoseSharing()), the clip position
+    of each instance is quantized, and instances playing the same clip
+    at the same quantized position reference one shared skin matrix
+    block, which is evaluated once per frame. The evaluation cost then
+    depends on the number of distinct poses instead of the number of
+    instances. Shared blocks live in the table after the instance blocks.
+*/
+#include "Core/Containers/Array.h"
+#include "Resource/Id.h"
+#include "Common/AnimCompression.h"
+#include "Common/WorkerPool.h"
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+namespace Oryol {
+
+class CrowdAnim {
+public:
+    /// setup from skeleton and compressed anim library (library must remain valid)
+    void Setup(Id skeleton, const CompressedAnimLibrary* lib, int maxNumInstances, int skinTableWidth, int skinTableHeight, bool halfFloat=false, bool dualQuat=false);
+    /// discard the crowd
+    void Discard();
+    /// return true if the crowd has been setup
+    bool IsValid() const;
+
+    /// reserve table space for shared poses, and set the clip position quantization in seconds
+    void SetupPoseSharing(int maxNumSharedPoses, double phaseQuantum);
+    /// share poses between instances with the same clip and quantized clip position
+    bool SharePoses = false;
+    /// number of distinct shared poses in last Evaluate()
+    int NumSharedPoses = 0;
+
+    /// start playing a looping clip on an instance
+    void Play(int instIndex, int clipIndex, double startTime);
+    /// max animation LOD, instances are updated every (1<<lod) frames
+    static const int MaxLod = 2;
+    /// set the animation LOD of an instance
+    void SetLod(int instIndex, int lod);
+    /// don't sample leaf bones of instances with LOD > 0
+    bool SkipLeafBones = false;
+    /// number of instances evaluated in last Evaluate()
+    int NumEvaluatedInstances = 0;
+    /// number of bones evaluated in last Evaluate()
+    int NumBoneEvals = 0;
+    /// number of bones which would have been evaluated without LOD
+    int NumFullBoneEvals = 0;
+    /// number of instances per parallel batch
+    static const int BatchSize = 16;
+    /// evaluate instances at a point in time, optionally on multiple threads
+    void Evaluate(const int* instIndices, int numInstances, double time, WorkerPool* pool=nullptr, int numThreads=1);
+
+    /// get number of bones in the skeleton
+    int NumBones() const;
+    /// get number of table texels per bone (3 for matrices, 2 for dual quaternions)
+    int NumTexelsPerBone() const;
+    /// compute number of table rows needed for a number of instances and shared poses
+    static int NumTableRows(int numBones, int numTexelsPerBone, int numBlocks, int skinTableWidth);
+    /// return true if the skin matrix table is packed as RGBA16F
+    bool IsHalfFloat() const;
+    /// get pointer to skin matrix table (float or half)
+    const void* SkinMatrixTable() const;
+    /// get byte size of skin matrix table
+    int SkinMatrixTableByteSize() const;
+    /// get the range of table rows written by the last Evaluate()
+    void DirtyRows(int& outFirstRow, int& outNumRows) const;
+    /// get byte size of the table rows written by the last Evaluate()
+    int DirtyByteSize() const;
+    /// get the bone texture lookup info of an instance (same as AnimInstanceInfo::ShaderInfo)
+    const glm::vec4& ShaderInfo(int instIndex) const;
+
+private:
+    /// per-thread scratch buffers
+    struct scratch {
+        Array<float> samples;
+        Array<glm::mat4> pose;
+    };
+    /// a skin matrix block to evaluate
+    struct poseJob {
+        int clipIndex;
+        double clipTime;
+        int tableOffset;
+        bool skipLeafBones;
+    };
+    /// compute location of a skin matrix block in the table
+    void blockLocation(int blockIndex, int& outTableOffset, int& outRow, glm::vec4& outShaderInfo) const;
+    /// add a job for an instance, or for its shared pose
+    void addPoseJob(int instIndex, double time);
+    /// evaluate a skin matrix block
+    void evaluatePose(const poseJob& job, scratch& buf);
+
+    struct instance {
+        int clipIndex = 0;
+        double startTime = 0.0;
+        int lod = 0;
+        bool valid = false;
+        uint32_t lastListedFrame = 0;
+        int sharedPose = -1;
+        int tableOffset = 0;
+        int row = 0;
+        glm::vec4 shaderInfo;
+    };
+    const CompressedAnimLibrary* lib = nullptr;
+    int numBones = 0;
+    Array<int> parentIndices;
+    Array<glm::mat4> invBindPose;
+    Array<glm::mat4> restPose;
+    Array<bool> isLeaf;
+    Array<uint8_t> nonLeafCurveMask;
+    int numNonLeafBones = 0;
+    uint32_t frameIndex = 0;
+    Array<poseJob> evalList;
+    int minDirtyRow = 0;
+    int maxDirtyRow = 0;
+    Array<instance> instances;
+    int instancesPerRow = 0;
+    struct sharedPose {
+        int tableOffset = 0;
+        int row = 0;
+        glm::vec4 shaderInfo;
+    };
+    Array<sharedPose> sharedPoses;
+    double phaseQuantum = 0.0;
+    // shared pose index per clip and quantized clip position, valid if
+    // the pose key's frame stamp matches the current frame
+    Array<int> clipFirstPoseKey;
+    Array<int> clipNumPoseKeys;
+    Array<int> poseKeySharedPose;
+    Array<uint32_t> poseKeyFrame;
+    int skinTableWidth = 0;
+    int skinTableHeight = 0;
+    bool halfFloat = false;
+    bool dualQuat = false;
+    int texelsPerBone = 3;
+    Array<float> skinTable;
+    Array<uint16_t> halfSkinTable;
+    int firstDirtyRow = 0;
+    int numDirtyRows = 0;
+    scratch scratchBuffers[WorkerPool::MaxNumThreads];
+};
+
+} // namespace Oryol
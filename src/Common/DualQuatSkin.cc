@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------
+//  DualQuatSkin.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "DualQuatSkin.h"
+#include <glm/mat3x3.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+void
+DualQuatSkin::FromMatrix(const glm::mat4& m, float* out) {
+    // rotation from the normalized upper 3x3, translation from the 4th column
+    const glm::mat3 rm(glm::normalize(glm::vec3(m[0])),
+                       glm::normalize(glm::vec3(m[1])),
+                       glm::normalize(glm::vec3(m[2])));
+    glm::quat r = glm::normalize(glm::quat_cast(rm));
+    if (r.w < 0.0f) {
+        r = -r;
+    }
+    // dual part is 0.5 * t * r
+    const glm::quat t(0.0f, m[3].x, m[3].y, m[3].z);
+    const glm::quat d = (t * r) * 0.5f;
+    out[0] = r.x; out[1] = r.y; out[2] = r.z; out[3] = r.w;
+    out[4] = d.x; out[5] = d.y; out[6] = d.z; out[7] = d.w;
+}
+
+//------------------------------------------------------------------------------
+void
+DualQuatSkin::FromMatrixRows(const float* rows, int numBones, float* out) {
+    for (int i = 0; i < numBones; i++, rows += 12, out += NumValuesPerBone) {
+        glm::mat4 m;
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 4; col++) {
+                m[col][row] = rows[row * 4 + col];
+            }
+        }
+        FromMatrix(m, out);
+    }
+}
+
+} // namespace Oryol
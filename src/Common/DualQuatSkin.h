@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::DualQuatSkin
+    @brief convert skin matrices to dual quaternions for DQ skinning
+
+    A dual quaternion skin transform is 2 vec4's per bone (rotation
+    quaternion xyzw, dual part xyzw), instead of the 3 transposed matrix
+    rows of matrix skinning. Dual quaternions can't express scaling,
+    any scale in the skin matrix is dropped.
+*/
+#include "Core/Types.h"
+#include <glm/mat4x4.hpp>
+
+namespace Oryol {
+
+class DualQuatSkin {
+public:
+    /// number of floats per bone
+    static const int NumValuesPerBone = 8;
+    /// convert a skin matrix to a dual quaternion
+    static void FromMatrix(const glm::mat4& m, float* outValues);
+    /// convert a range of skin matrices stored as 3 transposed rows each
+    static void FromMatrixRows(const float* rows, int numBones, float* outValues);
+};
+
+} // namespace Oryol
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+//  HalfFloat.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "HalfFloat.h"
+#include "Core/Memory/Memory.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+uint16_t
+HalfFloat::FromFloat(float f) {
+    uint32_t bits;
+    Memory::Copy(&f, &bits, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t absBits = bits & 0x7FFFFFFF;
+    if (absBits >= 0x7F800000) {
+        // inf or NaN
+        return uint16_t(sign | 0x7C00 | ((absBits > 0x7F800000) ? 0x200 : 0));
+    }
+    if (absBits >= 0x477FF000) {
+        // rounds to a value beyond the max half
+        return uint16_t(sign | 0x7C00);
+    }
+    if (absBits < 0x38800000) {
+        // half denormals are not needed for skin matrices
+        return uint16_t(sign);
+    }
+    // rebias exponent, round mantissa to nearest even
+    const uint32_t mant = absBits & 0x7FFFFF;
+    uint32_t h = ((absBits >> 23) - 112) << 10 | (mant >> 13);
+    const uint32_t rest = mant & 0x1FFF;
+    if ((rest > 0x1000) || ((rest == 0x1000) && (h & 1))) {
+        h++;
+    }
+    return uint16_t(sign | h);
+}
+
+//------------------------------------------------------------------------------
+float
+HalfFloat::ToFloat(uint16_t h) {
+    const uint32_t sign = uint32_t(h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1F;
+    const uint32_t mant = h & 0x3FF;
+    uint32_t bits;
+    if (0 == exp) {
+        // zero (denormals are flushed)
+        bits = sign;
+    }
+    else if (0x1F == exp) {
+        bits = sign | 0x7F800000 | (mant << 13);
+    }
+    else {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    float f;
+    Memory::Copy(&bits, &f, sizeof(f));
+    return f;
+}
+
+//------------------------------------------------------------------------------
+void
+HalfFloat::Convert(const float* src, uint16_t* dst, int num) {
+    for (int i = 0; i < num; i++) {
+        dst[i] = FromFloat(src[i]);
+    }
+}
+
+} // namespace Oryol
@@ -0,0 +1,25 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::HalfFloat
+    @brief float to IEEE 754 half-precision conversion
+
+    Used to pack data for RGBA16F textures. Values are rounded to
+    nearest-even, values out of range become infinity, tiny values
+    are flushed to zero.
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+
+class HalfFloat {
+public:
+    /// convert a single float to half
+    static uint16_t FromFloat(float f);
+    /// convert a half to float
+    static float ToFloat(uint16_t h);
+    /// convert an array of floats to halfs
+    static void Convert(const float* src, uint16_t* dst, int num);
+};
+
+} // namespace Oryol
@@ -0,0 +1,363 @@
+//------------------------------------------------------------------------------
+//  MeshOptimizer.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "MeshOptimizer.h"
+#include "Core/Assertion.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Containers/Array.h"
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <math.h>
+
+namespace Oryol {
+
+// size of the simulated LRU cache in the Forsyth algorithm
+static const int ForsythCacheSize = 32;
+
+//------------------------------------------------------------------------------
+template<class TYPE> static void
+fill(Array<TYPE>& array, int num, const TYPE& val) {
+    array.Clear();
+    array.Reserve(num);
+    for (int i = 0; i < num; i++) {
+        array.Add(val);
+    }
+}
+
+//------------------------------------------------------------------------------
+static float
+vertexScore(int cachePos, int numRemainingTris) {
+    if (0 == numRemainingTris) {
+        // no triangles left which use this vertex
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePos >= 0) {
+        if (cachePos < 3) {
+            // vertices of the last triangle get a fixed score, so that
+            // the algorithm doesn't prefer to re-use the last triangle's edges
+            score = 0.75f;
+        }
+        else {
+            const float scaler = 1.0f / (ForsythCacheSize - 3);
+            score = powf(1.0f - (cachePos - 3) * scaler, 1.5f);
+        }
+    }
+    // bonus for vertices with few triangles left, this gets rid
+    // of lone triangles which would otherwise be left behind
+    score += 2.0f * powf(float(numRemainingTris), -0.5f);
+    return score;
+}
+
+//------------------------------------------------------------------------------
+MeshOptimizer::Stats
+MeshOptimizer::Analyze(const uint16_t* indices, int numIndices, int numVertices, int cacheSize) {
+    o_assert_dbg(indices && (numVertices > 0) && (cacheSize > 0));
+    Stats stats;
+    const int numTris = numIndices / 3;
+    if (0 == numTris) {
+        return stats;
+    }
+    // FIFO cache simulation, a vertex is in the cache if it was
+    // transformed less than cacheSize misses ago
+    Array<int> timeStamps;
+    fill(timeStamps, numVertices, -(cacheSize+1));
+    int numMisses = 0;
+    int numUsed = 0;
+    for (int i = 0; i < numTris * 3; i++) {
+        const int vi = indices[i];
+        o_assert_dbg(vi < numVertices);
+        const int ts = timeStamps[vi];
+        if (ts < -cacheSize) {
+            numUsed++;
+        }
+        if ((numMisses - ts) > cacheSize) {
+            timeStamps[vi] = numMisses++;
+        }
+    }
+    stats.ACMR = float(numMisses) / float(numTris);
+    stats.ATVR = float(numMisses) / float(numUsed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::OptimizeVertexCache(uint16_t* indices, int numIndices, int numVertices) {
+    o_assert_dbg(indices && (numVertices > 0));
+    const int numTris = numIndices / 3;
+    if (numTris < 2) {
+        return;
+    }
+
+    // build vertex-to-triangle adjacency
+    Array<int> numVertexTris;
+    fill(numVertexTris, numVertices, 0);
+    for (int i = 0; i < numTris * 3; i++) {
+        numVertexTris[indices[i]]++;
+    }
+    Array<int> vertexTrisOffset;
+    vertexTrisOffset.Reserve(numVertices);
+    int offset = 0;
+    for (int vi = 0; vi < numVertices; vi++) {
+        vertexTrisOffset.Add(offset);
+        offset += numVertexTris[vi];
+    }
+    Array<int> vertexTris;
+    fill(vertexTris, numTris * 3, 0);
+    Array<int> fillCount;
+    fill(fillCount, numVertices, 0);
+    for (int ti = 0; ti < numTris; ti++) {
+        for (int i = 0; i < 3; i++) {
+            const int vi = indices[ti*3 + i];
+            vertexTris[vertexTrisOffset[vi] + fillCount[vi]++] = ti;
+        }
+    }
+
+    // initial vertex and triangle scores
+    Array<int> cachePos;
+    fill(cachePos, numVertices, -1);
+    Array<float> vertexScores;
+    vertexScores.Reserve(numVertices);
+    for (int vi = 0; vi < numVertices; vi++) {
+        vertexScores.Add(vertexScore(-1, numVertexTris[vi]));
+    }
+    Array<float> triScores;
+    triScores.Reserve(numTris);
+    for (int ti = 0; ti < numTris; ti++) {
+        const uint16_t* tri = &indices[ti*3];
+        triScores.Add(vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]]);
+    }
+    Array<bool> triEmitted;
+    fill(triEmitted, numTris, false);
+
+    // the output triangle order, the emitted triangles index
+    // into the original index data
+    Array<uint16_t> output;
+    output.Reserve(numTris * 3);
+
+    // the simulated LRU cache, with room for 3 new vertices
+    int cache[ForsythCacheSize + 3];
+    int cacheSize = 0;
+    int bestTri = -1;
+    int linearScanPos = 0;
+    for (int numEmitted = 0; numEmitted < numTris; numEmitted++) {
+        if (bestTri < 0) {
+            // no candidate in the cache, continue with the best
+            // remaining triangle in input order
+            float bestScore = -1.0f;
+            for (int ti = linearScanPos; ti < numTris; ti++) {
+                if (!triEmitted[ti]) {
+                    if (bestTri < 0) {
+                        linearScanPos = ti;
+                    }
+                    if (triScores[ti] > bestScore) {
+                        bestScore = triScores[ti];
+                        bestTri = ti;
+                    }
+                }
+            }
+        }
+        o_assert_dbg(bestTri >= 0);
+
+        // emit the triangle and remove it from the adjacency lists
+        triEmitted[bestTri] = true;
+        const uint16_t* tri = &indices[bestTri*3];
+        for (int i = 0; i < 3; i++) {
+            const int vi = tri[i];
+            output.Add(vi);
+            int* vt = &vertexTris[vertexTrisOffset[vi]];
+            const int num = numVertexTris[vi];
+            for (int j = 0; j < num; j++) {
+                if (vt[j] == bestTri) {
+                    vt[j] = vt[num-1];
+                    break;
+                }
+            }
+            numVertexTris[vi]--;
+        }
+
+        // move the triangle's vertices to the front of the cache
+        int newCache[ForsythCacheSize + 3];
+        int newCacheSize = 0;
+        for (int i = 0; i < 3; i++) {
+            newCache[newCacheSize++] = tri[i];
+        }
+        for (int i = 0; i < cacheSize; i++) {
+            const int vi = cache[i];
+            if ((vi != tri[0]) && (vi != tri[1]) && (vi != tri[2])) {
+                newCache[newCacheSize++] = vi;
+            }
+        }
+        // update scores of all vertices that were touched, vertices
+        // that fell out of the cache get their uncached score
+        for (int i = 0; i < newCacheSize; i++) {
+            const int vi = newCache[i];
+            const int pos = (i < ForsythCacheSize) ? i : -1;
+            cachePos[vi] = pos;
+            const float newScore = vertexScore(pos, numVertexTris[vi]);
+            const float delta = newScore - vertexScores[vi];
+            vertexScores[vi] = newScore;
+            const int* vt = &vertexTris[vertexTrisOffset[vi]];
+            for (int j = 0; j < numVertexTris[vi]; j++) {
+                triScores[vt[j]] += delta;
+            }
+        }
+        cacheSize = std::min(newCacheSize, int(ForsythCacheSize));
+        Memory::Copy(newCache, cache, cacheSize * sizeof(int));
+
+        // the next triangle is the best one adjacent to cached vertices
+        bestTri = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheSize; i++) {
+            const int vi = cache[i];
+            const int* vt = &vertexTris[vertexTrisOffset[vi]];
+            for (int j = 0; j < numVertexTris[vi]; j++) {
+                const int ti = vt[j];
+                if (triScores[ti] > bestScore) {
+                    bestScore = triScores[ti];
+                    bestTri = ti;
+                }
+            }
+        }
+    }
+    Memory::Copy(&output[0], indices, numTris * 3 * sizeof(uint16_t));
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::OptimizeOverdraw(uint16_t* indices, int numIndices, const glm::vec3* positions, int numVertices, float threshold) {
+    o_assert_dbg(indices && positions && (numVertices > 0));
+    const int numTris = numIndices / 3;
+    if (numTris < 2) {
+        return;
+    }
+
+    // split the cache-optimized triangle order into clusters, a new
+    // cluster starts where the running ACMR of the current cluster
+    // is below the ACMR of the whole mesh times threshold, which
+    // keeps most of the vertex cache efficiency intact (this is
+    // the cluster split from the Tipsify paper, simplified for a FIFO cache)
+    const float meshACMR = Analyze(indices, numIndices, numVertices).ACMR;
+    Array<int> clusters;
+    Array<int> timeStamps;
+    fill(timeStamps, numVertices, -(StatsCacheSize+1));
+    int numMisses = 0;
+    int clusterMisses = 0;
+    int clusterStart = 0;
+    clusters.Add(0);
+    for (int ti = 0; ti < numTris; ti++) {
+        for (int i = 0; i < 3; i++) {
+            const int vi = indices[ti*3 + i];
+            if ((numMisses - timeStamps[vi]) > StatsCacheSize) {
+                timeStamps[vi] = numMisses++;
+                clusterMisses++;
+            }
+        }
+        const int clusterTris = ti + 1 - clusterStart;
+        if ((ti + 1 < numTris) && (clusterTris >= 16) &&
+            ((float(clusterMisses) / float(clusterTris)) <= (meshACMR * threshold))) {
+            clusterStart = ti + 1;
+            clusterMisses = 0;
+            clusters.Add(clusterStart);
+            // flush the cache, so that each cluster is self-contained
+            numMisses += StatsCacheSize + 1;
+        }
+    }
+    clusters.Add(numTris);
+    const int numClusters = clusters.Size() - 1;
+    if (numClusters < 2) {
+        return;
+    }
+
+    // mesh centroid
+    glm::vec3 meshCenter(0.0f);
+    for (int i = 0; i < numTris * 3; i++) {
+        meshCenter += positions[indices[i]];
+    }
+    meshCenter /= float(numTris * 3);
+
+    // sort key of each cluster is how much it faces outward, clusters
+    // at the silhouette which face away from the mesh center are
+    // likely to occlude the clusters inside of the mesh
+    struct clusterKey {
+        float sortKey;
+        int index;
+    };
+    Array<clusterKey> keys;
+    keys.Reserve(numClusters);
+    for (int ci = 0; ci < numClusters; ci++) {
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (int ti = clusters[ci]; ti < clusters[ci+1]; ti++) {
+            const glm::vec3& p0 = positions[indices[ti*3 + 0]];
+            const glm::vec3& p1 = positions[indices[ti*3 + 1]];
+            const glm::vec3& p2 = positions[indices[ti*3 + 2]];
+            const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            const float a = glm::length(n);
+            center += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f) {
+            center /= area;
+        }
+        const float len = glm::length(normal);
+        if (len > 0.0f) {
+            normal /= len;
+        }
+        keys.Add(clusterKey{ glm::dot(center - meshCenter, normal), ci });
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const clusterKey& a, const clusterKey& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    // write the triangles in sorted cluster order
+    Array<uint16_t> output;
+    output.Reserve(numTris * 3);
+    for (const auto& key : keys) {
+        for (int i = clusters[key.index] * 3; i < clusters[key.index+1] * 3; i++) {
+            output.Add(indices[i]);
+        }
+    }
+    Memory::Copy(&output[0], indices, numTris * 3 * sizeof(uint16_t));
+}
+
+//------------------------------------------------------------------------------
+int
+MeshOptimizer::OptimizeVertexFetch(uint8_t* vertices, int numVertices, int vertexByteSize, uint16_t* indices, int numIndices) {
+    o_assert_dbg(vertices && indices && (numVertices > 0) && (vertexByteSize > 0));
+
+    // assign new vertex indices in order of first use
+    Array<int> remap;
+    fill(remap, numVertices, -1);
+    int numUsed = 0;
+    for (int i = 0; i < numIndices; i++) {
+        const int vi = indices[i];
+        if (remap[vi] < 0) {
+            remap[vi] = numUsed++;
+        }
+        indices[i] = uint16_t(remap[vi]);
+    }
+    // unreferenced vertices go to the end, so that the vertex buffer
+    // content stays valid for index ranges this function didn't see
+    int next = numUsed;
+    for (int vi = 0; vi < numVertices; vi++) {
+        if (remap[vi] < 0) {
+            remap[vi] = next++;
+        }
+    }
+
+    // move the vertex data
+    const int size = numVertices * vertexByteSize;
+    uint8_t* tmp = (uint8_t*) Memory::Alloc(size);
+    for (int vi = 0; vi < numVertices; vi++) {
+        Memory::Copy(vertices + vi * vertexByteSize, tmp + remap[vi] * vertexByteSize, vertexByteSize);
+    }
+    Memory::Copy(tmp, vertices, size);
+    Memory::Free(tmp);
+    return numUsed;
+}
+
+} // namespace Oryol
@@ -0,0 +1,42 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::MeshOptimizer
+    @brief reorder indexed triangle meshes for GPU vertex processing
+
+    Triangles of an index range are reordered for post-transform vertex
+    cache locality (Tom Forsyth's linear-speed algorithm), then clusters
+    of the cache-optimized triangle order are sorted so that outward
+    facing clusters are rendered first to reduce overdraw, and finally
+    vertices are reordered into first-use order for vertex fetch locality.
+
+    All functions work on 16-bit index data in place.
+*/
+#include "Core/Types.h"
+#include <glm/vec3.hpp>
+
+namespace Oryol {
+
+class MeshOptimizer {
+public:
+    /// size of the FIFO cache used to compute statistics
+    static const int StatsCacheSize = 16;
+
+    /// vertex processing statistics of an index range
+    struct Stats {
+        /// average cache miss ratio (transformed vertices per triangle)
+        float ACMR = 0.0f;
+        /// average transform to vertex ratio (transformed vertices per used vertex)
+        float ATVR = 0.0f;
+    };
+    /// compute ACMR/ATVR for a FIFO vertex cache
+    static Stats Analyze(const uint16_t* indices, int numIndices, int numVertices, int cacheSize=StatsCacheSize);
+    /// reorder triangles for post-transform vertex cache locality
+    static void OptimizeVertexCache(uint16_t* indices, int numIndices, int numVertices);
+    /// reorder clusters of cache-optimized triangles to reduce overdraw
+    static void OptimizeOverdraw(uint16_t* indices, int numIndices, const glm::vec3* positions, int numVertices, float threshold=1.05f);
+    /// reorder vertices into first-use order, remaps indices, returns number of referenced vertices
+    static int OptimizeVertexFetch(uint8_t* vertices, int numVertices, int vertexByteSize, uint16_t* indices, int numIndices);
+};
+
+} // namespace Oryol
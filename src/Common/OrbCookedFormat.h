@@ -0,0 +1,64 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file OrbCookedFormat.h
+    @brief data structures of the cooked data appended to .orb files
+
+    The OrbCook tool appends a chunk with pre-computed data to an
+    ORB1 file. The ORB1 data itself is only modified when the mesh
+    has been optimized (OrbCookedFlags::MeshOptimized), the layout
+    stays the same. The chunk starts at a 16-byte aligned offset
+    after the ORB1 data, and the file ends with an
+    OrbCookedFooter which points to the chunk header, this way
+    readers which don't know about cooked data still work.
+
+    All offsets are in bytes relative to the start of the file.
+*/
+#include <stdint.h>
+
+namespace Oryol {
+
+static const uint32_t OrbCookedMagic = 'ORBC';
+static const uint32_t OrbCookedVersion = 1;
+
+#pragma pack(push,1)
+
+struct OrbCookedHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t OrbDataSize;           // size of the ORB1 data
+    uint32_t Checksum;              // FNV-1a over the ORB1 data as written (after mesh optimization)
+    uint32_t NumBones;
+    uint32_t BindPoseOffset;        // OrbCookedMatrix per bone, model space
+    uint32_t InvBindPoseOffset;     // OrbCookedMatrix per bone
+    uint32_t BoneBoundsOffset;      // OrbCookedBounds per bone, in bone space
+    uint32_t NumSubmeshes;
+    uint32_t SubmeshBoundsOffset;   // OrbCookedBounds per submesh, in model space
+    uint32_t Flags;                 // OrbCookedFlags
+    uint32_t Reserved;
+};
+
+struct OrbCookedFooter {
+    uint32_t HeaderOffset;
+    uint32_t Magic;
+};
+
+struct OrbCookedMatrix {
+    float Values[16];               // column-major, same as glm::mat4
+};
+
+struct OrbCookedBounds {
+    float Min[3];
+    float Max[3];
+};
+
+#pragma pack(pop)
+
+struct OrbCookedFlags {
+    enum Enum : uint32_t {
+        None = 0,
+        MeshOptimized = (1<<0),     // index/vertex data reordered by MeshOptimizer
+    };
+};
+
+} // namespace Oryol
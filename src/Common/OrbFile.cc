@@ -5,6 +5,9 @@
 #include <stdint.h>
 #include "OrbFile.h"
 #include "Anim/Anim.h"
+#include "Core/Log.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace Oryol {
 
@@ -14,47 +17,260 @@ OrbFile::HasCharacter() const {
     return !this->Bones.Empty();
 }
 
+//------------------------------------------------------------------------------
+bool
+OrbFile::IsCooked() const {
+    return nullptr != this->Cooked;
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+OrbFile::Checksum(const uint8_t* data, int size) {
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261U;
+    for (int i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619U;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+int
+OrbFile::VertexFormatByteSize(uint32_t fmt) {
+    switch (fmt) {
+        case OrbVertexFormat::Float:    return 4;
+        case OrbVertexFormat::Float2:   return 8;
+        case OrbVertexFormat::Float3:   return 12;
+        case OrbVertexFormat::Float4:   return 16;
+        case OrbVertexFormat::Byte4:
+        case OrbVertexFormat::Byte4N:
+        case OrbVertexFormat::UByte4:
+        case OrbVertexFormat::UByte4N:
+        case OrbVertexFormat::Short2:
+        case OrbVertexFormat::Short2N:  return 4;
+        case OrbVertexFormat::Short4:
+        case OrbVertexFormat::Short4N:  return 8;
+        default: return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+static int
+animKeyByteSize(uint32_t fmt) {
+    switch (fmt) {
+        case OrbAnimKeyFormat::Float:       return 4;
+        case OrbAnimKeyFormat::Float2:      return 8;
+        case OrbAnimKeyFormat::Float3:      return 12;
+        case OrbAnimKeyFormat::Float4:
+        case OrbAnimKeyFormat::Quaternion:  return 16;
+        default: return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+static bool
+inRange(uint64_t offset, uint64_t num, uint64_t elemSize, uint64_t size) {
+    // all inputs are 32-bit, so this can't overflow in 64 bits
+    return (offset <= size) && ((num * elemSize) <= (size - offset));
+}
+
+//------------------------------------------------------------------------------
+int
+OrbFile::VertexByteSize() const {
+    int size = 0;
+    for (const auto& comp : this->VertexComps) {
+        size += VertexFormatByteSize(comp.Format);
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+void
+OrbFile::ComputeBindPoses(glm::mat4* outBindPoses, int maxNumBones) const {
+    o_assert_dbg(outBindPoses && (this->Bones.Size() <= maxNumBones));
+    for (int i = 0; i < this->Bones.Size(); i++) {
+        const auto& src = this->Bones[i];
+        glm::vec4 t(src.Translate[0], src.Translate[1], src.Translate[2], 1.0f);
+        glm::vec3 s(src.Scale[0], src.Scale[1], src.Scale[2]);
+        glm::quat r(src.Rotate[3], src.Rotate[0], src.Rotate[1], src.Rotate[2]);
+        glm::mat4 m = glm::scale(glm::mat4(), s);
+        m = m * glm::mat4_cast(r);
+        m[3] = t;
+        if (src.Parent != -1) {
+            m = outBindPoses[src.Parent] * m;
+        }
+        outBindPoses[i] = m;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+OrbFile::Validate() const {
+    bool valid = true;
+    const int numStrings = this->Strings.Size();
+    const int vertexByteSize = this->VertexByteSize();
+    if (0 == vertexByteSize) {
+        Log::Error("OrbFile: invalid vertex layout\n");
+        valid = false;
+    }
+    int numVertices = 0;
+    for (int i = 0; i < this->Meshes.Size(); i++) {
+        const auto& mesh = this->Meshes[i];
+        numVertices += mesh.NumVertices;
+        if ((mesh.NumIndices % 3) != 0) {
+            Log::Error("OrbFile: mesh %d: index count %d not a multiple of 3\n", i, mesh.NumIndices);
+            valid = false;
+        }
+        if (((mesh.FirstIndex + mesh.NumIndices) * 2) > this->IndexDataSize) {
+            Log::Error("OrbFile: mesh %d: index range out of bounds\n", i);
+            valid = false;
+        }
+        if (mesh.Material >= this->Materials.Size()) {
+            Log::Error("OrbFile: mesh %d: invalid material index %d\n", i, mesh.Material);
+            valid = false;
+        }
+    }
+    if ((numVertices * vertexByteSize) > this->VertexDataSize) {
+        Log::Error("OrbFile: vertex data too small for %d vertices\n", numVertices);
+        valid = false;
+    }
+    else if (valid) {
+        const uint16_t* indices = (const uint16_t*) (this->Start + this->IndexDataOffset);
+        for (int i = 0; i < this->Meshes.Size(); i++) {
+            const auto& mesh = this->Meshes[i];
+            for (uint32_t ii = mesh.FirstIndex; ii < (mesh.FirstIndex + mesh.NumIndices); ii++) {
+                if (indices[ii] >= numVertices) {
+                    Log::Error("OrbFile: mesh %d: vertex index %d out of bounds\n", i, indices[ii]);
+                    valid = false;
+                    break;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < this->Bones.Size(); i++) {
+        const auto& bone = this->Bones[i];
+        if ((bone.Parent != -1) && ((bone.Parent < 0) || (bone.Parent >= i))) {
+            Log::Error("OrbFile: bone %d: invalid parent index %d\n", i, bone.Parent);
+            valid = false;
+        }
+        if (bone.Name >= numStrings) {
+            Log::Error("OrbFile: bone %d: invalid name string index\n", i);
+            valid = false;
+        }
+    }
+    for (int i = 0; i < this->AnimClips.Size(); i++) {
+        const auto& clip = this->AnimClips[i];
+        if ((clip.FirstCurve + clip.NumCurves) > this->AnimCurves.Size()) {
+            Log::Error("OrbFile: clip %d: curve range out of bounds\n", i);
+            valid = false;
+        }
+        if (clip.NumCurves != this->AnimKeyComps.Size()) {
+            Log::Error("OrbFile: clip %d: curve count doesn't match curve layout\n", i);
+            valid = false;
+        }
+        if (clip.Name >= numStrings) {
+            Log::Error("OrbFile: clip %d: invalid name string index\n", i);
+            valid = false;
+        }
+        if (valid && (clip.Length > 0)) {
+            // the keys of all animated curves are interleaved per frame,
+            // the last key of each curve must be inside the anim data
+            int64_t keyStride = 0;
+            for (int ci = 0; ci < clip.NumCurves; ci++) {
+                if (this->AnimCurves[clip.FirstCurve + ci].KeyOffset != -1) {
+                    keyStride += animKeyByteSize(this->AnimKeyComps[ci].KeyFormat);
+                }
+            }
+            for (int ci = 0; ci < clip.NumCurves; ci++) {
+                const auto& curve = this->AnimCurves[clip.FirstCurve + ci];
+                if (curve.KeyOffset == -1) {
+                    continue;
+                }
+                const int64_t keyEnd = int64_t(curve.KeyOffset) +
+                    (int64_t(clip.Length) - 1) * keyStride +
+                    animKeyByteSize(this->AnimKeyComps[ci].KeyFormat);
+                if ((curve.KeyOffset < 0) || (keyEnd > int64_t(this->AnimDataSize))) {
+                    Log::Error("OrbFile: clip %d: keys of curve %d out of bounds\n", i, ci);
+                    valid = false;
+                    break;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < this->AnimCurves.Size(); i++) {
+        const auto& curve = this->AnimCurves[i];
+        if ((curve.KeyOffset < -1) || (curve.KeyOffset >= this->AnimDataSize)) {
+            Log::Error("OrbFile: curve %d: key offset out of bounds\n", i);
+            valid = false;
+        }
+    }
+    return valid;
+}
+
 //------------------------------------------------------------------------------
 bool
 OrbFile::Parse(const uint8_t* orbFileData, int orbFileSize) {
     const uint8_t* start = orbFileData;
     this->Start = start;
-    const uint8_t* end = orbFileData + orbFileSize;
+    this->OrbDataSize = orbFileSize;
 
-    if ((start + sizeof(OrbHeader)) >= end) return false;
+    // check for cooked data at the end of the file, if the cooked
+    // data looks broken it is ignored, but the ORB1 data is still used
+    const OrbCookedHeader* cooked = nullptr;
+    if (orbFileSize > int(sizeof(OrbHeader) + sizeof(OrbCookedHeader) + sizeof(OrbCookedFooter))) {
+        const OrbCookedFooter* footer = (const OrbCookedFooter*) (start + orbFileSize - sizeof(OrbCookedFooter));
+        if ((footer->Magic == OrbCookedMagic) &&
+            inRange(footer->HeaderOffset, 1, sizeof(OrbCookedHeader), orbFileSize - sizeof(OrbCookedFooter))) {
+            cooked = (const OrbCookedHeader*) (start + footer->HeaderOffset);
+            if ((cooked->Magic != OrbCookedMagic) ||
+                (cooked->Version != OrbCookedVersion) ||
+                (cooked->OrbDataSize > footer->HeaderOffset) ||
+                (cooked->Checksum != Checksum(start, cooked->OrbDataSize))) {
+                Log::Warn("OrbFile: ignoring invalid cooked data\n");
+                cooked = nullptr;
+            }
+            else {
+                this->OrbDataSize = cooked->OrbDataSize;
+            }
+        }
+    }
+    const uint64_t size = uint64_t(this->OrbDataSize);
+
+    if (sizeof(OrbHeader) >= size) return false;
     const OrbHeader* hdr = (const OrbHeader*) start;
     if (hdr->Magic != 'ORB1') return false;
     for (int i = 0; i < 3; i++) {
         this->VertexMagnitude[i] = hdr->VertexMagnitude[i];
     }
 
-    // setup item array slices
+    // setup item array slices, all ranges are checked before any
+    // pointer into the data is formed
+    if (!inRange(hdr->VertexComponentOffset, hdr->NumVertexComponents, sizeof(OrbVertexComponent), size)) return false;
     VertexComps = Slice<OrbVertexComponent>((OrbVertexComponent*)&start[hdr->VertexComponentOffset], hdr->NumVertexComponents);
-    if ((const uint8_t*)VertexComps.end() > end) return false;
+    if (!inRange(hdr->ValuePropOffset, hdr->NumValueProps, sizeof(OrbValueProperty), size)) return false;
     ValueProps = Slice<OrbValueProperty>((OrbValueProperty*)&start[hdr->ValuePropOffset], hdr->NumValueProps);
-    if ((const uint8_t*)ValueProps.end() > end) return false;
+    if (!inRange(hdr->TexturePropOffset, hdr->NumTextureProps, sizeof(OrbTextureProperty), size)) return false;
     TexProps = Slice<OrbTextureProperty>((OrbTextureProperty*)&start[hdr->TexturePropOffset], hdr->NumTextureProps);
-    if ((const uint8_t*)TexProps.end() > end) return false;
+    if (!inRange(hdr->MaterialOffset, hdr->NumMaterials, sizeof(OrbMaterial), size)) return false;
     Materials = Slice<OrbMaterial>((OrbMaterial*)&start[hdr->MaterialOffset], hdr->NumMaterials);
-    if ((const uint8_t*)Materials.end() > end) return false;
+    if (!inRange(hdr->MeshOffset, hdr->NumMeshes, sizeof(OrbMesh), size)) return false;
     Meshes = Slice<OrbMesh>((OrbMesh*)&start[hdr->MeshOffset], hdr->NumMeshes);
-    if ((const uint8_t*)Meshes.end() > end) return false;
+    if (!inRange(hdr->BoneOffset, hdr->NumBones, sizeof(OrbBone), size)) return false;
     Bones = Slice<OrbBone>((OrbBone*)&start[hdr->BoneOffset], hdr->NumBones);
-    if ((const uint8_t*)Bones.end() > end) return false;
+    if (!inRange(hdr->NodeOffset, hdr->NumNodes, sizeof(OrbNode), size)) return false;
     Nodes = Slice<OrbNode>((OrbNode*)&start[hdr->NodeOffset], hdr->NumNodes);
-    if ((const uint8_t*)Nodes.end() > end) return false;
+    if (!inRange(hdr->AnimKeyComponentOffset, hdr->NumAnimKeyComponents, sizeof(OrbAnimKeyComponent), size)) return false;
     AnimKeyComps = Slice<OrbAnimKeyComponent>((OrbAnimKeyComponent*)&start[hdr->AnimKeyComponentOffset], hdr->NumAnimKeyComponents);
-    if ((const uint8_t*)AnimKeyComps.end() > end) return false;
+    if (!inRange(hdr->AnimCurveOffset, hdr->NumAnimCurves, sizeof(OrbAnimCurve), size)) return false;
     AnimCurves = Slice<OrbAnimCurve>((OrbAnimCurve*)&start[hdr->AnimCurveOffset], hdr->NumAnimCurves);
-    if ((const uint8_t*)AnimCurves.end() > end) return false;
+    if (!inRange(hdr->AnimClipOffset, hdr->NumAnimClips, sizeof(OrbAnimClip), size)) return false;
     AnimClips = Slice<OrbAnimClip>((OrbAnimClip*)&start[hdr->AnimClipOffset], hdr->NumAnimClips);
-    if ((const uint8_t*)AnimClips.end() > end) return false;
 
     // vertex-, index- and anim data blobs
-    if ((start + hdr->VertexDataOffset + hdr->VertexDataSize) > end) return false;
-    if ((start + hdr->IndexDataOffset + hdr->IndexDataSize) > end) return false;
-    if ((start + hdr->AnimKeyDataOffset + hdr->AnimKeyDataSize) > end) return false;
-    if ((start + hdr->StringPoolDataOffset + hdr->StringPoolDataSize) > end) return false;
+    if (!inRange(hdr->VertexDataOffset, hdr->VertexDataSize, 1, size)) return false;
+    if (!inRange(hdr->IndexDataOffset, hdr->IndexDataSize, 1, size)) return false;
+    if (!inRange(hdr->AnimKeyDataOffset, hdr->AnimKeyDataSize, 1, size)) return false;
+    if (!inRange(hdr->StringPoolDataOffset, hdr->StringPoolDataSize, 1, size)) return false;
     VertexDataOffset = hdr->VertexDataOffset;
     VertexDataSize = hdr->VertexDataSize;
     IndexDataOffset = hdr->IndexDataOffset;
@@ -66,13 +282,33 @@ OrbFile::Parse(const uint8_t* orbFileData, int orbFileSize) {
     const char* stringStart = (const char*) (start + hdr->StringPoolDataOffset);
     const char* stringEnd = stringStart;
     const char* stringPoolEnd = stringStart + hdr->StringPoolDataSize;
-    if ((const uint8_t*)stringPoolEnd > end) return false;
     while (stringEnd < stringPoolEnd) {
         if (*stringEnd++ == 0) {
             Strings.Add(stringStart);
             stringStart = stringEnd;
         }
     }
+
+    // setup slices into cooked data
+    if (cooked && (cooked->NumBones == uint32_t(this->Bones.Size())) && (cooked->NumSubmeshes == uint32_t(this->Meshes.Size()))) {
+        const uint64_t cookedSize = uint64_t(orbFileSize);
+        if (inRange(cooked->BindPoseOffset, cooked->NumBones, sizeof(OrbCookedMatrix), cookedSize) &&
+            inRange(cooked->InvBindPoseOffset, cooked->NumBones, sizeof(OrbCookedMatrix), cookedSize) &&
+            inRange(cooked->BoneBoundsOffset, cooked->NumBones, sizeof(OrbCookedBounds), cookedSize) &&
+            inRange(cooked->SubmeshBoundsOffset, cooked->NumSubmeshes, sizeof(OrbCookedBounds), cookedSize)) {
+            CookedBindPoses = Slice<OrbCookedMatrix>((OrbCookedMatrix*)&start[cooked->BindPoseOffset], cooked->NumBones);
+            CookedInvBindPoses = Slice<OrbCookedMatrix>((OrbCookedMatrix*)&start[cooked->InvBindPoseOffset], cooked->NumBones);
+            CookedBoneBounds = Slice<OrbCookedBounds>((OrbCookedBounds*)&start[cooked->BoneBoundsOffset], cooked->NumBones);
+            CookedSubmeshBounds = Slice<OrbCookedBounds>((OrbCookedBounds*)&start[cooked->SubmeshBoundsOffset], cooked->NumSubmeshes);
+            this->Cooked = cooked;
+        }
+    }
+    if (!this->Cooked) {
+        CookedBindPoses = Slice<OrbCookedMatrix>();
+        CookedInvBindPoses = Slice<OrbCookedMatrix>();
+        CookedBoneBounds = Slice<OrbCookedBounds>();
+        CookedSubmeshBounds = Slice<OrbCookedBounds>();
+    }
     return true;
 }
 
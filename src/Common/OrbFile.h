@@ -8,12 +8,17 @@
     which allow structured access to the file content. After calling
     the Parse() method, the original data must remain valid, the OrbFile
     object will only reference this data, not take ownership!
+
+    If the file has been processed by the OrbCook tool, the Cooked
+    pointer and the cooked slices will be valid (see OrbCookedFormat.h).
 */
 #include "OrbFileFormat.h"
+#include "OrbCookedFormat.h"
 #include "Core/Containers/Slice.h"
 #include "Core/Containers/InlineArray.h"
 #include "Gfx/GfxTypes.h"
 #include "Anim/AnimTypes.h"
+#include <glm/mat4x4.hpp>
 
 namespace Oryol {
 
@@ -22,6 +27,18 @@ struct OrbFile {
     bool Parse(const uint8_t* orbFileData, int orbFileSize);
     /// test if the file contains a character
     bool HasCharacter() const;
+    /// test if cooked data is present and matches the checksum
+    bool IsCooked() const;
+    /// deep validation of indices and ranges (logs all errors)
+    bool Validate() const;
+    /// compute the byte size of one vertex from the vertex components
+    int VertexByteSize() const;
+    /// compute model-space bind pose matrices from bone transforms
+    void ComputeBindPoses(glm::mat4* outBindPoses, int maxNumBones) const;
+    /// get the byte size of an OrbVertexFormat
+    static int VertexFormatByteSize(uint32_t fmt);
+    /// compute the checksum stored in cooked data
+    static uint32_t Checksum(const uint8_t* data, int size);
 
     const uint8_t* Start = nullptr;
     glm::vec3 VertexMagnitude;
@@ -43,6 +60,14 @@ struct OrbFile {
     int AnimDataSize = 0;
     static const int MaxStringPoolSize = 1024;
     InlineArray<const char*, MaxStringPoolSize> Strings;
+
+    /// size of the original ORB1 data (without cooked data)
+    int OrbDataSize = 0;
+    const OrbCookedHeader* Cooked = nullptr;
+    Slice<OrbCookedMatrix> CookedBindPoses;
+    Slice<OrbCookedMatrix> CookedInvBindPoses;
+    Slice<OrbCookedBounds> CookedBoneBounds;
+    Slice<OrbCookedBounds> CookedSubmeshBounds;
 };
 
 } // namespace Oryol
@@ -4,11 +4,16 @@
 #include "Pre.h"
 #include "OrbLoader.h"
 #include "OrbFile.h"
+#include "MeshOptimizer.h"
 #include "Gfx/Gfx.h"
 #include "Anim/Anim.h"
+#include "Core/Log.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/StringBuilder.h"
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/common.hpp>
 
 namespace Oryol {
 
@@ -65,28 +70,107 @@ static MeshSetup makeMeshSetup(const OrbFile& orb, const Locator& loc) {
     return setup;
 }
 
+//------------------------------------------------------------------------------
+static bool decodePositions(const MeshSetup& setup, const glm::vec3& mag, const uint8_t* vertices, Array<glm::vec3>& outPositions) {
+    const VertexLayout& layout = setup.Layout;
+    const int compIndex = layout.ComponentIndexByVertexAttr(VertexAttr::Position);
+    if (InvalidIndex == compIndex) {
+        return false;
+    }
+    const VertexFormat::Code fmt = layout.ComponentAt(compIndex).Format;
+    const int stride = layout.ByteSize();
+    const uint8_t* ptr = vertices + layout.ComponentByteOffset(compIndex);
+    outPositions.Reserve(setup.NumVertices);
+    for (int i = 0; i < setup.NumVertices; i++, ptr += stride) {
+        glm::vec3 pos;
+        switch (fmt) {
+            case VertexFormat::Float3:
+            case VertexFormat::Float4:
+                {
+                    const float* f = (const float*) ptr;
+                    pos = glm::vec3(f[0], f[1], f[2]);
+                }
+                break;
+            case VertexFormat::Short4N:
+                {
+                    const int16_t* s = (const int16_t*) ptr;
+                    pos = glm::vec3(s[0], s[1], s[2]) * (mag / 32767.0f);
+                }
+                break;
+            case VertexFormat::Byte4N:
+                {
+                    const int8_t* b = (const int8_t*) ptr;
+                    pos = glm::vec3(b[0], b[1], b[2]) * (mag / 127.0f);
+                }
+                break;
+            default:
+                return false;
+        }
+        outPositions.Add(pos);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static void optimizeMesh(const MeshSetup& setup, const glm::vec3& mag, uint8_t* data) {
+    uint8_t* vertices = data + setup.VertexDataOffset;
+    uint16_t* indices = (uint16_t*) (data + setup.IndexDataOffset);
+
+    // positions are needed for the overdraw optimization
+    Array<glm::vec3> positions;
+    const bool hasPositions = decodePositions(setup, mag, vertices, positions);
+
+    // reorder triangles per primitive group
+    for (int i = 0; i < setup.NumPrimitiveGroups(); i++) {
+        const PrimitiveGroup& primGroup = setup.PrimitiveGroup(i);
+        uint16_t* groupIndices = indices + primGroup.BaseElement;
+        const int numIndices = primGroup.NumElements;
+        const MeshOptimizer::Stats before = MeshOptimizer::Analyze(groupIndices, numIndices, setup.NumVertices);
+        MeshOptimizer::OptimizeVertexCache(groupIndices, numIndices, setup.NumVertices);
+        if (hasPositions) {
+            MeshOptimizer::OptimizeOverdraw(groupIndices, numIndices, &positions[0], setup.NumVertices);
+        }
+        const MeshOptimizer::Stats after = MeshOptimizer::Analyze(groupIndices, numIndices, setup.NumVertices);
+        Log::Info("OrbLoader: primitive group %d ACMR %.3f => %.3f, ATVR %.3f => %.3f\n",
+            i, before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+    }
+
+    // vertex fetch order covers all primitive groups, since they
+    // share the same vertex buffer
+    MeshOptimizer::OptimizeVertexFetch(vertices, setup.NumVertices, setup.Layout.ByteSize(), indices, setup.NumIndices);
+}
+
 //------------------------------------------------------------------------------
 static AnimSkeletonSetup makeSkeletonSetup(const OrbFile& orb, const Locator& loc) {
     AnimSkeletonSetup setup;
     setup.Locator = loc;
     setup.Bones.Reserve(orb.Bones.Size());
-    for (const auto& src : orb.Bones) {
-        setup.Bones.Add();
-        auto& dst = setup.Bones.Back();
-        dst.Name = orb.Strings[src.Name];
-        dst.ParentIndex = src.Parent;
-        // FIXME: inv bind pose should already be in orb file!
-        glm::vec4 t(src.Translate[0], src.Translate[1], src.Translate[2], 1.0f);
-        glm::vec3 s(src.Scale[0], src.Scale[1], src.Scale[2]);
-        glm::quat r(src.Rotate[3], src.Rotate[0], src.Rotate[1], src.Rotate[2]);
-        glm::mat4 m = glm::scale(glm::mat4(), s);
-        m = m * glm::mat4_cast(r);
-        m[3] = t;
-        if (dst.ParentIndex != -1) {
-            m = setup.Bones[dst.ParentIndex].BindPose * m;
-        }
-        dst.InvBindPose = glm::inverse(m);
-        dst.BindPose = m;
+    if (orb.IsCooked()) {
+        // use the bind poses baked by the OrbCook tool
+        for (int i = 0; i < orb.Bones.Size(); i++) {
+            auto& dst = setup.Bones.Add();
+            dst.Name = orb.Strings[orb.Bones[i].Name];
+            dst.ParentIndex = orb.Bones[i].Parent;
+            dst.BindPose = glm::make_mat4(orb.CookedBindPoses[i].Values);
+            dst.InvBindPose = glm::make_mat4(orb.CookedInvBindPoses[i].Values);
+        }
+    }
+    else {
+        Array<glm::mat4> bindPoses;
+        bindPoses.Reserve(orb.Bones.Size());
+        for (int i = 0; i < orb.Bones.Size(); i++) {
+            bindPoses.Add();
+        }
+        if (!bindPoses.Empty()) {
+            orb.ComputeBindPoses(&bindPoses[0], bindPoses.Size());
+        }
+        for (int i = 0; i < orb.Bones.Size(); i++) {
+            auto& dst = setup.Bones.Add();
+            dst.Name = orb.Strings[orb.Bones[i].Name];
+            dst.ParentIndex = orb.Bones[i].Parent;
+            dst.BindPose = bindPoses[i];
+            dst.InvBindPose = glm::inverse(bindPoses[i]);
+        }
     }
     return setup;
 }
@@ -132,6 +216,23 @@ static AnimLibrarySetup makeAnimLibSetup(const OrbFile& orb, const Locator& loc)
 //------------------------------------------------------------------------------
 bool
 OrbLoader::Load(const Buffer& data, const StringAtom& name, OrbModel& model) {
+    return Load(data, name, model, Options());
+}
+
+//------------------------------------------------------------------------------
+bool
+OrbLoader::LoadMeshSetup(const Buffer& data, MeshSetup& outSetup) {
+    OrbFile orb;
+    if (!orb.Parse(data.Data(), data.Size())) {
+        return false;
+    }
+    outSetup = makeMeshSetup(orb, Locator::NonShared());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+OrbLoader::Load(const Buffer& data, const StringAtom& name, OrbModel& model, const Options& options) {
     model = OrbModel();
 
     // parse the .orb file
@@ -141,14 +242,63 @@ OrbLoader::Load(const Buffer& data, const StringAtom& name, OrbModel& model) {
     }
     model.VertexMagnitude = glm::vec4(orb.VertexMagnitude, 1.0f);
 
-    // one mesh for entire model
+    // one mesh for entire model, or a range in a shared pool mesh
     model.MeshSetup = makeMeshSetup(orb, Locator(name, MeshSignature));
-    model.Mesh = Gfx::CreateResource(model.MeshSetup, data.Data(), data.Size());
+    const bool cookedOptimized = orb.IsCooked() && (orb.Cooked->Flags & OrbCookedFlags::MeshOptimized);
+    const uint8_t* meshData = data.Data();
+    Buffer optimized;
+    if (options.OptimizeMesh && !cookedOptimized) {
+        // optimize a copy of the vertex and index data, the
+        // original file data is const
+        optimized.Add(data.Data(), data.Size());
+        optimizeMesh(model.MeshSetup, orb.VertexMagnitude, optimized.Data());
+        meshData = optimized.Data();
+    }
+    if (options.Pool) {
+        auto& r = model.PoolRange;
+        r.NumVertices = model.MeshSetup.NumVertices;
+        r.NumIndices = model.MeshSetup.NumIndices;
+        if (!options.Pool->Alloc(model.MeshSetup.Layout,
+                meshData + model.MeshSetup.VertexDataOffset, r.NumVertices,
+                (const uint16_t*)(meshData + model.MeshSetup.IndexDataOffset), r.NumIndices,
+                r.BaseVertex, r.FirstIndex)) {
+            return false;
+        }
+        model.Mesh = options.Pool->Mesh();
+        model.Pooled = true;
+    }
+    else {
+        model.Mesh = Gfx::CreateResource(model.MeshSetup, meshData, data.Size());
+    }
 
     // materials hold shader uniform blocks and textures
-    for (int i = 0; i < orb.Materials.Size(); i++) {
-        model.Materials.Add();
-        // FIXME: setup textures here
+    for (const auto& src : orb.Materials) {
+        OrbModel::Material& mat = model.Materials.Add();
+        if (src.Name < uint32_t(orb.Strings.Size())) {
+            mat.Name = orb.Strings[src.Name];
+        }
+        if ((src.FirstTextureProp + src.NumTextureProps) > uint32_t(orb.TexProps.Size())) {
+            Log::Warn("OrbLoader: material '%s' has invalid texture properties\n", mat.Name.AsCStr());
+            continue;
+        }
+        for (uint32_t i = 0; i < src.NumTextureProps; i++) {
+            const OrbTextureProperty& prop = orb.TexProps[src.FirstTextureProp + i];
+            if (mat.Textures.Size() == OrbModel::MaxNumTextures) {
+                Log::Warn("OrbLoader: too many textures in material '%s'\n", mat.Name.AsCStr());
+                break;
+            }
+            if ((prop.Name >= uint32_t(orb.Strings.Size())) || (prop.Location >= uint32_t(orb.Strings.Size()))) {
+                continue;
+            }
+            OrbModel::Texture& tex = mat.Textures.Add();
+            tex.Name = orb.Strings[prop.Name];
+            if (options.Textures && (!options.TextureName.IsValid() || (options.TextureName == tex.Name))) {
+                StringBuilder strBuilder(options.TexturePath.AsCStr());
+                strBuilder.Append(orb.Strings[prop.Location]);
+                strBuilder.Append(options.TextureExt.AsCStr());
+                tex.Stream = options.Textures->Load(strBuilder.GetString());
+            }
+        }
     }
 
     // submeshes link materials to mesh primitive groups
@@ -156,13 +306,59 @@ OrbLoader::Load(const Buffer& data, const StringAtom& name, OrbModel& model) {
         OrbModel::Submesh& m = model.Submeshes.Add();
         m.MaterialIndex = orb.Meshes[i].Material;
         m.PrimitiveGroupIndex = i;
+        const PrimitiveGroup& primGroup = model.MeshSetup.PrimitiveGroup(i);
+        m.BaseVertex = model.PoolRange.BaseVertex;
+        m.FirstIndex = model.PoolRange.FirstIndex + primGroup.BaseElement;
+        m.NumIndices = primGroup.NumElements;
+    }
+
+    // pre-computed bounds from cooked data
+    if (orb.IsCooked()) {
+        auto toAABB = [](const OrbCookedBounds& src) -> OrbModel::AABB {
+            OrbModel::AABB dst;
+            dst.Min = glm::make_vec3(src.Min);
+            dst.Max = glm::make_vec3(src.Max);
+            return dst;
+        };
+        for (int i = 0; i < model.Submeshes.Size(); i++) {
+            model.Submeshes[i].Bounds = toAABB(orb.CookedSubmeshBounds[i]);
+            if (0 == i) {
+                model.Bounds = model.Submeshes[i].Bounds;
+            }
+            else {
+                model.Bounds.Min = glm::min(model.Bounds.Min, model.Submeshes[i].Bounds.Min);
+                model.Bounds.Max = glm::max(model.Bounds.Max, model.Submeshes[i].Bounds.Max);
+            }
+        }
+        model.BoneBounds.Reserve(orb.CookedBoneBounds.Size());
+        for (const auto& src : orb.CookedBoneBounds) {
+            model.BoneBounds.Add(toAABB(src));
+        }
+        model.HasBounds = true;
     }
 
     // character stuff
     if (orb.HasCharacter()) {
+        Anim::PushLabel();
         model.Skeleton = Anim::Create(makeSkeletonSetup(orb, Locator(name, AnimSkeletonSignature)));
-        model.AnimLib = Anim::Create(makeAnimLibSetup(orb, Locator(name, AnimLibrarySignature)));
-        Anim::WriteKeys(model.AnimLib, orb.Start+orb.AnimDataOffset, orb.AnimDataSize);
+        if (options.CompressAnim) {
+            // compress from a temporary anim library which is destroyed
+            // right away, so that only the compressed keys stay resident
+            Anim::PushLabel();
+            Id tmpLib = Anim::Create(makeAnimLibSetup(orb, Locator(name, AnimLibrarySignature)));
+            const ResourceLabel tmpLabel = Anim::PopLabel();
+            Anim::WriteKeys(tmpLib, orb.Start+orb.AnimDataOffset, orb.AnimDataSize);
+            AnimCompression::Params params;
+            AnimCompression::Compress(Anim::Library(tmpLib), params, model.CompressedAnim);
+            Anim::Destroy(tmpLabel);
+            Log::Info("OrbLoader: compressed anim keys %d => %d bytes\n",
+                model.CompressedAnim.UncompressedByteSize, model.CompressedAnim.ByteSize());
+        }
+        else {
+            model.AnimLib = Anim::Create(makeAnimLibSetup(orb, Locator(name, AnimLibrarySignature)));
+            Anim::WriteKeys(model.AnimLib, orb.Start+orb.AnimDataOffset, orb.AnimDataSize);
+        }
+        model.AnimLabel = Anim::PopLabel();
     }
     model.IsValid = true;
     return true;
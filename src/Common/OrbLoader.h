@@ -6,13 +6,36 @@
 */
 #include "Common/OrbModel.h"
 #include "Core/Containers/Buffer.h"
+#include "Common/OrbModelPool.h"
+#include "Common/TextureStreamer.h"
 
 namespace Oryol {
 
 class OrbLoader {
 public:
+    /// optional processing steps at load time
+    struct Options {
+        /// reorder triangles and vertices for vertex cache, overdraw and fetch locality
+        bool OptimizeMesh = false;
+        /// compress the animation keys into OrbModel::CompressedAnim (no AnimLib is created)
+        bool CompressAnim = false;
+        /// put the mesh data into a shared pool instead of creating a mesh
+        OrbModelPool* Pool = nullptr;
+        /// load material textures through a texture streamer
+        TextureStreamer* Textures = nullptr;
+        /// only load textures with this property name (e.g. "DiffMap0"), all if not set
+        StringAtom TextureName;
+        /// prefix for texture locations in the .orb file (e.g. "orb:")
+        StringAtom TexturePath;
+        /// file extension appended to texture locations (e.g. ".dds")
+        StringAtom TextureExt;
+    };
     /// load .orb file data in Buffer object into OrbModel
     static bool Load(const Buffer& data, const StringAtom& name, OrbModel& outModel);
+    /// load .orb file data with optional processing steps
+    static bool Load(const Buffer& data, const StringAtom& name, OrbModel& outModel, const Options& options);
+    /// get the vertex layout and vertex/index counts of .orb file data (e.g. to setup an OrbModelPool)
+    static bool LoadMeshSetup(const Buffer& data, MeshSetup& outSetup);
 };
 
 } // namespace Oryol
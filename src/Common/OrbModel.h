@@ -5,7 +5,11 @@
     @brief wrap graphics resources for a 3d model created from a .orb file
 */
 #include "Core/Containers/InlineArray.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/StringAtom.h"
 #include "Gfx/GfxTypes.h"
+#include "Common/AnimCompression.h"
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
 namespace Oryol {
@@ -13,25 +17,64 @@ namespace Oryol {
 struct OrbModel {
     static const int MaxNumMaterials = 8;
     static const int MaxNumSubmeshes = 8;
+    static const int MaxNumTextures = 4;
 
+    struct AABB {
+        glm::vec3 Min;
+        glm::vec3 Max;
+    };
+    struct Texture {
+        StringAtom Name;
+        /// TextureStreamer handle, -1 if not loaded
+        int Stream = -1;
+    };
     struct Material {
-        // FIXME
-        uint32_t dummy = 0;
+        StringAtom Name;
+        InlineArray<Texture, MaxNumTextures> Textures;
     };
     struct Submesh {
         int MaterialIndex = 0;
         int PrimitiveGroupIndex = 0;
+        /// vertex and index range in Mesh (indices are already rebased to BaseVertex)
+        int BaseVertex = 0;
+        int FirstIndex = 0;
+        int NumIndices = 0;
         bool Visible = false;
+        AABB Bounds;
+    };
+    /// vertex and index range of a model in an OrbModelPool
+    struct Range {
+        int BaseVertex = 0;
+        int NumVertices = 0;
+        int FirstIndex = 0;
+        int NumIndices = 0;
     };
 
     bool IsValid = false;
     class MeshSetup MeshSetup;
     glm::vec4 VertexMagnitude;
+    /// the model's own mesh, or the shared mesh of an OrbModelPool
     Id Mesh;
+    /// true if the mesh data lives in an OrbModelPool
+    bool Pooled = false;
+    /// the model's range in the pool (if Pooled)
+    Range PoolRange;
     Id Skeleton;
+    /// not valid if loaded with OrbLoader::Options::CompressAnim
     Id AnimLib;
+    /// resource label of the Skeleton and AnimLib
+    ResourceLabel AnimLabel;
+    /// only valid if loaded with OrbLoader::Options::CompressAnim
+    CompressedAnimLibrary CompressedAnim;
     InlineArray<Material, MaxNumMaterials> Materials;
     InlineArray<Submesh, MaxNumSubmeshes> Submeshes;
+
+    /// bounds are only valid if the .orb file was cooked
+    bool HasBounds = false;
+    /// model-space bounds of all submeshes
+    AABB Bounds;
+    /// per-bone bounds of skinned vertices, in bone space
+    Array<AABB> BoneBounds;
 };
 
 } // namespace Oryol
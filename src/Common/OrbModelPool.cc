@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------
+//  OrbModelPool.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "OrbModelPool.h"
+#include "OrbModel.h"
+#include "Core/Assertion.h"
+#include "Core/Log.h"
+#include "Core/Memory/Memory.h"
+#include "Gfx/Gfx.h"
+#include "Anim/Anim.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+OrbModelPool::~OrbModelPool() {
+    if (this->valid) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+OrbModelPool::Setup(const VertexLayout& vertexLayout, int numVertices, int numIndices) {
+    o_assert_dbg(!this->valid);
+    o_assert_dbg((numVertices > 0) && (numIndices > 0));
+    this->valid = true;
+    this->dirty = false;
+    this->layout = vertexLayout;
+    this->maxNumVertices = numVertices;
+    this->maxNumIndices = numIndices;
+    this->indexType = (numVertices > (1<<16)) ? IndexType::Index32 : IndexType::Index16;
+    this->numUsedVertices = 0;
+    this->numUsedIndices = 0;
+    this->vertexHighWater = 0;
+    this->indexHighWater = 0;
+    this->freeVertices.Add().num = numVertices;
+    this->freeIndices.Add().num = numIndices;
+    this->vertexData.Add(numVertices * vertexLayout.ByteSize());
+    this->indexData.Add(numIndices * IndexType::ByteSize(this->indexType));
+
+    auto meshSetup = MeshSetup::Empty(numVertices, Usage::Dynamic, this->indexType, numIndices, Usage::Dynamic);
+    meshSetup.Layout = vertexLayout;
+    Gfx::PushResourceLabel();
+    this->mesh = Gfx::CreateResource(meshSetup);
+    this->label = Gfx::PopResourceLabel();
+}
+
+//------------------------------------------------------------------------------
+void
+OrbModelPool::Discard() {
+    o_assert_dbg(this->valid);
+    Gfx::DestroyResources(this->label);
+    this->mesh.Invalidate();
+    this->freeVertices.Clear();
+    this->freeIndices.Clear();
+    this->vertexData.Clear();
+    this->indexData.Clear();
+    this->valid = false;
+}
+
+//------------------------------------------------------------------------------
+bool
+OrbModelPool::IsValid() const {
+    return this->valid;
+}
+
+//------------------------------------------------------------------------------
+int
+OrbModelPool::allocRange(Array<range>& freeList, int num) {
+    for (int i = 0; i < freeList.Size(); i++) {
+        range& r = freeList[i];
+        if (r.num >= num) {
+            const int first = r.first;
+            r.first += num;
+            r.num -= num;
+            if (0 == r.num) {
+                freeList.Erase(i);
+            }
+            return first;
+        }
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+void
+OrbModelPool::freeRange(Array<range>& freeList, int first, int num) {
+    // free list is sorted by start, merge with neighbours
+    int i = 0;
+    while ((i < freeList.Size()) && (freeList[i].first < first)) {
+        i++;
+    }
+    range r;
+    r.first = first;
+    r.num = num;
+    freeList.Insert(i, r);
+    if (((i + 1) < freeList.Size()) && ((freeList[i].first + freeList[i].num) == freeList[i+1].first)) {
+        freeList[i].num += freeList[i+1].num;
+        freeList.Erase(i + 1);
+    }
+    if ((i > 0) && ((freeList[i-1].first + freeList[i-1].num) == freeList[i].first)) {
+        freeList[i-1].num += freeList[i].num;
+        freeList.Erase(i);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+OrbModelPool::Alloc(const VertexLayout& vertexLayout, const uint8_t* vertices, int numVertices, const uint16_t* indices, int numIndices, int& outBaseVertex, int& outFirstIndex) {
+    o_assert_dbg(this->valid && vertices && indices);
+    if (vertexLayout.ByteSize() != this->layout.ByteSize() || vertexLayout.NumComponents() != this->layout.NumComponents()) {
+        Log::Error("OrbModelPool: vertex layout doesn't match pool layout\n");
+        return false;
+    }
+    for (int i = 0; i < this->layout.NumComponents(); i++) {
+        if ((vertexLayout.ComponentAt(i).Attr != this->layout.ComponentAt(i).Attr) ||
+            (vertexLayout.ComponentAt(i).Format != this->layout.ComponentAt(i).Format)) {
+            Log::Error("OrbModelPool: vertex layout doesn't match pool layout\n");
+            return false;
+        }
+    }
+    const int baseVertex = allocRange(this->freeVertices, numVertices);
+    if (baseVertex < 0) {
+        Log::Error("OrbModelPool: out of vertex space (%d requested)\n", numVertices);
+        return false;
+    }
+    const int firstIndex = allocRange(this->freeIndices, numIndices);
+    if (firstIndex < 0) {
+        freeRange(this->freeVertices, baseVertex, numVertices);
+        Log::Error("OrbModelPool: out of index space (%d requested)\n", numIndices);
+        return false;
+    }
+
+    // copy vertices and rebased indices into the CPU-side copy
+    const int vertexSize = this->layout.ByteSize();
+    Memory::Copy(vertices, this->vertexData.Data() + baseVertex * vertexSize, numVertices * vertexSize);
+    if (IndexType::Index32 == this->indexType) {
+        uint32_t* dst = ((uint32_t*)this->indexData.Data()) + firstIndex;
+        for (int i = 0; i < numIndices; i++) {
+            dst[i] = uint32_t(indices[i]) + uint32_t(baseVertex);
+        }
+    }
+    else {
+        uint16_t* dst = ((uint16_t*)this->indexData.Data()) + firstIndex;
+        for (int i = 0; i < numIndices; i++) {
+            dst[i] = uint16_t(indices[i] + baseVertex);
+        }
+    }
+    this->numUsedVertices += numVertices;
+    this->numUsedIndices += numIndices;
+    if ((baseVertex + numVertices) > this->vertexHighWater) {
+        this->vertexHighWater = baseVertex + numVertices;
+    }
+    if ((firstIndex + numIndices) > this->indexHighWater) {
+        this->indexHighWater = firstIndex + numIndices;
+    }
+    this->dirty = true;
+    outBaseVertex = baseVertex;
+    outFirstIndex = firstIndex;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+OrbModelPool::Free(OrbModel& model) {
+    o_assert_dbg(this->valid);
+    o_assert_dbg(model.Mesh == this->mesh);
+    const auto& r = model.PoolRange;
+    freeRange(this->freeVertices, r.BaseVertex, r.NumVertices);
+    freeRange(this->freeIndices, r.FirstIndex, r.NumIndices);
+    this->numUsedVertices -= r.NumVertices;
+    this->numUsedIndices -= r.NumIndices;
+    model.Mesh.Invalidate();
+    model.PoolRange = OrbModel::Range();
+    model.Pooled = false;
+    model.IsValid = false;
+    if (ResourceLabel::Invalid != model.AnimLabel) {
+        Anim::Destroy(model.AnimLabel);
+        model.AnimLabel = ResourceLabel::Invalid;
+    }
+    model.Skeleton.Invalidate();
+    model.AnimLib.Invalidate();
+    model.CompressedAnim = CompressedAnimLibrary();
+
+    // no need to upload anything, the freed range is no longer referenced,
+    // but the high water marks may shrink
+    const range& lastVertices = this->freeVertices.Back();
+    if ((lastVertices.first + lastVertices.num) == this->maxNumVertices) {
+        this->vertexHighWater = lastVertices.first;
+    }
+    const range& lastIndices = this->freeIndices.Back();
+    if ((lastIndices.first + lastIndices.num) == this->maxNumIndices) {
+        this->indexHighWater = lastIndices.first;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+OrbModelPool::Update() {
+    o_assert_dbg(this->valid);
+    if (this->dirty) {
+        this->dirty = false;
+        if (this->vertexHighWater > 0) {
+            Gfx::UpdateVertices(this->mesh, this->vertexData.Data(), this->vertexHighWater * this->layout.ByteSize());
+        }
+        if (this->indexHighWater > 0) {
+            Gfx::UpdateIndices(this->mesh, this->indexData.Data(), this->indexHighWater * IndexType::ByteSize(this->indexType));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+Id
+OrbModelPool::Mesh() const {
+    return this->mesh;
+}
+
+//------------------------------------------------------------------------------
+const VertexLayout&
+OrbModelPool::Layout() const {
+    return this->layout;
+}
+
+//------------------------------------------------------------------------------
+int
+OrbModelPool::NumUsedVertices() const {
+    return this->numUsedVertices;
+}
+
+//------------------------------------------------------------------------------
+int
+OrbModelPool::NumUsedIndices() const {
+    return this->numUsedIndices;
+}
+
+} // namespace Oryol
@@ -0,0 +1,93 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::OrbModelPool
+    @brief share one vertex and index buffer between many OrbModels
+
+    The pool owns a single mesh, models loaded with
+    OrbLoader::Options::Pool get a range of vertices and indices in
+    this mesh instead of their own mesh. All models in a pool must
+    have the same vertex layout, so they can be rendered with the
+    same pipeline and without switching meshes, using the
+    FirstIndex/NumIndices of each OrbModel::Submesh.
+
+    Indices are rebased to the model's base vertex when copied into
+    the pool, since not all platforms can draw with a base vertex,
+    the pool uses 32-bit indices if it holds more than 64k vertices.
+
+    The pool keeps a CPU copy of the buffer contents. Alloc() only
+    writes into this copy, Update() then uploads everything up to the
+    highest allocated vertex and index once per frame, no matter how
+    many models were added: Gfx::UpdateVertices/UpdateIndices always
+    overwrite a buffer from its start and may only be called once per
+    frame, so a new range can't be uploaded on its own. Freed ranges
+    are merged and reused by later loads (first fit, so the uploaded
+    range stays as small as possible).
+
+    Free() also destroys the model's Skeleton and AnimLib.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Gfx/GfxTypes.h"
+
+namespace Oryol {
+
+struct OrbModel;
+
+class OrbModelPool {
+public:
+    /// destructor
+    ~OrbModelPool();
+    /// setup the pool with a vertex layout and capacity
+    void Setup(const VertexLayout& layout, int maxNumVertices, int maxNumIndices);
+    /// discard the pool
+    void Discard();
+    /// return true if the pool has been setup
+    bool IsValid() const;
+
+    /// copy vertices and rebased indices into the pool, returns false if out of space
+    bool Alloc(const VertexLayout& layout, const uint8_t* vertices, int numVertices, const uint16_t* indices, int numIndices, int& outBaseVertex, int& outFirstIndex);
+    /// release the pool ranges and anim resources of a model loaded into this pool
+    void Free(OrbModel& model);
+    /// upload pool content if it has changed, call once per frame before rendering
+    void Update();
+
+    /// get the shared mesh
+    Id Mesh() const;
+    /// get the vertex layout
+    const VertexLayout& Layout() const;
+    /// number of vertices currently allocated
+    int NumUsedVertices() const;
+    /// number of indices currently allocated
+    int NumUsedIndices() const;
+
+private:
+    struct range {
+        int first = 0;
+        int num = 0;
+    };
+    /// first-fit allocate from a free list
+    static int allocRange(Array<range>& freeList, int num);
+    /// return a range to a free list, merging adjacent ranges
+    static void freeRange(Array<range>& freeList, int first, int num);
+
+    bool valid = false;
+    bool dirty = false;
+    VertexLayout layout;
+    IndexType::Code indexType = IndexType::Index16;
+    int maxNumVertices = 0;
+    int maxNumIndices = 0;
+    int numUsedVertices = 0;
+    int numUsedIndices = 0;
+    // end of the highest allocated range, only this part is uploaded
+    int vertexHighWater = 0;
+    int indexHighWater = 0;
+    Array<range> freeVertices;
+    Array<range> freeIndices;
+    Buffer vertexData;
+    Buffer indexData;
+    ResourceLabel label;
+    Id mesh;
+};
+
+} // namespace Oryol
@@ -0,0 +1,343 @@
+//------------------------------------------------------------------------------
+//  TextureStreamer.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "TextureStreamer.h"
+#include "OrbModel.h"
+#include "Core/Assertion.h"
+#include "Core/Log.h"
+#include "Gfx/Gfx.h"
+#include "IO/IO.h"
+#define GLIML_ASSERT(x) o_assert(x)
+#include "gliml/gliml.h"
+#include <algorithm>
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+TextureStreamer::~TextureStreamer() {
+    if (this->valid) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::Setup(int memBudget, int uplBudget) {
+    o_assert_dbg(!this->valid);
+    this->valid = true;
+    this->memoryBudget = memBudget;
+    this->uploadBudget = uplBudget;
+    this->numResidentBytes = 0;
+    this->numUploadedBytes = 0;
+
+    // a small grey texture which is used until the real texture is loaded
+    const int size = 4;
+    uint32_t pixels[size * size];
+    for (int i = 0; i < size * size; i++) {
+        pixels[i] = 0xFF808080;
+    }
+    auto texSetup = TextureSetup::FromPixelData2D(size, size, 1, PixelFormat::RGBA8);
+    texSetup.Sampler.MinFilter = TextureFilterMode::Nearest;
+    texSetup.Sampler.MagFilter = TextureFilterMode::Nearest;
+    texSetup.ImageData.Sizes[0][0] = sizeof(pixels);
+    Gfx::PushResourceLabel();
+    this->placeholder = Gfx::CreateResource(texSetup, pixels, sizeof(pixels));
+    this->label = Gfx::PopResourceLabel();
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::Discard() {
+    o_assert_dbg(this->valid);
+    for (auto& tex : this->textures) {
+        if (tex.tex.IsValid()) {
+            Gfx::DestroyResources(tex.label);
+        }
+    }
+    this->textures.Clear();
+    this->handles.Clear();
+    Gfx::DestroyResources(this->label);
+    this->placeholder.Invalidate();
+    this->valid = false;
+    this->generation++;
+}
+
+//------------------------------------------------------------------------------
+bool
+TextureStreamer::IsValid() const {
+    return this->valid;
+}
+
+//------------------------------------------------------------------------------
+int
+TextureStreamer::Load(const StringAtom& location) {
+    o_assert_dbg(this->valid);
+    if (this->handles.Contains(location)) {
+        return this->handles[location];
+    }
+    const int handle = this->textures.Size();
+    texture& tex = this->textures.Add();
+    tex.location = location;
+    this->handles.Add(location, handle);
+
+    // the texture array may grow while loading, so only capture the handle,
+    // and the generation, the texture is gone if Discard() has been called
+    const uint32_t gen = this->generation;
+    IO::Load(location.AsCStr(), [this, handle, gen](IO::LoadResult res) {
+        if (gen != this->generation) {
+            return;
+        }
+        texture& tex = this->textures[handle];
+        tex.data = std::move(res.Data);
+        tex.loaded = true;
+    },
+    [this, handle, gen](const URL& url, IOStatus::Code ioStatus) {
+        Log::Error("TextureStreamer: failed to load '%s' with '%s'\n", url.AsCStr(), IOStatus::ToString(ioStatus));
+        if (gen != this->generation) {
+            return;
+        }
+        this->textures[handle].failed = true;
+    });
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+Id
+TextureStreamer::Texture(int handle) const {
+    if (handle < 0) {
+        return this->placeholder;
+    }
+    const texture& tex = this->textures[handle];
+    return tex.tex.IsValid() ? tex.tex : this->placeholder;
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::Use(int handle, float screenSize) {
+    texture& tex = this->textures[handle];
+    if (screenSize > tex.screenSize) {
+        tex.screenSize = screenSize;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::UseModel(const OrbModel& model, float screenSize) {
+    for (const auto& mat : model.Materials) {
+        for (const auto& tex : mat.Textures) {
+            if (tex.Stream >= 0) {
+                this->Use(tex.Stream, screenSize);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+TextureStreamer::parse(texture& tex) {
+    gliml::context ctx;
+    ctx.enable_dxt(true);
+    ctx.enable_pvrtc(true);
+    ctx.enable_etc2(true);
+    if (!ctx.load(tex.data.Data(), tex.data.Size())) {
+        Log::Error("TextureStreamer: '%s' is not a valid DDS, PVR or KTX file\n", tex.location.AsCStr());
+        return false;
+    }
+    if (!ctx.is_2d() || (ctx.num_faces() != 1)) {
+        Log::Error("TextureStreamer: '%s' is not a 2D texture\n", tex.location.AsCStr());
+        return false;
+    }
+    // compressed formats are only used if the GPU supports them
+    const bool dxt = Gfx::QueryFeature(GfxFeature::TextureCompressionDXT);
+    const bool pvrtc = Gfx::QueryFeature(GfxFeature::TextureCompressionPVRTC);
+    const bool etc2 = Gfx::QueryFeature(GfxFeature::TextureCompressionETC2);
+    tex.format = PixelFormat::InvalidPixelFormat;
+    switch (ctx.image_internal_format()) {
+        case GLIML_GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:    if (dxt) tex.format = PixelFormat::DXT1; break;
+        case GLIML_GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:    if (dxt) tex.format = PixelFormat::DXT3; break;
+        case GLIML_GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:    if (dxt) tex.format = PixelFormat::DXT5; break;
+        case GLIML_GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:  if (pvrtc) tex.format = PixelFormat::PVRTC2_RGB; break;
+        case GLIML_GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:  if (pvrtc) tex.format = PixelFormat::PVRTC4_RGB; break;
+        case GLIML_GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG: if (pvrtc) tex.format = PixelFormat::PVRTC2_RGBA; break;
+        case GLIML_GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG: if (pvrtc) tex.format = PixelFormat::PVRTC4_RGBA; break;
+        case GLIML_GL_COMPRESSED_RGB8_ETC2:             if (etc2) tex.format = PixelFormat::ETC2_RGB8; break;
+        case GLIML_GL_RGBA:                             tex.format = PixelFormat::RGBA8; break;
+        case GLIML_GL_RGB:                              tex.format = PixelFormat::RGB8; break;
+        default: break;
+    }
+    if (PixelFormat::InvalidPixelFormat == tex.format) {
+        Log::Error("TextureStreamer: '%s' has a pixel format which isn't supported on this platform\n", tex.location.AsCStr());
+        return false;
+    }
+    tex.numMips = std::min(ctx.num_mipmaps(0), int(GfxConfig::MaxNumTextureMipMaps));
+    tex.tailMip = tex.numMips - 1;
+    for (int i = 0; i < tex.numMips; i++) {
+        mipLevel& mip = tex.mips[i];
+        mip.offset = int(((const uint8_t*)ctx.image_data(0, i)) - tex.data.Data());
+        mip.size = ctx.image_size(0, i);
+        mip.width = ctx.image_width(0, i);
+        mip.height = ctx.image_height(0, i);
+        if ((i < tex.tailMip) && (std::max(mip.width, mip.height) <= TailSize)) {
+            tex.tailMip = i;
+        }
+    }
+    tex.residentMip = tex.numMips;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int
+TextureStreamer::byteSize(const texture& tex, int mip) const {
+    int size = 0;
+    for (int i = mip; i < tex.numMips; i++) {
+        size += tex.mips[i].size;
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::recreate(texture& tex, int mip) {
+    o_assert_dbg((mip >= 0) && (mip < tex.numMips));
+    if (tex.tex.IsValid()) {
+        Gfx::DestroyResources(tex.label);
+    }
+    const mipLevel& top = tex.mips[mip];
+    auto texSetup = TextureSetup::FromPixelData2D(top.width, top.height, tex.numMips - mip, tex.format);
+    texSetup.Sampler.MinFilter = TextureFilterMode::LinearMipmapLinear;
+    texSetup.Sampler.MagFilter = TextureFilterMode::Linear;
+    texSetup.Sampler.WrapU = TextureWrapMode::Repeat;
+    texSetup.Sampler.WrapV = TextureWrapMode::Repeat;
+    // mip data is referenced in place in the file data
+    for (int i = mip; i < tex.numMips; i++) {
+        texSetup.ImageData.Offsets[0][i - mip] = tex.mips[i].offset;
+        texSetup.ImageData.Sizes[0][i - mip] = tex.mips[i].size;
+    }
+    Gfx::PushResourceLabel();
+    tex.tex = Gfx::CreateResource(texSetup, tex.data.Data(), tex.data.Size());
+    tex.label = Gfx::PopResourceLabel();
+
+    const int newSize = this->byteSize(tex, mip);
+    this->numResidentBytes += newSize - this->byteSize(tex, tex.residentMip);
+    this->numUploadedBytes += newSize;
+    tex.residentMip = mip;
+}
+
+//------------------------------------------------------------------------------
+void
+TextureStreamer::Update() {
+    o_assert_dbg(this->valid);
+    this->numUploadedBytes = 0;
+
+    // create the mip tail of newly loaded textures, these are always
+    // created, even if over budget, so that everything can be rendered
+    this->order.Clear();
+    for (int i = 0; i < this->textures.Size(); i++) {
+        texture& tex = this->textures[i];
+        if (tex.failed) {
+            continue;
+        }
+        if (tex.loaded && (0 == tex.numMips)) {
+            if (this->parse(tex)) {
+                this->recreate(tex, tex.tailMip);
+            }
+            else {
+                tex.failed = true;
+                tex.data.Clear();
+                continue;
+            }
+        }
+        if (tex.numMips > 0) {
+            // the wanted top mip is the smallest one which still covers the screen size
+            int mip = tex.tailMip;
+            if (tex.screenSize > 0.0f) {
+                mip = 0;
+                while ((mip < tex.tailMip) && (std::max(tex.mips[mip+1].width, tex.mips[mip+1].height) >= tex.screenSize)) {
+                    mip++;
+                }
+            }
+            tex.wantedMip = mip;
+            this->order.Add(i);
+        }
+    }
+
+    // grow textures in order of their screen size, make room by dropping
+    // mips from textures with the smallest screen size, or which have
+    // more mips than they currently need
+    std::sort(this->order.begin(), this->order.end(), [this](int a, int b) {
+        return this->textures[a].screenSize > this->textures[b].screenSize;
+    });
+    int evict = this->order.Size() - 1;
+    for (int i = 0; i < this->order.Size(); i++) {
+        texture& tex = this->textures[this->order[i]];
+        if (tex.residentMip <= tex.wantedMip) {
+            continue;
+        }
+        // each recreate uploads all mips of the texture, so grow straight
+        // to the largest mip within the upload budget instead of one mip
+        // per frame (at least one mip if nothing was uploaded yet)
+        int mip = tex.wantedMip;
+        while ((mip < (tex.residentMip - 1)) && ((this->numUploadedBytes + this->byteSize(tex, mip)) > this->uploadBudget)) {
+            mip++;
+        }
+        if ((this->numUploadedBytes > 0) && ((this->numUploadedBytes + this->byteSize(tex, mip)) > this->uploadBudget)) {
+            break;
+        }
+        // make room by dropping mips of other textures, each texture
+        // drops as many mips as needed at once
+        while (((this->numResidentBytes + this->byteSize(tex, mip) - this->byteSize(tex, tex.residentMip)) > this->memoryBudget) && (evict > i)) {
+            texture& other = this->textures[this->order[evict]];
+            if (other.residentMip < other.tailMip) {
+                const int overBytes = this->numResidentBytes + this->byteSize(tex, mip) - this->byteSize(tex, tex.residentMip) - this->memoryBudget;
+                int otherMip = std::max(other.wantedMip, other.residentMip + 1);
+                while ((otherMip < other.tailMip) && ((this->byteSize(other, other.residentMip) - this->byteSize(other, otherMip)) < overBytes)) {
+                    otherMip++;
+                }
+                this->recreate(other, otherMip);
+            }
+            else {
+                evict--;
+            }
+        }
+        // if there still isn't enough room, grow by fewer mips
+        while ((mip < tex.residentMip) && ((this->numResidentBytes + this->byteSize(tex, mip) - this->byteSize(tex, tex.residentMip)) > this->memoryBudget)) {
+            mip++;
+        }
+        if (mip == tex.residentMip) {
+            break;
+        }
+        this->recreate(tex, mip);
+    }
+
+    // screen sizes must be set again for the next frame
+    for (auto& tex : this->textures) {
+        tex.screenSize = 0.0f;
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+TextureStreamer::NumPending() const {
+    int num = 0;
+    for (const auto& tex : this->textures) {
+        if (!tex.loaded && !tex.failed) {
+            num++;
+        }
+    }
+    return num;
+}
+
+//------------------------------------------------------------------------------
+int
+TextureStreamer::NumResidentBytes() const {
+    return this->numResidentBytes;
+}
+
+//------------------------------------------------------------------------------
+int
+TextureStreamer::NumUploadedBytes() const {
+    return this->numUploadedBytes;
+}
+
+} // namespace Oryol
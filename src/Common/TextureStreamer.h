@@ -0,0 +1,118 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::TextureStreamer
+    @brief progressively load mipmapped textures within a memory budget
+
+    Textures are loaded from DDS, PVR or KTX files (via gliml). Until
+    the file has arrived, Texture() returns a small placeholder texture.
+    Once the file data is available, a texture with only the mip tail
+    (all mips up to TailSize pixels) is created, so that it can be
+    rendered immediately, each Update() then grows textures which need
+    more detail, limited by a per-frame upload budget. Since Gfx
+    textures can't be resized, growing or shrinking a texture replaces
+    it with a new texture (and uploads all its mips again), so a texture
+    grows straight to the wanted mip, or the largest one that fits into
+    the budgets, and is replaced at most once per Update() for growing.
+    Compressed files are only accepted if the GPU supports the format.
+
+    The detail needed for a texture is set each frame with Use() or
+    UseModel(), by passing the size of the textured object on screen in
+    pixels. The top mip which is kept on the GPU is the smallest mip
+    which is still at least that size. Textures which haven't been used
+    in a frame are dropped back to their mip tail first when the GPU
+    memory of all textures would exceed the budget, after that, the
+    textures with the smallest screen size lose their top mips.
+
+    The file data is kept in memory, so that dropped mips can be added
+    back without reloading. Pending loads can't be cancelled, their
+    results are ignored if the streamer has been discarded (or setup
+    again) in the meantime, but the streamer object itself must stay
+    alive until all loads have finished.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/Containers/Map.h"
+#include "Core/Containers/StaticArray.h"
+#include "Core/String/StringAtom.h"
+#include "Gfx/GfxTypes.h"
+
+namespace Oryol {
+
+struct OrbModel;
+
+class TextureStreamer {
+public:
+    /// destructor
+    ~TextureStreamer();
+    /// setup with GPU texture memory budget and per-frame upload budget in bytes
+    void Setup(int memoryBudget, int uploadBudget);
+    /// discard the streamer and all textures
+    void Discard();
+    /// return true if the streamer has been setup
+    bool IsValid() const;
+
+    /// mip levels up to this size are created as soon as a file has been loaded
+    static const int TailSize = 64;
+    /// start loading a texture (returns the existing handle if already loaded)
+    int Load(const StringAtom& location);
+    /// get the current texture (placeholder if not loaded yet, or if handle is -1)
+    Id Texture(int handle) const;
+    /// request detail for a texture, in pixels on screen (largest request per frame wins)
+    void Use(int handle, float screenSize);
+    /// request detail for all textures of an OrbModel
+    void UseModel(const OrbModel& model, float screenSize);
+    /// create, grow and shrink textures, call once per frame
+    void Update();
+
+    /// get the number of textures which are still loading
+    int NumPending() const;
+    /// get the GPU memory used by all textures
+    int NumResidentBytes() const;
+    /// get the number of bytes uploaded in the last Update()
+    int NumUploadedBytes() const;
+
+private:
+    struct mipLevel {
+        int offset = 0;
+        int size = 0;
+        int width = 0;
+        int height = 0;
+    };
+    struct texture {
+        StringAtom location;
+        bool loaded = false;
+        bool failed = false;
+        Buffer data;
+        PixelFormat::Code format = PixelFormat::InvalidPixelFormat;
+        int numMips = 0;
+        StaticArray<mipLevel, GfxConfig::MaxNumTextureMipMaps> mips;
+        int tailMip = 0;
+        int residentMip = 0;
+        int wantedMip = 0;
+        float screenSize = 0.0f;
+        Id tex;
+        ResourceLabel label;
+    };
+    /// setup mip levels of a loaded texture from its file data
+    bool parse(texture& tex);
+    /// GPU byte size of a texture with the top mip at index mip
+    int byteSize(const texture& tex, int mip) const;
+    /// replace the GPU texture with one that starts at a different top mip
+    void recreate(texture& tex, int mip);
+
+    bool valid = false;
+    /// incremented by Discard(), so that late IO callbacks can be ignored
+    uint32_t generation = 0;
+    int memoryBudget = 0;
+    int uploadBudget = 0;
+    int numResidentBytes = 0;
+    int numUploadedBytes = 0;
+    Array<texture> textures;
+    Map<StringAtom, int> handles;
+    Array<int> order;
+    Id placeholder;
+    ResourceLabel label;
+};
+
+} // namespace Oryol
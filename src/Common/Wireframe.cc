@@ -3,8 +3,15 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "Wireframe.h"
+#include "Core/Assertion.h"
+#include "Core/Log.h"
 #include "Gfx/Gfx.h"
+#include <glm/common.hpp>
 #include "wireframe_shaders.h"
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define WIREFRAME_USE_SSE (1)
+#endif
 
 namespace Oryol {
 
@@ -12,15 +19,17 @@ namespace Oryol {
 void
 Wireframe::Setup(const GfxSetup& gfxSetup) {
     Gfx::PushResourceLabel();
-    auto meshSetup = MeshSetup::Empty(MaxNumVertices, Usage::Stream);
-    meshSetup.Layout = {
+    this->meshSetup = MeshSetup::Empty(MaxNumVertices, Usage::Stream);
+    this->meshSetup.Layout = {
         { VertexAttr::Position, VertexFormat::Float3 },
-        { VertexAttr::Color0, VertexFormat::Float4 }
+        { VertexAttr::Color0, VertexFormat::UByte4N }
     };
-    this->drawState.Mesh[0] = Gfx::CreateResource(meshSetup);
+    // the first vertex buffer is always needed, more are created on demand
+    this->meshes[0] = Gfx::CreateResource(this->meshSetup);
+    this->numMeshes = 1;
 
     Id shd = Gfx::CreateResource(WireframeShader::Setup());
-    auto pipSetup = PipelineSetup::FromLayoutAndShader(meshSetup.Layout, shd);
+    auto pipSetup = PipelineSetup::FromLayoutAndShader(this->meshSetup.Layout, shd);
     pipSetup.RasterizerState.SampleCount = gfxSetup.SampleCount;
     pipSetup.BlendState.BlendEnabled = true;
     pipSetup.BlendState.SrcFactorRGB = BlendFactor::SrcAlpha;
@@ -32,21 +41,76 @@ Wireframe::Setup(const GfxSetup& gfxSetup) {
     pipSetup.PrimType = PrimitiveType::Lines;
     this->drawState.Pipeline = Gfx::CreateResource(pipSetup);
     this->label = Gfx::PopResourceLabel();
+    this->vertices.Reserve(MaxNumVertices);
 }
 
 //------------------------------------------------------------------------------
 void
 Wireframe::Discard() {
     Gfx::DestroyResources(this->label);
+    this->numMeshes = 0;
+    this->vertices.Clear();
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Wireframe::PackColor(const glm::vec4& c) {
+    const glm::vec4 n = glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return uint32_t(n.x) | (uint32_t(n.y) << 8) | (uint32_t(n.z) << 16) | (uint32_t(n.w) << 24);
 }
 
 //------------------------------------------------------------------------------
 void
-Wireframe::Line(const glm::vec4& p0, const glm::vec4& p1) {
-    if ((this->vertices.Size() + 2) < MaxNumVertices) {
-        this->vertices.Add(this->Model * p0, this->Color);
-        this->vertices.Add(this->Model * p1, this->Color);
+Wireframe::addPoints(const glm::vec4* points, const glm::vec4* colors, uint32_t color, int numPoints) {
+    const int maxNumVertices = MaxNumVertices * MaxNumBuffers;
+    int num = maxNumVertices - this->vertices.Size();
+    num = (numPoints < num ? numPoints : num) & ~1;
+    if (num < numPoints) {
+        if (!this->overflowLogged) {
+            Log::Warn("Wireframe: more than %d vertices, dropping lines\n", maxNumVertices);
+            this->overflowLogged = true;
+        }
+    }
+    if (glm::mat4(1.0f) == this->Model) {
+        for (int i = 0; i < num; i++) {
+            Vertex& v = this->vertices.Add();
+            v.x = points[i].x; v.y = points[i].y; v.z = points[i].z;
+            v.color = colors ? PackColor(colors[i]) : color;
+        }
+        return;
+    }
+    #if WIREFRAME_USE_SSE
+    const glm::mat4& m = this->Model;
+    const __m128 c0 = _mm_loadu_ps(&m[0][0]);
+    const __m128 c1 = _mm_loadu_ps(&m[1][0]);
+    const __m128 c2 = _mm_loadu_ps(&m[2][0]);
+    const __m128 c3 = _mm_loadu_ps(&m[3][0]);
+    for (int i = 0; i < num; i++) {
+        const glm::vec4& p = points[i];
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(p.x));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(p.w)));
+        // the 4th float overlaps the color, which is written after
+        Vertex& v = this->vertices.Add();
+        _mm_storeu_ps(&v.x, r);
+        v.color = colors ? PackColor(colors[i]) : color;
     }
+    #else
+    for (int i = 0; i < num; i++) {
+        const glm::vec4 p = this->Model * points[i];
+        Vertex& v = this->vertices.Add();
+        v.x = p.x; v.y = p.y; v.z = p.z;
+        v.color = colors ? PackColor(colors[i]) : color;
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+Wireframe::Line(const glm::vec4& p0, const glm::vec4& p1) {
+    const glm::vec4 points[2] = { p0, p1 };
+    this->addPoints(points, nullptr, PackColor(this->Color), 2);
 }
 
 //------------------------------------------------------------------------------
@@ -55,6 +119,20 @@ Wireframe::Line(const glm::vec3& p0, const glm::vec3& p1) {
     this->Line(glm::vec4(p0, 1.0f), glm::vec4(p1, 1.0f));
 }
 
+//------------------------------------------------------------------------------
+void
+Wireframe::Lines(const glm::vec4* points, int numPoints) {
+    o_assert_dbg(0 == (numPoints & 1));
+    this->addPoints(points, nullptr, PackColor(this->Color), numPoints);
+}
+
+//------------------------------------------------------------------------------
+void
+Wireframe::Lines(const glm::vec4* points, const glm::vec4* colors, int numPoints) {
+    o_assert_dbg(colors && (0 == (numPoints & 1)));
+    this->addPoints(points, colors, 0, numPoints);
+}
+
 //------------------------------------------------------------------------------
 void
 Wireframe::Rect(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3) {
@@ -64,16 +142,26 @@ Wireframe::Rect(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, c
 //------------------------------------------------------------------------------
 void
 Wireframe::Render() {
-    if (!this->vertices.Empty()) {
-        Gfx::UpdateVertices(this->drawState.Mesh[0], this->vertices.begin(), this->vertices.Size()*sizeof(Vertex));
+    this->NumUploadedBytes = 0;
+    const int numVertices = this->vertices.Size();
+    for (int first = 0, meshIndex = 0; first < numVertices; first += MaxNumVertices, meshIndex++) {
+        const int num = (numVertices - first) < MaxNumVertices ? (numVertices - first) : MaxNumVertices;
+        if (meshIndex == this->numMeshes) {
+            Gfx::PushResourceLabel(this->label);
+            this->meshes[this->numMeshes++] = Gfx::CreateResource(this->meshSetup);
+            Gfx::PopResourceLabel();
+        }
+        const int numBytes = num * sizeof(Vertex);
+        Gfx::UpdateVertices(this->meshes[meshIndex], &this->vertices[first], numBytes);
+        this->NumUploadedBytes += numBytes;
+        this->drawState.Mesh[0] = this->meshes[meshIndex];
         Gfx::ApplyDrawState(this->drawState);
         WireframeShader::vsParams vsParams;
         vsParams.viewProj = this->ViewProj;
         Gfx::ApplyUniformBlock(vsParams);
-        Gfx::Draw({ 0, this->vertices.Size() });
-        this->vertices.Reset();
+        Gfx::Draw({ 0, num });
     }
+    this->vertices.Clear();
 }
 
 } // namespace Oryol
-
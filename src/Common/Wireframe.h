@@ -3,9 +3,16 @@
 /**
     @class Wireframe
     @brief simple wireframe debug renderer
+
+    Lines are transformed by Model on the CPU (skipped if Model is
+    identity) and collected as float positions with a packed color
+    (16 bytes per vertex). Render() uploads and draws the lines in
+    batches of MaxNumVertices, using one vertex buffer per batch
+    (up to MaxNumBuffers).
 */
 #include "Gfx/Gfx.h"
-#include "Core/Containers/InlineArray.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/StaticArray.h"
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -31,19 +38,38 @@ struct Wireframe {
     void Line(const glm::vec3& p0, const glm::vec3& p1);
     /// add a wireframe line (vec4, w must be 1)
     void Line(const glm::vec4& p0, const glm::vec4& p1);
+    /// add lines from point pairs (w must be 1) with the current color
+    void Lines(const glm::vec4* points, int numPoints);
+    /// add lines from point pairs (w must be 1) with per-point colors
+    void Lines(const glm::vec4* points, const glm::vec4* colors, int numPoints);
     /// add a rectangle (vec3)
     void Rect(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3);
+    /// pack a color to UNORM8 RGBA
+    static uint32_t PackColor(const glm::vec4& c);
+
+    /// vertices per vertex buffer
+    static const int MaxNumVertices = (1<<15);
+    /// max number of vertex buffers, lines beyond are dropped
+    static const int MaxNumBuffers = 16;
+    /// bytes uploaded in last Render()
+    int NumUploadedBytes = 0;
 
     DrawState drawState;
     ResourceLabel label;
+    /// the transformed vertices, uploaded as is
     struct Vertex {
-        float x, y, z, r, g, b, a;
-        Vertex() { };
-        Vertex(const glm::vec4& p, const glm::vec4& c):
-            x(p.x), y(p.y), z(p.z), r(c.x), g(c.y), b(c.z), a(c.w) { };
+        float x, y, z;
+        uint32_t color;
     };
-    static const int MaxNumVertices = (1<<15);
-    InlineArray<Vertex, MaxNumVertices> vertices;
+    Array<Vertex> vertices;
+    MeshSetup meshSetup;
+    StaticArray<Id, MaxNumBuffers> meshes;
+    int numMeshes = 0;
+    bool overflowLogged = false;
+
+private:
+    /// transform and add points
+    void addPoints(const glm::vec4* points, const glm::vec4* colors, uint32_t color, int numPoints);
 };
 
 }
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+//  WorkerPool.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "WorkerPool.h"
+#include "Core/Assertion.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+WorkerPool::~WorkerPool() {
+    if (this->valid) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+WorkerPool::NumHardwareThreads() {
+    #if ORYOL_HAS_THREADS
+    int num = int(std::thread::hardware_concurrency());
+    if (num < 1) {
+        num = 1;
+    }
+    return (num > MaxNumThreads) ? MaxNumThreads : num;
+    #else
+    return 1;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+WorkerPool::Setup(int num) {
+    o_assert_dbg(!this->valid);
+    o_assert_dbg((num > 0) && (num <= MaxNumThreads));
+    this->valid = true;
+    #if ORYOL_HAS_THREADS
+    this->numThreads = num;
+    this->stop = false;
+    // thread 0 is the thread calling Run()
+    for (int i = 1; i < num; i++) {
+        this->threads[i] = std::thread(&WorkerPool::workerLoop, this, i);
+    }
+    #else
+    this->numThreads = 1;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+WorkerPool::Discard() {
+    o_assert_dbg(this->valid);
+    #if ORYOL_HAS_THREADS
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->wakeup.notify_all();
+    for (int i = 1; i < this->numThreads; i++) {
+        this->threads[i].join();
+    }
+    #endif
+    this->numThreads = 1;
+    this->valid = false;
+}
+
+//------------------------------------------------------------------------------
+bool
+WorkerPool::IsValid() const {
+    return this->valid;
+}
+
+//------------------------------------------------------------------------------
+int
+WorkerPool::NumThreads() const {
+    return this->numThreads;
+}
+
+//------------------------------------------------------------------------------
+void
+WorkerPool::Run(int jobs, int threads, const JobFunc& jobFunc) {
+    o_assert_dbg(this->valid);
+    if (threads > this->numThreads) {
+        threads = this->numThreads;
+    }
+    if (threads > jobs) {
+        threads = jobs;
+    }
+    #if ORYOL_HAS_THREADS
+    if (threads > 1) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->func = &jobFunc;
+            this->numJobs = jobs;
+            this->nextJob = 0;
+            this->numActiveThreads = threads;
+            this->numBusyThreads = threads - 1;
+            this->generation++;
+        }
+        this->wakeup.notify_all();
+        this->runJobs(0);
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->finished.wait(lock, [this] { return 0 == this->numBusyThreads; });
+        this->func = nullptr;
+        return;
+    }
+    #endif
+    for (int i = 0; i < jobs; i++) {
+        jobFunc(i, 0);
+    }
+}
+
+#if ORYOL_HAS_THREADS
+//------------------------------------------------------------------------------
+void
+WorkerPool::runJobs(int threadIndex) {
+    int jobIndex;
+    while ((jobIndex = this->nextJob.fetch_add(1)) < this->numJobs) {
+        (*this->func)(jobIndex, threadIndex);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+WorkerPool::workerLoop(int threadIndex) {
+    uint32_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wakeup.wait(lock, [this, seenGeneration] {
+                return this->stop || (this->generation != seenGeneration);
+            });
+            if (this->stop) {
+                return;
+            }
+            seenGeneration = this->generation;
+            if (threadIndex >= this->numActiveThreads) {
+                // not needed for this run
+                continue;
+            }
+        }
+        this->runJobs(threadIndex);
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (0 == --this->numBusyThreads) {
+                this->finished.notify_one();
+            }
+        }
+    }
+}
+#endif
+
+} // namespace Oryol
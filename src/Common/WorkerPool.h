@@ -0,0 +1,69 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::WorkerPool
+    @brief minimal fork-join thread pool for data-parallel loops
+
+    Run() calls a function for a range of job indices, the calling
+    thread and up to numThreads-1 worker threads take jobs from a
+    shared counter, Run() returns when all jobs are done. On platforms
+    without threads all jobs run on the calling thread.
+*/
+#include "Core/Types.h"
+#include <functional>
+#if ORYOL_HAS_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#endif
+
+namespace Oryol {
+
+class WorkerPool {
+public:
+    /// max number of threads (including the calling thread)
+    static const int MaxNumThreads = 16;
+    /// a job function, called with job index and thread index
+    typedef std::function<void(int jobIndex, int threadIndex)> JobFunc;
+
+    /// destructor
+    ~WorkerPool();
+    /// start worker threads (numThreads includes the calling thread)
+    void Setup(int numThreads);
+    /// stop worker threads
+    void Discard();
+    /// return true if the pool has been setup
+    bool IsValid() const;
+    /// max number of threads which can participate in Run()
+    int NumThreads() const;
+    /// number of hardware threads (clamped to MaxNumThreads)
+    static int NumHardwareThreads();
+
+    /// run numJobs jobs on up to numThreads threads, blocks until done
+    void Run(int numJobs, int numThreads, const JobFunc& func);
+
+private:
+    #if ORYOL_HAS_THREADS
+    /// worker thread function
+    void workerLoop(int threadIndex);
+    /// take jobs until none are left
+    void runJobs(int threadIndex);
+
+    std::thread threads[MaxNumThreads];
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    uint32_t generation = 0;
+    bool stop = false;
+    int numActiveThreads = 0;
+    int numBusyThreads = 0;
+    std::atomic<int> nextJob;
+    int numJobs = 0;
+    const JobFunc* func = nullptr;
+    #endif
+    bool valid = false;
+    int numThreads = 1;
+};
+
+} // namespace Oryol
@@ -11,9 +11,14 @@
 #include "IMUI/IMUI.h"
 #include "HttpFS/HTTPFileSystem.h"
 #include "Core/Containers/InlineArray.h"
+#include "Core/String/StringBuilder.h"
 #include "Common/CameraHelper.h"
 #include "Common/OrbLoader.h"
+#include "Common/CrowdAnim.h"
+#include "Common/WorkerPool.h"
 #include "glm/gtc/matrix_transform.hpp"
+#include <algorithm>
+#include <stdio.h>
 #include "shaders.h"
 
 using namespace Oryol;
@@ -25,14 +30,20 @@ public:
     AppState::Code OnCleanup();
 
     void loadModel(const Locator& loc);
+    int residentAnimKeyBytes() const;
     void initInstances();
     void updateNumInstances();
+    void updateAnimLod();
+    void cullInstances();
     void drawUI();
+    uint32_t random();
+    bool updateBench();
+    void writeBenchResults();
 
     static const int PrimGroupIndex = 0;
     static const int MaxNumInstances = 1024;
     static const int BoneTextureWidth = 1024;
-    static const int BoneTextureHeight = MaxNumInstances/4 + 1;
+    static const int MaxNumSharedPoses = 256;
 
     GfxSetup gfxSetup;
     CameraHelper camera;
@@ -40,23 +51,62 @@ public:
     OrbModel orbModel;
     DrawState drawState;
     DragonShader::vsParams vsParams;
+    DragonDQShader::vsParams dqVsParams;
+    bool dualQuatSkinning = false;
+    // bone texture height depends on skeleton size and skinning mode
+    int boneTextureHeight = 0;
     int numWantedInstances = 1;
     int numActiveInstances = 0;
-    StaticArray<Id, MaxNumInstances> instances;
+    CrowdAnim crowd;
+    WorkerPool workerPool;
+    int numEvalThreads = 1;
+    double animTime = 0.0;
+    bool animLodEnabled = true;
+    float animLodDistance[CrowdAnim::MaxLod] = { 40.0f, 80.0f };
+    StaticArray<int, MaxNumInstances> evalInstances;
 
-    // xxxx,yyyy,zzzz is transposed model matrix
-    // boneInfo is position in bone texture
-    VertexLayout instanceMeshLayout;
-    struct InstanceVertex {
+    // the per-instance data is split into 2 vertex buffers, the
+    // transforms (xxxx,yyyy,zzzz is transposed model matrix) are only
+    // uploaded when the set or order of visible instances changes,
+    // the bone texture positions are streamed each frame
+    VertexLayout transformMeshLayout;
+    VertexLayout boneInfoMeshLayout;
+    struct TransformVertex {
         float xxxx[4];
         float yyyy[4];
         float zzzz[4];
+    };
+    struct BoneInfoVertex {
         float boneInfo[4];
     };
-    InstanceVertex InstanceData[MaxNumInstances];
+    TransformVertex InstanceData[MaxNumInstances];
+    // visible instances, sorted front to back, in instance buffer order
+    TransformVertex visibleTransforms[MaxNumInstances];
+    BoneInfoVertex visibleBoneInfos[MaxNumInstances];
+    int numVisibleInstances = 0;
+    // visible instance order of the last transform upload
+    StaticArray<int, MaxNumInstances> uploadedInstances;
+    int numUploadedInstances = 0;
+    int updateInstBufBytes = 0;
+    bool cullingEnabled = true;
+    // local-space bounds of one instance, including animation
+    glm::vec3 instanceBoundsMin;
+    glm::vec3 instanceBoundsMax;
+    float instanceDist[MaxNumInstances];
 
     double evalDuration = 0.0;
+    double cullDuration = 0.0;
+    // the 1-thread baseline is only measured on request (UI button),
+    // the evaluation then runs on 1 thread for BaselineNumFrames frames,
+    // costs are in ms per evaluated bone
+    static const int BaselineNumFrames = 16;
+    int baselineFramesLeft = 0;
+    double evalCost = 0.0;
+    double singleThreadEvalCost = 0.0;
     double updateBoneTexDuration = 0.0;
+    int updateBoneTexBytes = 0;
+    int dirtyBoneTexBytes = 0;
+    bool halfFloatBoneTexture = false;
     double updateInstBufDuration = 0.0;
     double drawDuration = 0.0;
     double frameDuration = 0.0;
@@ -64,6 +114,23 @@ public:
     bool uiTextureWindowEnabled = false;
     int uiTexScale = 2;
     ImTextureID imguiBoneTextureId = nullptr;
+    uint32_t rngState = 0x12345678;
+
+    // benchmark mode (started with -bench): sweeps the instance count,
+    // records per-phase timings for a fixed number of frames per step,
+    // and writes mean, p95 and p99 as CSV, culling and anim LOD are off
+    // and the camera doesn't move, so that every step does the full work
+    struct benchPhase {
+        enum Code { Eval, BoneTex, Instance, Render, Frame, Num };
+    };
+    static const int BenchNumSteps = 5;
+    static const int BenchWarmupFrames = 60;
+    static const int BenchNumFrames = 600;
+    bool benchMode = false;
+    int benchStep = 0;
+    int benchFrame = 0;
+    Array<float> benchSamples[benchPhase::Num];
+    StringBuilder benchCsv;
 };
 OryolMain(Dragons);
 
@@ -78,61 +145,87 @@ Dragons::OnInit() {
     this->gfxSetup = GfxSetup::WindowMSAA4(1024, 640, "Dragons");
     this->gfxSetup.DefaultPassAction = PassAction::Clear(glm::vec4(0.2f, 0.3f, 0.5f, 1.0f));
     this->gfxSetup.HtmlTrackElementSize = true;
+    this->benchMode = OryolArgs.HasArg("-bench");
+    if (this->benchMode) {
+        // don't let vsync dominate the frame time
+        this->gfxSetup.SwapInterval = 0;
+        this->cullingEnabled = false;
+        this->animLodEnabled = false;
+    }
     Gfx::Setup(this->gfxSetup);
+    // the Anim module only holds the skeleton and anim library,
+    // the instances are evaluated by CrowdAnim from compressed keys
     AnimSetup animSetup;
-    animSetup.MaxNumInstances = MaxNumInstances;
-    animSetup.MaxNumActiveInstances = MaxNumInstances;
-    animSetup.SkinMatrixTableWidth = BoneTextureWidth;
-    animSetup.SkinMatrixTableHeight = BoneTextureHeight;
+    animSetup.MaxNumInstances = 1;
+    animSetup.MaxNumActiveInstances = 1;
     Anim::Setup(animSetup);
     Input::Setup();
     IMUI::Setup();
+    this->workerPool.Setup(WorkerPool::NumHardwareThreads());
+    this->numEvalThreads = this->workerPool.NumThreads();
 
     this->camera.Setup(false);
     this->camera.Center = glm::vec3(0.0f, 2.0f, -2.5f);
     this->camera.Distance = 20.0f;
     this->camera.Orbital = glm::vec2(glm::radians(45.0f), 0.0f);
 
-    // setup the shader now, pipeline setup happens when model file has loaded
-    this->shader = Gfx::CreateResource(DragonShader::Setup());
-
-    // RGBA32F texture for the animated skeleton bones
-    auto texSetup = TextureSetup::Empty2D(BoneTextureWidth, BoneTextureHeight, 1, PixelFormat::RGBA32F, Usage::Stream);
-    texSetup.Sampler.MinFilter = TextureFilterMode::Nearest;
-    texSetup.Sampler.MagFilter = TextureFilterMode::Nearest;
-    texSetup.Sampler.WrapU = TextureWrapMode::ClampToEdge;
-    texSetup.Sampler.WrapV = TextureWrapMode::ClampToEdge;
-    Id boneTexture = Gfx::CreateResource(texSetup);
-    this->drawState.VSTexture[DragonShader::boneTex] = boneTexture;
+    // setup the shader now, pipeline setup happens when model file has loaded,
+    // with -dualquat, bones are passed as dual quaternions (2 instead of 3
+    // texels per bone), the bone texture is created with the instances
+    this->dualQuatSkinning = OryolArgs.HasArg("-dualquat");
+    if (this->dualQuatSkinning) {
+        this->shader = Gfx::CreateResource(DragonDQShader::Setup());
+    }
+    else {
+        this->shader = Gfx::CreateResource(DragonShader::Setup());
+    }
+    this->halfFloatBoneTexture = Gfx::QueryFeature(GfxFeature::TextureHalfFloat);
     this->imguiBoneTextureId = IMUI::AllocImage();
-    IMUI::BindImage(this->imguiBoneTextureId, boneTexture);
 
-    // vertex buffer for per-instance info
-    auto meshSetup = MeshSetup::Empty(MaxNumInstances, Usage::Stream);
+    // vertex buffers for per-instance info, rarely updated
+    // transforms and per-frame bone texture locations
+    auto meshSetup = MeshSetup::Empty(MaxNumInstances, Usage::Dynamic);
     meshSetup.Layout = {
         { VertexAttr::Instance0, VertexFormat::Float4 }, // transposes model matrix xxxx
         { VertexAttr::Instance1, VertexFormat::Float4 }, // transposes model matrix yyyy
         { VertexAttr::Instance2, VertexFormat::Float4 }, // transposes model matrix zzzz
-        { VertexAttr::Instance3, VertexFormat::Float4 }  // bone texture location
     };
     meshSetup.Layout.EnableInstancing();
-    this->instanceMeshLayout = meshSetup.Layout;
+    this->transformMeshLayout = meshSetup.Layout;
     this->drawState.Mesh[1] = Gfx::CreateResource(meshSetup);
+    meshSetup = MeshSetup::Empty(MaxNumInstances, Usage::Stream);
+    meshSetup.Layout = {
+        { VertexAttr::Instance3, VertexFormat::Float4 }  // bone texture location
+    };
+    meshSetup.Layout.EnableInstancing();
+    this->boneInfoMeshLayout = meshSetup.Layout;
+    this->drawState.Mesh[2] = Gfx::CreateResource(meshSetup);
 
     // load the dragon.orb file and add the first model instance,
     // the .txt extension is a hack so that github pages compresses the file
     this->loadModel("orb:dragon.orb.txt");
 
+    if (this->benchMode) {
+        this->benchCsv.Append("instances,visible,bone_evals,phase,mean_ms,p95_ms,p99_ms\n");
+        for (auto& samples : this->benchSamples) {
+            samples.Reserve(BenchNumFrames);
+        }
+        this->numWantedInstances = 1;
+        Log::Info("Dragons: running benchmark\n");
+    }
+
     return App::OnInit();
 }
 
 //------------------------------------------------------------------------------
 AppState::Code
 Dragons::OnRunning() {
-    if (!ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow)) {
+    if (!this->benchMode && !ImGui::IsWindowHovered(ImGuiHoveredFlags_AnyWindow)) {
         this->camera.HandleInput();
     }
-    this->camera.Center.z = -(this->numActiveInstances / 16) * 2.0f;
+    if (!this->benchMode) {
+        this->camera.Center.z = -(this->numActiveInstances / 16) * 2.0f;
+    }
     this->camera.UpdateTransforms();
     if (this->orbModel.IsValid) {
         // add or remove instances
@@ -140,38 +233,81 @@ Dragons::OnRunning() {
             this->updateNumInstances();
         }
 
-        // update the animation system
-        Anim::NewFrame();
-        for (int i = 0; i < this->numActiveInstances; i++) {
-            Anim::AddActiveInstance(this->instances[i]);
+        // frustum culling, only visible instances are animated and rendered
+        TimePoint cullStart = Clock::Now();
+        this->cullInstances();
+        this->cullDuration = Clock::Since(cullStart).AsMilliSeconds();
+
+        // evaluate the animated instances
+        this->animTime += 1.0/60.0;
+        this->updateAnimLod();
+        const bool baseline = this->baselineFramesLeft > 0;
+        if (baseline) {
+            this->baselineFramesLeft--;
         }
+        const int numThreads = baseline ? 1 : this->numEvalThreads;
         TimePoint evalStart = Clock::Now();
-        Anim::Evaluate(1.0/60.0);
+        this->crowd.Evaluate(&this->evalInstances[0], this->numVisibleInstances, this->animTime,
+            &this->workerPool, numThreads);
         this->evalDuration = Clock::Since(evalStart).AsMilliSeconds();
+        if (this->crowd.NumBoneEvals > 0) {
+            // per evaluated bone, so the costs stay comparable when
+            // visibility or animation LOD change the amount of work
+            const double cost = this->evalDuration / this->crowd.NumBoneEvals;
+            if (1 == numThreads) {
+                double& avg = this->singleThreadEvalCost;
+                avg = (avg > 0.0) ? avg + (cost - avg) * 0.25 : cost;
+            }
+            if (numThreads == this->numEvalThreads) {
+                double& avg = this->evalCost;
+                avg = (avg > 0.0) ? avg + (cost - avg) * 0.05 : cost;
+            }
+        }
 
-        // upload animated skeleton bone info to GPU texture
+        // upload animated skeleton bone info to GPU texture, skipped if no
+        // instance was evaluated (Gfx::UpdateTexture only updates complete
+        // mipmaps, so the dirty row range can't be uploaded on its own)
         TimePoint updTexStart = Clock::Now();
-        const AnimSkinMatrixInfo& boneInfo = Anim::SkinMatrixInfo();
-        ImageDataAttrs imgAttrs;
-        imgAttrs.NumFaces = 1;
-        imgAttrs.NumMipMaps = 1;
-        imgAttrs.Offsets[0][0] = 0;
-        imgAttrs.Sizes[0][0] = boneInfo.SkinMatrixTableByteSize;
-        Gfx::UpdateTexture(this->drawState.VSTexture[DragonShader::boneTex], boneInfo.SkinMatrixTable, imgAttrs);
+        this->dirtyBoneTexBytes = this->crowd.DirtyByteSize();
+        this->updateBoneTexBytes = 0;
+        if (this->dirtyBoneTexBytes > 0) {
+            ImageDataAttrs imgAttrs;
+            imgAttrs.NumFaces = 1;
+            imgAttrs.NumMipMaps = 1;
+            imgAttrs.Offsets[0][0] = 0;
+            imgAttrs.Sizes[0][0] = this->crowd.SkinMatrixTableByteSize();
+            Gfx::UpdateTexture(this->drawState.VSTexture[DragonShader::boneTex], this->crowd.SkinMatrixTable(), imgAttrs);
+            this->updateBoneTexBytes = imgAttrs.Sizes[0][0];
+        }
         this->updateBoneTexDuration = Clock::Since(updTexStart).AsMilliSeconds();
 
-        // update the instance vertex buffer with bone texture locations
+        // update the instance vertex buffers, the transforms only if the
+        // visible instances have changed
         TimePoint updInstStart = Clock::Now();
-        int instIndex;
-        for (instIndex = 0; instIndex < this->numActiveInstances; instIndex++) {
-            const auto& shdInfo = boneInfo.InstanceInfos[instIndex].ShaderInfo;
-            auto& vtx = this->InstanceData[instIndex];
-            for (int i = 0; i < 4; i++) {
-                vtx.boneInfo[i] = shdInfo[i];
+        this->updateInstBufBytes = 0;
+        bool transformsChanged = this->numVisibleInstances != this->numUploadedInstances;
+        for (int i = 0; i < this->numVisibleInstances; i++) {
+            const int instIndex = this->evalInstances[i];
+            if (transformsChanged || (this->uploadedInstances[i] != instIndex)) {
+                transformsChanged = true;
+                this->uploadedInstances[i] = instIndex;
+                this->visibleTransforms[i] = this->InstanceData[instIndex];
+            }
+            const auto& shdInfo = this->crowd.ShaderInfo(instIndex);
+            for (int j = 0; j < 4; j++) {
+                this->visibleBoneInfos[i].boneInfo[j] = shdInfo[j];
             }
         }
-        if (instIndex > 0) {
-            Gfx::UpdateVertices(this->drawState.Mesh[1], this->InstanceData, sizeof(InstanceVertex)*instIndex);
+        this->numUploadedInstances = this->numVisibleInstances;
+        if (this->numVisibleInstances > 0) {
+            if (transformsChanged) {
+                const int numBytes = sizeof(TransformVertex) * this->numVisibleInstances;
+                Gfx::UpdateVertices(this->drawState.Mesh[1], this->visibleTransforms, numBytes);
+                this->updateInstBufBytes += numBytes;
+            }
+            const int numBytes = sizeof(BoneInfoVertex) * this->numVisibleInstances;
+            Gfx::UpdateVertices(this->drawState.Mesh[2], this->visibleBoneInfos, numBytes);
+            this->updateInstBufBytes += numBytes;
         }
         this->updateInstBufDuration = Clock::Since(updInstStart).AsMilliSeconds();
     }
@@ -179,19 +315,32 @@ Dragons::OnRunning() {
     // all dragons rendered in a single draw call via hardware instancing
     TimePoint drawStart = Clock::Now();
     Gfx::BeginPass();
-    IMUI::NewFrame();
-    this->drawUI();
+    if (!this->benchMode) {
+        IMUI::NewFrame();
+        this->drawUI();
+    }
     if (this->orbModel.IsValid) {
         Gfx::ApplyDrawState(this->drawState);
-        this->vsParams.view_proj = this->camera.ViewProj;
-        Gfx::ApplyUniformBlock(this->vsParams);
-        Gfx::Draw(PrimGroupIndex, this->numActiveInstances);
+        if (this->dualQuatSkinning) {
+            this->dqVsParams.view_proj = this->camera.ViewProj;
+            Gfx::ApplyUniformBlock(this->dqVsParams);
+        }
+        else {
+            this->vsParams.view_proj = this->camera.ViewProj;
+            Gfx::ApplyUniformBlock(this->vsParams);
+        }
+        Gfx::Draw(PrimGroupIndex, this->numVisibleInstances);
+    }
+    if (!this->benchMode) {
+        ImGui::Render();
     }
-    ImGui::Render();
     Gfx::EndPass();
     Gfx::CommitFrame();
     this->drawDuration = Clock::Since(drawStart).AsMilliSeconds();
     this->frameDuration = Clock::LapTime(this->frameLapTime).AsMilliSeconds();
+    if (this->benchMode && this->orbModel.IsValid && !this->updateBench()) {
+        return AppState::Cleanup;
+    }
 
     return Gfx::QuitRequested() ? AppState::Cleanup : AppState::Running;
 }
@@ -199,6 +348,10 @@ Dragons::OnRunning() {
 //------------------------------------------------------------------------------
 AppState::Code
 Dragons::OnCleanup() {
+    if (this->crowd.IsValid()) {
+        this->crowd.Discard();
+    }
+    this->workerPool.Discard();
     IMUI::Discard();
     Input::Discard();
     Anim::Discard();
@@ -207,18 +360,37 @@ Dragons::OnCleanup() {
     return App::OnCleanup();
 }
 
+//------------------------------------------------------------------------------
+int
+Dragons::residentAnimKeyBytes() const {
+    // compressed keys, plus uncompressed keys if an anim library exists
+    int bytes = this->orbModel.CompressedAnim.ByteSize();
+    if (this->orbModel.AnimLib.IsValid()) {
+        for (const AnimClip& clip : Anim::Library(this->orbModel.AnimLib).Clips) {
+            bytes += clip.Keys.Size() * sizeof(clip.Keys[0]);
+        }
+    }
+    return bytes;
+}
+
 //------------------------------------------------------------------------------
 void
 Dragons::loadModel(const Locator& loc) {
     // start loading the .orb file
     IO::Load(loc.Location(), [this](IO::LoadResult res) {
-        if (OrbLoader::Load(res.Data, "model", this->orbModel)) {
+        // with many instances on screen, vertex processing efficiency matters
+        OrbLoader::Options options;
+        options.OptimizeMesh = true;
+        options.CompressAnim = true;
+        if (OrbLoader::Load(res.Data, "model", this->orbModel, options)) {
             this->drawState.Mesh[0] = this->orbModel.Mesh;
             this->vsParams.vtx_mag = this->orbModel.VertexMagnitude;
+            this->dqVsParams.vtx_mag = this->orbModel.VertexMagnitude;
 
             auto pipSetup = PipelineSetup::FromShader(this->shader);
             pipSetup.Layouts[0] = this->orbModel.MeshSetup.Layout;
-            pipSetup.Layouts[1] = this->instanceMeshLayout;
+            pipSetup.Layouts[1] = this->transformMeshLayout;
+            pipSetup.Layouts[2] = this->boneInfoMeshLayout;
             pipSetup.DepthStencilState.DepthWriteEnabled = true;
             pipSetup.DepthStencilState.DepthCmpFunc = CompareFunc::LessEqual;
             pipSetup.RasterizerState.CullFaceEnabled = true;
@@ -239,9 +411,8 @@ Dragons::loadModel(const Locator& loc) {
 //------------------------------------------------------------------------------
 void
 Dragons::initInstances() {
-    // this pre-creates the max number of instances (these are not
-    // evaluated or rendered until they are added per-frame
-    // as active instances to the animation system
+    // this prepares the max number of instances (these are not
+    // evaluated or rendered until they are active)
     o_assert_dbg(this->orbModel.IsValid);
 
     // setup the instance positions in the instance data vertex buffer,
@@ -262,11 +433,49 @@ Dragons::initInstances() {
             y++;
         }
     }
-    // pre-allocate instances
-    auto instSetup = AnimInstanceSetup::FromLibraryAndSkeleton(this->orbModel.AnimLib, this->orbModel.Skeleton);
-    for (int instIndex = 0; instIndex < MaxNumInstances; instIndex++) {
-        this->instances[instIndex] = Anim::Create(instSetup);
+    // RGBA16F texture for the animated skeleton bones, or RGBA32F
+    // if half-float textures are not supported, large enough for
+    // all instances and shared poses
+    const int numBones = Anim::Skeleton(this->orbModel.Skeleton).NumBones;
+    const int texelsPerBone = this->dualQuatSkinning ? 2 : 3;
+    this->boneTextureHeight = CrowdAnim::NumTableRows(numBones, texelsPerBone,
+        MaxNumInstances + MaxNumSharedPoses, BoneTextureWidth);
+    const PixelFormat::Code boneTexFormat = this->halfFloatBoneTexture ? PixelFormat::RGBA16F : PixelFormat::RGBA32F;
+    auto texSetup = TextureSetup::Empty2D(BoneTextureWidth, this->boneTextureHeight, 1, boneTexFormat, Usage::Stream);
+    texSetup.Sampler.MinFilter = TextureFilterMode::Nearest;
+    texSetup.Sampler.MagFilter = TextureFilterMode::Nearest;
+    texSetup.Sampler.WrapU = TextureWrapMode::ClampToEdge;
+    texSetup.Sampler.WrapV = TextureWrapMode::ClampToEdge;
+    static_assert(int(DragonShader::boneTex) == int(DragonDQShader::boneTex), "bone texture slots must match");
+    Id boneTexture = Gfx::CreateResource(texSetup);
+    this->drawState.VSTexture[DragonShader::boneTex] = boneTexture;
+    IMUI::BindImage(this->imguiBoneTextureId, boneTexture);
+
+    // setup the instance evaluation, each instance has a fixed
+    // location in the bone texture
+    this->crowd.Setup(this->orbModel.Skeleton, &this->orbModel.CompressedAnim,
+        MaxNumInstances, BoneTextureWidth, this->boneTextureHeight,
+        this->halfFloatBoneTexture, this->dualQuatSkinning);
+    // instances at the same clip position (quantized to 1/30 sec) can share one pose
+    this->crowd.SetupPoseSharing(MaxNumSharedPoses, 1.0/30.0);
+
+    // local bounds for culling, either from the cooked model bounds, or
+    // from the bind pose joint positions, with some room for animation
+    if (this->orbModel.HasBounds) {
+        this->instanceBoundsMin = this->orbModel.Bounds.Min;
+        this->instanceBoundsMax = this->orbModel.Bounds.Max;
+    }
+    else {
+        const AnimSkeleton& skel = Anim::Skeleton(this->orbModel.Skeleton);
+        for (int i = 0; i < skel.NumBones; i++) {
+            const glm::vec3 p(skel.BindPose[i][3]);
+            this->instanceBoundsMin = (0 == i) ? p : glm::min(this->instanceBoundsMin, p);
+            this->instanceBoundsMax = (0 == i) ? p : glm::max(this->instanceBoundsMax, p);
+        }
     }
+    const glm::vec3 pad = (this->instanceBoundsMax - this->instanceBoundsMin) * 0.25f;
+    this->instanceBoundsMin -= pad;
+    this->instanceBoundsMax += pad;
 }
 
 //------------------------------------------------------------------------------
@@ -277,19 +486,136 @@ Dragons::updateNumInstances() {
         this->numActiveInstances = this->numWantedInstances;
     }
     else if (this->numWantedInstances > this->numActiveInstances) {
-        const int numClips = 7;
+        const int numClips = 6;
         const int clips[numClips] = { 0, 1, 2, 3, 4, 5 };
-        AnimJob job;
-        job.TrackIndex = 0;
         for (int i = this->numActiveInstances; i < this->numWantedInstances; i++) {
-            int r = rand();
-            job.ClipIndex = clips[r % numClips];
-            Anim::Play(this->instances[i], job);
+            int r = int(this->random() >> 16);
+            this->crowd.Play(i, clips[r % numClips], this->animTime);
         }
         this->numActiveInstances = this->numWantedInstances;
     }
 }
 
+//------------------------------------------------------------------------------
+void
+Dragons::cullInstances() {
+    // gather visible instances into evalInstances, and sort them
+    // front to back for early-Z
+    const glm::vec3& eyePos = this->camera.EyePos;
+    this->numVisibleInstances = 0;
+    for (int instIndex = 0; instIndex < this->numActiveInstances; instIndex++) {
+        const TransformVertex& vtx = this->InstanceData[instIndex];
+        const glm::vec3 pos(vtx.xxxx[3], vtx.yyyy[3], vtx.zzzz[3]);
+        if (!this->cullingEnabled || this->camera.BoxVisible(pos + this->instanceBoundsMin, pos + this->instanceBoundsMax)) {
+            this->instanceDist[instIndex] = glm::length(pos - eyePos);
+            this->evalInstances[this->numVisibleInstances++] = instIndex;
+        }
+    }
+    const float* dist = this->instanceDist;
+    std::sort(&this->evalInstances[0], &this->evalInstances[0] + this->numVisibleInstances, [dist](int a, int b) {
+        return dist[a] < dist[b];
+    });
+}
+
+//------------------------------------------------------------------------------
+void
+Dragons::updateAnimLod() {
+    // select animation LOD of visible instances by distance to the camera
+    for (int i = 0; i < this->numVisibleInstances; i++) {
+        const int instIndex = this->evalInstances[i];
+        int lod = 0;
+        if (this->animLodEnabled) {
+            const float dist = this->instanceDist[instIndex];
+            while ((lod < CrowdAnim::MaxLod) && (dist > this->animLodDistance[lod])) {
+                lod++;
+            }
+        }
+        this->crowd.SetLod(instIndex, lod);
+    }
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+Dragons::random() {
+    // LCG with a fixed seed, so that benchmark runs are reproducible
+    this->rngState = this->rngState * 1664525 + 1013904223;
+    return this->rngState;
+}
+
+//------------------------------------------------------------------------------
+static float
+percentile(const Array<float>& sorted, float p) {
+    int index = int(p * sorted.Size());
+    if (index >= sorted.Size()) {
+        index = sorted.Size() - 1;
+    }
+    return sorted[index];
+}
+
+//------------------------------------------------------------------------------
+bool
+Dragons::updateBench() {
+    static const int benchInstanceCounts[BenchNumSteps] = { 1, 16, 64, 256, 1024 };
+    static const char* phaseNames[benchPhase::Num] = { "anim_eval", "bone_tex_update", "instance_update", "render", "frame" };
+    if (this->numActiveInstances != benchInstanceCounts[this->benchStep]) {
+        // model has just finished loading
+        return true;
+    }
+
+    // skip warmup frames after each instance count change
+    if (this->benchFrame++ < BenchWarmupFrames) {
+        return true;
+    }
+    this->benchSamples[benchPhase::Eval].Add(float(this->evalDuration));
+    this->benchSamples[benchPhase::BoneTex].Add(float(this->updateBoneTexDuration));
+    this->benchSamples[benchPhase::Instance].Add(float(this->updateInstBufDuration));
+    this->benchSamples[benchPhase::Render].Add(float(this->drawDuration));
+    this->benchSamples[benchPhase::Frame].Add(float(this->frameDuration));
+    if (this->benchFrame < (BenchWarmupFrames + BenchNumFrames)) {
+        return true;
+    }
+
+    // step complete, add a CSV row per phase
+    for (int phase = 0; phase < benchPhase::Num; phase++) {
+        Array<float>& samples = this->benchSamples[phase];
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (float s : samples) {
+            sum += s;
+        }
+        this->benchCsv.AppendFormat(128, "%d,%d,%d,%s,%.4f,%.4f,%.4f\n",
+            this->numActiveInstances, this->numVisibleInstances, this->crowd.NumBoneEvals,
+            phaseNames[phase], sum / samples.Size(),
+            percentile(samples, 0.95f), percentile(samples, 0.99f));
+        samples.Clear();
+    }
+    this->benchFrame = 0;
+    if (++this->benchStep < BenchNumSteps) {
+        this->numWantedInstances = benchInstanceCounts[this->benchStep];
+        return true;
+    }
+    this->writeBenchResults();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+Dragons::writeBenchResults() {
+    Log::Info("%s", this->benchCsv.AsCStr());
+    #if !ORYOL_EMSCRIPTEN
+    const char* path = "dragons-bench.csv";
+    FILE* fp = fopen(path, "w");
+    if (fp) {
+        fwrite(this->benchCsv.AsCStr(), 1, this->benchCsv.Length(), fp);
+        fclose(fp);
+        Log::Info("Dragons: benchmark results written to '%s'\n", path);
+    }
+    else {
+        Log::Error("Dragons: failed to write '%s'\n", path);
+    }
+    #endif
+}
+
 //------------------------------------------------------------------------------
 void
 Dragons::drawUI() {
@@ -299,11 +625,53 @@ Dragons::drawUI() {
             const int numBonesPerInst = Anim::Skeleton(this->orbModel.Skeleton).NumBones;
             const int numTrisPerInst = this->orbModel.MeshSetup.PrimitiveGroup(PrimGroupIndex).NumElements / 3;
             ImGui::SliderInt("num instances", &this->numWantedInstances, 1, MaxNumInstances);
-            ImGui::Text("num bones:     %d\n",  numBonesPerInst * this->numActiveInstances);
-            ImGui::Text("num triangles: %d\n", numTrisPerInst * this->numActiveInstances);
+            ImGui::Checkbox("frustum culling", &this->cullingEnabled);
+            ImGui::Text("visible:       %d / %d\n", this->numVisibleInstances, this->numActiveInstances);
+            ImGui::Text("num bones:     %d\n",  numBonesPerInst * this->numVisibleInstances);
+            ImGui::Text("num triangles: %d\n", numTrisPerInst * this->numVisibleInstances);
+            if (this->numVisibleInstances > 0) {
+                // estimated from the per-instance eval cost of the visible instances
+                const int numCulled = this->numActiveInstances - this->numVisibleInstances;
+                const double saved = (this->evalDuration / this->numVisibleInstances) * numCulled;
+                ImGui::Text("cull:         %.3f ms (saved %.3f ms)", this->cullDuration, saved);
+            }
+            ImGui::Text("anim keys:    %d KB resident (%d KB uncompressed)",
+                this->residentAnimKeyBytes() / 1024,
+                this->orbModel.CompressedAnim.UncompressedByteSize / 1024);
+            ImGui::SliderInt("eval threads", &this->numEvalThreads, 1, this->workerPool.NumThreads());
             ImGui::Text("anim system:  %.3f ms", this->evalDuration);
-            ImGui::Text("texture upd:  %.3f ms", this->updateBoneTexDuration);
-            ImGui::Text("instance upd: %.3f ms", this->updateInstBufDuration);
+            if (this->baselineFramesLeft > 0) {
+                ImGui::Text("speedup:      measuring...");
+            }
+            else if ((this->singleThreadEvalCost > 0.0) && (this->evalCost > 0.0)) {
+                ImGui::Text("speedup:      %.2fx (%d threads vs 1)", this->singleThreadEvalCost / this->evalCost, this->numEvalThreads);
+            }
+            if (ImGui::Button("Measure Speedup")) {
+                this->singleThreadEvalCost = 0.0;
+                this->baselineFramesLeft = BaselineNumFrames;
+            }
+            ImGui::Checkbox("anim LOD", &this->animLodEnabled);
+            if (this->animLodEnabled) {
+                ImGui::SliderFloat("1/2 rate dist", &this->animLodDistance[0], 5.0f, 200.0f);
+                ImGui::SliderFloat("1/4 rate dist", &this->animLodDistance[1], 5.0f, 200.0f);
+                ImGui::Checkbox("skip leaf bones", &this->crowd.SkipLeafBones);
+            }
+            ImGui::Checkbox("share poses", &this->crowd.SharePoses);
+            if (this->crowd.SharePoses) {
+                ImGui::Text("shared poses: %d", this->crowd.NumSharedPoses);
+            }
+            ImGui::Text("bone evals:   %d / %d", this->crowd.NumBoneEvals, this->crowd.NumFullBoneEvals);
+            if (this->crowd.NumBoneEvals > 0) {
+                // estimate the full cost from the cost per evaluated bone
+                const double fullDuration = this->evalDuration * this->crowd.NumFullBoneEvals / this->crowd.NumBoneEvals;
+                ImGui::Text("LOD saving:   %.3f ms", fullDuration - this->evalDuration);
+            }
+            ImGui::Text("texture upd:  %.3f ms (%d KB, %d KB dirty, %s)", this->updateBoneTexDuration,
+                this->updateBoneTexBytes / 1024, this->dirtyBoneTexBytes / 1024,
+                this->halfFloatBoneTexture ? "RGBA16F" : "RGBA32F");
+            ImGui::Text("skinning:     %s, %dx%d texels", this->dualQuatSkinning ? "dual quat" : "matrix",
+                BoneTextureWidth, this->boneTextureHeight);
+            ImGui::Text("instance upd: %.3f ms (%d KB)", this->updateInstBufDuration, this->updateInstBufBytes / 1024);
             ImGui::Text("render:       %.3f ms", this->drawDuration);
             ImGui::Text("frame time:   %.3f ms", this->frameDuration);
             if (ImGui::Button("Bone Texture")) {
@@ -324,7 +692,7 @@ Dragons::drawUI() {
                 if (ImGui::Button("4x")) this->uiTexScale = 3;
                 ImGui::BeginChild("##frame", ImVec2(0,0), true, ImGuiWindowFlags_HorizontalScrollbar);
                 ImGui::Image(this->imguiBoneTextureId,
-                    ImVec2(float(BoneTextureWidth*this->uiTexScale), float(BoneTextureHeight*this->uiTexScale)),
+                    ImVec2(float(BoneTextureWidth*this->uiTexScale), float(this->boneTextureHeight*this->uiTexScale)),
                     ImVec2(0, 0), ImVec2(1.0f, 1.0f));
                 ImGui::End();
             }
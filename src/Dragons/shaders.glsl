@@ -1,4 +1,7 @@
 @block SkinUtil
+// the bone texture holds 3 transposed matrix rows per bone, either as
+// RGBA32F or RGBA16F, both formats are sampled as float so the decoding
+// is identical
 void skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, in vec4 skin_info, out vec4 skin_pos) {
     vec4 weights = skin_weights / dot(skin_weights, vec4(1.0));
     vec2 step = vec2(1.0 / skin_info.z, 0.0);
@@ -39,6 +42,51 @@ void skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, in vec
 }
 @end
 
+@block SkinUtilDQ
+// dual quaternion skinning, the bone texture holds 2 texels per bone,
+// the rotation quaternion and the dual part
+void dq_fetch(in float bone_index, in vec4 skin_info, out vec4 real, out vec4 dual) {
+    vec2 uv = vec2(skin_info.x + (2.0*bone_index)/skin_info.z, skin_info.y);
+    real = textureLod(boneTex, uv, 0.0);
+    dual = textureLod(boneTex, uv + vec2(1.0 / skin_info.z, 0.0), 0.0);
+}
+
+void dq_skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, in vec4 skin_info, out vec4 skin_pos) {
+    vec4 weights = skin_weights / dot(skin_weights, vec4(1.0));
+    vec4 r0, d0, r, d;
+    dq_fetch(skin_indices.x, skin_info, r0, d0);
+    vec4 b_real = r0 * weights.x;
+    vec4 b_dual = d0 * weights.x;
+    // blend along the shortest path relative to the first bone
+    if (weights.y > 0.0) {
+        dq_fetch(skin_indices.y, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.y : weights.y;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    if (weights.z > 0.0) {
+        dq_fetch(skin_indices.z, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.z : weights.z;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    if (weights.w > 0.0) {
+        dq_fetch(skin_indices.w, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.w : weights.w;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    float len = length(b_real);
+    b_real /= len;
+    b_dual /= len;
+    // rotate, then add translation 2 * dual * conjugate(real)
+    vec3 p = pos.xyz;
+    p += 2.0 * cross(b_real.xyz, cross(b_real.xyz, p) + b_real.w * p);
+    p += 2.0 * (b_real.w * b_dual.xyz - b_dual.w * b_real.xyz + cross(b_real.xyz, b_dual.xyz));
+    skin_pos = vec4(p, 1.0);
+}
+@end
+
 //------------------------------------------------------------------------------
 @vs vs
 uniform vsParams {
@@ -71,6 +119,37 @@ void main() {
 }
 @end
 
+@vs vsDQ
+uniform vsParams {
+    mat4 view_proj;
+    vec4 vtx_mag;
+};
+uniform sampler2D boneTex;
+
+@include SkinUtilDQ
+
+in vec4 position;
+in vec3 normal;
+in vec4 weights;
+in vec4 indices;
+in vec4 instance0;  // per-instance data, transposed model matrix, xxxx
+in vec4 instance1;  // yyyy
+in vec4 instance2;  // zzzz
+in vec4 instance3;  // bone-texture lookup info
+out vec3 N;
+void main() {
+    vec4 xxxx = instance0;
+    vec4 yyyy = instance1;
+    vec4 zzzz = instance2;
+    vec4 skin_info = instance3;
+    vec4 p0;
+    dq_skinned_pos(position * vtx_mag, weights, indices * 255.0, skin_info, p0);
+    vec4 p1 = vec4(dot(p0, xxxx), dot(p0, yyyy), dot(p0, zzzz), 1.0);
+    gl_Position = view_proj * p1;
+    N = vec3(dot(normal, xxxx.xyz), dot(normal, yyyy.xyz), dot(normal, zzzz.xyz));
+}
+@end
+
 @fs fs
 in vec3 N;
 out vec4 fragColor;
@@ -82,6 +161,4 @@ void main() {
 @end
 
 @program DragonShader vs fs
-
-
-
+@program DragonDQShader vsDQ fs
@@ -0,0 +1,94 @@
+//------------------------------------------------------------------------------
+//  AudioRing.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "AudioRing.h"
+#include "Core/Assertion.h"
+#include "Core/Memory/Memory.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+AudioRing::~AudioRing() {
+    if (this->samples) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AudioRing::Setup(int cap) {
+    o_assert_dbg(!this->samples);
+    o_assert_dbg((cap > 0) && (0 == (cap & (cap - 1))));
+    this->capacity = cap;
+    this->samples = (float*) Memory::Alloc(cap * sizeof(float));
+    this->readPos = 0;
+    this->writePos = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+AudioRing::Discard() {
+    o_assert_dbg(this->samples);
+    Memory::Free(this->samples);
+    this->samples = nullptr;
+    this->capacity = 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+AudioRing::IsValid() const {
+    return nullptr != this->samples;
+}
+
+//------------------------------------------------------------------------------
+int
+AudioRing::Write(const float* src, int num) {
+    o_assert_dbg(this->samples);
+    const uint32_t wr = this->writePos.load(std::memory_order_relaxed);
+    const uint32_t rd = this->readPos.load(std::memory_order_acquire);
+    const int free = this->capacity - int(wr - rd);
+    if (num > free) {
+        num = free;
+    }
+    const uint32_t mask = this->capacity - 1;
+    for (int i = 0; i < num; i++) {
+        this->samples[(wr + i) & mask] = src[i];
+    }
+    this->writePos.store(wr + num, std::memory_order_release);
+    return num;
+}
+
+//------------------------------------------------------------------------------
+int
+AudioRing::Read(float* dst, int num) {
+    o_assert_dbg(this->samples);
+    const uint32_t rd = this->readPos.load(std::memory_order_relaxed);
+    const uint32_t wr = this->writePos.load(std::memory_order_acquire);
+    const int filled = int(wr - rd);
+    if (num > filled) {
+        num = filled;
+    }
+    const uint32_t mask = this->capacity - 1;
+    for (int i = 0; i < num; i++) {
+        dst[i] = this->samples[(rd + i) & mask];
+    }
+    this->readPos.store(rd + num, std::memory_order_release);
+    return num;
+}
+
+//------------------------------------------------------------------------------
+int
+AudioRing::NumFilled() const {
+    const uint32_t wr = this->writePos.load(std::memory_order_acquire);
+    const uint32_t rd = this->readPos.load(std::memory_order_acquire);
+    return int(wr - rd);
+}
+
+//------------------------------------------------------------------------------
+int
+AudioRing::Capacity() const {
+    return this->capacity;
+}
+
+} // namespace Oryol
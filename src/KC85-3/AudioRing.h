@@ -0,0 +1,45 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::AudioRing
+    @brief lock-free single-producer/single-consumer ring of audio samples
+
+    The emulator thread writes samples, the audio thread reads them.
+    Read and write positions are free-running counters, the number of
+    samples in the ring is their difference, so a completely full ring
+    can be told apart from an empty one. The capacity must be a power
+    of two.
+*/
+#include "Core/Types.h"
+#include <atomic>
+
+namespace Oryol {
+
+class AudioRing {
+public:
+    /// destructor
+    ~AudioRing();
+    /// allocate the ring with capacity in samples (must be a power of 2)
+    void Setup(int capacity);
+    /// free the ring
+    void Discard();
+    /// return true if the ring has been setup
+    bool IsValid() const;
+
+    /// write samples (producer only), returns number of samples written
+    int Write(const float* samples, int num);
+    /// read samples (consumer only), returns number of samples read
+    int Read(float* samples, int num);
+    /// number of samples currently in the ring
+    int NumFilled() const;
+    /// capacity in samples
+    int Capacity() const;
+
+private:
+    float* samples = nullptr;
+    int capacity = 0;
+    std::atomic<uint32_t> readPos{0};
+    std::atomic<uint32_t> writePos{0};
+};
+
+} // namespace Oryol
@@ -6,21 +6,51 @@
 #include "Emu.h"
 #define SOKOL_IMPL
 #include "sokol_audio.h"
+#include "Core/Assertion.h"
 #include "Input/Input.h"
 #include "IO/IO.h"
 #include "Assets/Gfx/ShapeBuilder.h"
 #include "shaders.h"
 #include "emu/kc85-roms.h"
 #include <cctype>
+#include <string.h>
 
 namespace Oryol {
 
 //------------------------------------------------------------------------------
-//  audio-streaming callback to forward audio samples from the emulator
-//  to sokol-audio
+//  audio callback which forwards audio samples from the emulator
+//  into the audio ring, called on the emulator thread
 //
 static void push_audio(const float* samples, int num_samples, void* user_data) {
-    saudio_push(samples, num_samples);
+    Emu* self = (Emu*) user_data;
+    const int num_written = self->audioRing.Write(samples, num_samples);
+    if (num_written < num_samples) {
+        self->numOverruns += num_samples - num_written;
+    }
+}
+
+//------------------------------------------------------------------------------
+//  sokol-audio streaming callback, called on the audio thread, the
+//  callback has no user data, so the Emu instance is kept in a global
+//
+static Emu* stream_emu = nullptr;
+static void stream_audio(float* buffer, int num_frames, int num_channels) {
+    o_assert_dbg(1 == num_channels);
+    stream_emu->pullAudio(buffer, num_frames * num_channels);
+}
+
+//------------------------------------------------------------------------------
+//  hash the pixel and color bytes of the KC85/3 video RAM (IRM, RAM
+//  bank 4), without the CAOS system cells which are also in the IRM
+//
+static uint64_t display_hash(const kc85_t* sys) {
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t* ptr = sys->ram[4];
+    for (int i = 0; i < 0x3200; i++) {
+        hash = (hash ^ ptr[i]) * 0x100000001b3ULL;
+    }
+    return hash;
 }
 
 //------------------------------------------------------------------------------
@@ -48,12 +78,21 @@ static void patch_snapshots(const char* snapshot_name, void* user_data) {
 //------------------------------------------------------------------------------
 void Emu::Setup(const GfxSetup& gfxSetup) {
 
-    // setup the KC85 emulator
-    this->TogglePower();
+    // setup the audio ring, frame buffers and rewind buffer
+    this->audioRing.Setup(AudioRingSize);
+    this->frames.Setup(sizeof(this->pixelBuffer));
+    this->rewind.Setup(RewindBudget, RewindInterval, RewindKeyframeInterval);
 
-    // setup sokol-audio
+    // setup sokol-audio, the audio thread pulls samples from the audio ring
+    stream_emu = this;
     saudio_desc audio_desc = { };
+    audio_desc.num_channels = 1;
+    audio_desc.buffer_frames = AudioBufferFrames;
+    audio_desc.stream_cb = stream_audio;
     saudio_setup(&audio_desc);
+    this->audioValid = saudio_isvalid();
+    this->audioSampleRate = saudio_sample_rate();
+    this->audioTarget = AudioBufferFrames + AudioMarginFrames;
 
     // create a mesh, pipeline and texture for rendering the emulator framebuffer
     ShapeBuilder shapeBuilder;
@@ -92,8 +131,14 @@ void Emu::Setup(const GfxSetup& gfxSetup) {
                 else if (std::isupper(c)) {
                     c = std::tolower(c);
                 }
-                kc85_key_down(&this->kc85, c);
-                kc85_key_up(&this->kc85, c);
+                command down;
+                down.type = command::KeyDown;
+                down.key = c;
+                this->pushCommand(std::move(down));
+                command up;
+                up.type = command::KeyUp;
+                up.key = c;
+                this->pushCommand(std::move(up));
             }
         }
         else if ((e.Type == InputEvent::KeyUp) || (e.Type == InputEvent::KeyDown)) {
@@ -125,69 +170,130 @@ void Emu::Setup(const GfxSetup& gfxSetup) {
                 default:                c = 0; break;
             }
             if (c) {
-                if (e.Type == InputEvent::KeyDown) {
-                    kc85_key_down(&this->kc85, c);
-                }
-                else {
-                    kc85_key_up(&this->kc85, c);
-                }
+                command cmd;
+                cmd.type = (e.Type == InputEvent::KeyDown) ? command::KeyDown : command::KeyUp;
+                cmd.key = c;
+                this->pushCommand(std::move(cmd));
             }
         }
     });
+
+    // switch on, and start the emulator thread
+    this->videoStatTime = Clock::Now();
+    this->lapTime = Clock::Now();
+    this->statTime = Clock::Now();
+    this->TogglePower();
+    #if ORYOL_HAS_THREADS
+    this->thread = std::thread(&Emu::threadLoop, this);
+    #endif
 }
 
+
 //------------------------------------------------------------------------------
 void Emu::Discard() {
-    saudio_shutdown();
     Input::UnsubscribeEvents(this->inputCallbackId);
+    #if ORYOL_HAS_THREADS
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stop = true;
+    }
+    this->wakeup.notify_one();
+    this->thread.join();
+    #endif
+    saudio_shutdown();
+    stream_emu = nullptr;
+    if (this->powered) {
+        kc85_discard(&this->kc85);
+        this->powered = false;
+    }
+    this->commands.Clear();
+    this->rewind.Discard();
+    this->frames.Discard();
+    this->audioRing.Discard();
 }
 
 //------------------------------------------------------------------------------
-void Emu::Tick(Duration frameTime) {
-    this->frameIndex++;
-    if (this->switchedOn) {
-        uint32_t microSecs = (uint32_t)frameTime.AsMicroSeconds();
-        // clamp to 30Hz, in case we've been switched to the background
-        if (microSecs > 33333) {
-            microSecs = 33333;
-        }
-        kc85_exec(&this->kc85, microSecs);
-    }
-    // start a game?
-    if (this->startGamePath && (this->startGameFrameIndex == this->frameIndex)) {
-        IO::Load(this->startGamePath, [this](IO::LoadResult ioResult) {
-            kc85_quickload(&this->kc85, ioResult.Data.Data(), ioResult.Data.Size());
-        });
-        this->startGamePath = nullptr;
+void Emu::pushCommand(command&& cmd) {
+    #if ORYOL_HAS_THREADS
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->commands.Add(std::move(cmd));
     }
+    this->wakeup.notify_one();
+    #else
+    this->commands.Add(std::move(cmd));
+    #endif
 }
 
 //------------------------------------------------------------------------------
-void Emu::Render(const glm::mat4& mvp) {
-    if (this->switchedOn) {
-        ImageDataAttrs updAttrs;
-        updAttrs.NumFaces = 1;
-        updAttrs.NumMipMaps = 1;
-        updAttrs.Sizes[0][0] = sizeof(this->pixelBuffer);
-        Gfx::UpdateTexture(this->drawState.FSTexture[0], this->pixelBuffer, updAttrs);
-        EmuShader::vsParams vsParams;
-        vsParams.mvp = mvp;
-        Gfx::ApplyDrawState(this->drawState);
-        Gfx::ApplyUniformBlock(vsParams);
-        Gfx::Draw();
+void Emu::processCommands() {
+    Array<command> cmds;
+    #if ORYOL_HAS_THREADS
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        cmds = std::move(this->commands);
+    }
+    #else
+    cmds = std::move(this->commands);
+    #endif
+    for (command& cmd : cmds) {
+        switch (cmd.type) {
+            case command::KeyDown:
+            case command::KeyUp:
+                if (this->powered) {
+                    this->cleanBoot = false;
+                    if (command::KeyDown == cmd.type) {
+                        kc85_key_down(&this->kc85, cmd.key);
+                    }
+                    else {
+                        kc85_key_up(&this->kc85, cmd.key);
+                    }
+                }
+                break;
+            case command::Power:
+                this->power(0 != cmd.key);
+                break;
+            case command::Reset:
+                if (this->powered) {
+                    kc85_reset(&this->kc85);
+                    this->cleanBoot = false;
+                    this->booted = false;
+                    this->numStableFrames = 0;
+                }
+                break;
+            case command::StartGame:
+                this->power(false);
+                this->power(true);
+                if (!this->bootState.Empty() && kc85_load_state(&this->kc85, this->bootState.Data(), this->bootState.Size())) {
+                    // continue from the CAOS prompt
+                    this->booted = true;
+                }
+                // otherwise this is a clean boot, and the boot state is
+                // captured before the game is loaded
+                break;
+            case command::Quickload:
+                // the game is loaded at the end of a frame once CAOS has booted
+                if (this->powered) {
+                    this->pendingGame = std::move(cmd.data);
+                }
+                break;
+        }
     }
 }
 
 //------------------------------------------------------------------------------
-void Emu::TogglePower() {
-    this->switchedOn = !this->switchedOn;
-    if (this->switchedOn) {
+void Emu::power(bool on) {
+    if (on == this->powered) {
+        return;
+    }
+    this->powered = on;
+    if (on) {
         kc85_desc_t kc85_desc = { };
         kc85_desc.type = KC85_TYPE_3;
         kc85_desc.pixel_buffer = this->pixelBuffer;
         kc85_desc.pixel_buffer_size = sizeof(this->pixelBuffer);
         kc85_desc.audio_cb = push_audio;
-        kc85_desc.audio_sample_rate = saudio_sample_rate();
+        kc85_desc.audio_sample_rate = this->audioSampleRate;
         kc85_desc.patch_cb = patch_snapshots;
         kc85_desc.rom_caos31 = dump_caos31;
         kc85_desc.rom_caos31_size = sizeof(dump_caos31);
@@ -200,6 +306,233 @@ void Emu::TogglePower() {
     else {
         kc85_discard(&this->kc85);
     }
+    this->rewind.Clear();
+    this->rewinding = false;
+    this->booted = false;
+    this->displayHash = 0;
+    this->numStableFrames = 0;
+    this->cleanBoot = true;
+    this->pendingGame.Clear();
+}
+
+#if ORYOL_HAS_THREADS
+//------------------------------------------------------------------------------
+void Emu::threadLoop() {
+    while (true) {
+        this->step();
+        // sleep until the audio ring needs to be topped up again,
+        // or the main thread has queued a command
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->wakeup.wait_for(lock, std::chrono::milliseconds(1), [this] {
+            return this->stop || !this->commands.Empty();
+        });
+        if (this->stop) {
+            return;
+        }
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------
+void Emu::step() {
+    this->processCommands();
+    uint32_t lapMicroSecs = (uint32_t)Clock::LapTime(this->lapTime).AsMicroSeconds();
+    // clamp to 30Hz, in case the emulator thread didn't run for a while
+    if (lapMicroSecs > 33333) {
+        lapMicroSecs = 33333;
+    }
+    if (this->powered) {
+        const bool turboMode = this->turbo;
+        this->rewinding = this->rewindKey && (this->rewind.NumStates() > 0);
+        if (this->rewinding || turboMode || !this->audioValid) {
+            this->audioPaced = false;
+        }
+        if (this->rewinding) {
+            // while PageUp is held, go back one state per video frame,
+            // and run one silent video frame to show the restored state
+            this->rewindMicroSecs += lapMicroSecs;
+            if (this->rewindMicroSecs >= FrameMicroSecs) {
+                this->rewindMicroSecs = 0;
+                this->rewind.StepBack(&this->kc85);
+                kc85_enable_audio(&this->kc85, false);
+                this->exec(FrameMicroSecs);
+            }
+        }
+        else if (this->audioValid && !turboMode) {
+            // run the emulator until the audio ring is filled up to the
+            // target level, this slaves the emulator to the audio clock,
+            // so that emulator and audio device can't drift apart
+            kc85_enable_audio(&this->kc85, true);
+            const int missing = this->audioTarget - this->audioRing.NumFilled();
+            if (missing > 0) {
+                this->exec(uint32_t((int64_t(missing) * 1000000) / this->audioSampleRate));
+            }
+            // underruns are only counted once the ring has been filled
+            this->audioPaced = true;
+            this->audioFillSum += this->audioRing.NumFilled();
+            this->audioFillCount++;
+        }
+        else {
+            // without audio, and in turbo mode, follow the wall clock,
+            // in turbo mode, only one frame per TurboFrames is decoded
+            kc85_enable_audio(&this->kc85, false);
+            if (turboMode) {
+                this->exec(lapMicroSecs * this->TurboFrames, true);
+            }
+            else {
+                this->exec(lapMicroSecs);
+            }
+        }
+    }
+    else {
+        this->audioPaced = false;
+        this->rewinding = false;
+    }
+
+    // update the emulated-MHz and audio latency statistics twice per second
+    const uint32_t statMicroSecs = (uint32_t)Clock::Since(this->statTime).AsMicroSeconds();
+    if (statMicroSecs >= 500000) {
+        this->emulatedMHz = float(this->statTicks) / float(statMicroSecs);
+        if ((this->audioFillCount > 0) && (this->audioSampleRate > 0)) {
+            // a new sample waits for the samples in the audio ring,
+            // and then for the sokol-audio streaming buffer
+            const float frames = float(this->audioFillSum) / float(this->audioFillCount) + float(AudioBufferFrames);
+            this->audioLatency = (frames * 1000.0f) / float(this->audioSampleRate);
+        }
+        this->statTicks = 0;
+        this->audioFillSum = 0;
+        this->audioFillCount = 0;
+        this->statTime = Clock::Now();
+    }
+}
+
+//------------------------------------------------------------------------------
+void Emu::exec(uint32_t microSecs, bool skipVideo) {
+    // the slices are shorter than the vertical blank, so the end of
+    // the visible area is never skipped, and always falls into the
+    // slice after which the frame is complete
+    //
+    // with skipVideo, only every TurboFrames-th frame is decoded (about
+    // one per host frame), video decoding is only switched on or off in
+    // the vertical blank, and scanlines which were written while decoding
+    // was off are still marked dirty, so decoded frames are complete
+    const int visibleLines = kc85_std_display_height();
+    while (microSecs > 0) {
+        const uint32_t slice = (microSecs > MaxSliceMicroSecs) ? MaxSliceMicroSecs : microSecs;
+        microSecs -= slice;
+        const int prevScanline = this->kc85.cur_scanline;
+        const uint32_t ticks = kc85_exec(&this->kc85, slice);
+        this->statTicks += ticks;
+        if ((prevScanline < visibleLines) && (this->kc85.cur_scanline >= visibleLines)) {
+            this->frameDone();
+            bool decodeNext = true;
+            if (skipVideo && (++this->numSkippedFrames < this->TurboFrames)) {
+                decodeNext = false;
+            }
+            else {
+                this->numSkippedFrames = 0;
+            }
+            kc85_enable_video(&this->kc85, decodeNext);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Emu::frameDone() {
+    // hand the frame to the render thread if any scanline has changed
+    if (kc85_display_changed(&this->kc85)) {
+        memcpy(this->frames.BackBuffer(), this->pixelBuffer, sizeof(this->pixelBuffer));
+        this->frames.Publish();
+    }
+    if (!this->rewinding) {
+        this->rewind.Update(&this->kc85);
+    }
+    if (!this->booted) {
+        // CAOS waits for input at the prompt once the display RAM stops
+        // changing (the pixel buffer can't be used, since it isn't
+        // decoded in turbo mode)
+        const uint64_t hash = display_hash(&this->kc85);
+        if (hash == this->displayHash) {
+            this->booted = ++this->numStableFrames >= BootStableFrames;
+        }
+        else {
+            this->displayHash = hash;
+            this->numStableFrames = 0;
+        }
+    }
+    if (this->booted) {
+        // capture the machine state at the CAOS prompt after the first
+        // boot, games are started from this state without booting again
+        if (this->bootState.Empty() && this->cleanBoot) {
+            Buffer state;
+            const int maxSize = kc85_max_state_size();
+            const int size = kc85_save_state(&this->kc85, state.Add(maxSize), maxSize);
+            this->bootState.Add(state.Data(), size);
+        }
+        if (!this->pendingGame.Empty()) {
+            kc85_quickload(&this->kc85, this->pendingGame.Data(), this->pendingGame.Size());
+            this->pendingGame.Clear();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Emu::pullAudio(float* buffer, int numSamples) {
+    const int numRead = this->audioRing.Read(buffer, numSamples);
+    if (numRead < numSamples) {
+        memset(buffer + numRead, 0, (numSamples - numRead) * sizeof(float));
+        // an empty ring is expected while switched off or in turbo mode
+        if (this->audioPaced) {
+            this->numUnderruns++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Emu::Tick() {
+    // the key state can only be polled on the main thread
+    this->rewindKey = Input::KeyPressed(Key::PageUp);
+    #if !ORYOL_HAS_THREADS
+    this->step();
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void Emu::Render(const glm::mat4& mvp) {
+    if (this->switchedOn) {
+        // only upload the emulator framebuffer if a new frame has been finished
+        if (this->frames.Consume()) {
+            ImageDataAttrs updAttrs;
+            updAttrs.NumFaces = 1;
+            updAttrs.NumMipMaps = 1;
+            updAttrs.Sizes[0][0] = this->frames.FrameSize();
+            Gfx::UpdateTexture(this->drawState.FSTexture[0], this->frames.FrontBuffer(), updAttrs);
+            this->videoLatencySum += float(Clock::Since(this->frames.FrontTime()).AsMilliSeconds());
+            this->videoLatencyCount++;
+        }
+        EmuShader::vsParams vsParams;
+        vsParams.mvp = mvp;
+        Gfx::ApplyDrawState(this->drawState);
+        Gfx::ApplyUniformBlock(vsParams);
+        Gfx::Draw();
+    }
+    if (Clock::Since(this->videoStatTime).AsSeconds() >= 0.5) {
+        if (this->videoLatencyCount > 0) {
+            this->videoLatency = this->videoLatencySum / float(this->videoLatencyCount);
+        }
+        this->videoLatencySum = 0.0f;
+        this->videoLatencyCount = 0;
+        this->videoStatTime = Clock::Now();
+    }
+}
+
+//------------------------------------------------------------------------------
+void Emu::TogglePower() {
+    this->switchedOn = !this->switchedOn;
+    command cmd;
+    cmd.type = command::Power;
+    cmd.key = this->switchedOn ? 1 : 0;
+    this->pushCommand(std::move(cmd));
 }
 
 //------------------------------------------------------------------------------
@@ -210,19 +543,56 @@ bool Emu::SwitchedOn() const {
 //------------------------------------------------------------------------------
 void Emu::Reset() {
     if (this->switchedOn) {
-        kc85_reset(&this->kc85);
+        command cmd;
+        cmd.type = command::Reset;
+        this->pushCommand(std::move(cmd));
     }
 }
 
+//------------------------------------------------------------------------------
+void Emu::ToggleTurbo() {
+    this->turbo = !this->turbo;
+}
+
+//------------------------------------------------------------------------------
+bool Emu::Turbo() const {
+    return this->turbo;
+}
+
+//------------------------------------------------------------------------------
+float Emu::EmulatedMHz() const {
+    return this->switchedOn ? this->emulatedMHz.load() : 0.0f;
+}
+
+//------------------------------------------------------------------------------
+bool Emu::Rewinding() const {
+    return this->switchedOn && this->rewinding;
+}
+
+//------------------------------------------------------------------------------
+Emu::Stats Emu::GetStats() const {
+    Stats stats;
+    stats.AudioLatency = this->audioLatency;
+    stats.VideoLatency = this->videoLatency;
+    stats.NumUnderruns = this->numUnderruns;
+    stats.NumOverruns = this->numOverruns;
+    return stats;
+}
+
 //------------------------------------------------------------------------------
 void Emu::StartGame(const char* path) {
-    if (this->switchedOn) {
-        this->TogglePower();
-    }
-    this->TogglePower();
-    this->startGameFrameIndex = this->frameIndex + 3 * 60;
-    this->startGamePath = path;
+    // power-cycle and continue from the boot state (if captured already),
+    // the game data is quickloaded as soon as CAOS has booted
+    this->switchedOn = true;
+    command cmd;
+    cmd.type = command::StartGame;
+    this->pushCommand(std::move(cmd));
+    IO::Load(path, [this](IO::LoadResult ioResult) {
+        command load;
+        load.type = command::Quickload;
+        load.data = std::move(ioResult.Data);
+        this->pushCommand(std::move(load));
+    });
 }
 
 } // namespace Oryol
-
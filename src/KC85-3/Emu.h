@@ -3,12 +3,31 @@
 /**
     @class Emu
     @brief wrapper class for the actual KC85/3 emulator.
+
+    The emulator runs on its own thread, paced by the fill level of
+    the audio ring which is drained by the audio thread. Finished
+    video frames are handed to the render thread through a triple
+    buffer, and input events are passed to the emulator thread through
+    a command queue. On platforms without threads, Tick() runs the
+    emulator on the main thread with the same pacing.
 */
 #include "emu/emu.h"
+#include "Rewind.h"
+#include "AudioRing.h"
+#include "TripleBuffer.h"
+#include "Core/Types.h"
+#include "Core/Time/Clock.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
 #include "Gfx/Gfx.h"
-#include "Core/Time/Duration.h"
 #include "Input/Input.h"
 #include "glm/mat4x4.hpp"
+#include <atomic>
+#if ORYOL_HAS_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
 
 namespace Oryol {
 
@@ -18,8 +37,8 @@ public:
     void Setup(const GfxSetup& gfxSetup);
     /// discard the KC85/3 instance
     void Discard();
-    /// tick the emulator
-    void Tick(Duration frameTime);
+    /// call once per frame on the main thread
+    void Tick();
     /// render the emulator output
     void Render(const glm::mat4& mvp);
 
@@ -31,19 +50,140 @@ public:
     void Reset();
     /// load and start a game by name
     void StartGame(const char* name);
+    /// switch turbo mode on/off
+    void ToggleTurbo();
+    /// return true if turbo mode is on
+    bool Turbo() const;
+    /// get the emulated CPU frequency in MHz (averaged over half a second)
+    float EmulatedMHz() const;
+    /// return true if the emulator is currently rewinding (PageUp held)
+    bool Rewinding() const;
+
+    /// audio and video latency statistics (averaged over half a second)
+    struct Stats {
+        /// time from audio sample generation to playback in milliseconds
+        float AudioLatency = 0.0f;
+        /// time from finished emulator frame to texture upload in milliseconds
+        float VideoLatency = 0.0f;
+        /// audio buffers which couldn't be completely filled since setup
+        int NumUnderruns = 0;
+        /// audio samples dropped because the audio ring was full since setup
+        int NumOverruns = 0;
+    };
+    /// get audio and video latency statistics
+    Stats GetStats() const;
+
+    /// emulated speed in turbo mode (times realtime)
+    int TurboFrames = 10;
+
+    /// sokol-audio streaming buffer size in sample frames
+    static const int AudioBufferFrames = 2048;
+    /// audio ring capacity in samples (must be a power of 2)
+    static const int AudioRingSize = 8192;
+    /// the audio ring is kept filled up to one streaming buffer plus this margin
+    static const int AudioMarginFrames = 1024;
+    /// emulator time slices must be shorter than the KC85 vertical blank
+    static const uint32_t MaxSliceMicroSecs = 3000;
+    /// duration of one KC85 video frame
+    static const uint32_t FrameMicroSecs = 20000;
 
-    static const uint32_t InvalidFrameIndex = 0xFFFFFFFF;
-    uint32_t frameIndex = 0;
-    uint32_t startGameFrameIndex = InvalidFrameIndex;
-    const char* startGamePath = nullptr;
+    /// rewind buffer memory budget, a state every RewindInterval emulated frames
+    static const int RewindBudget = 8 * 1024 * 1024;
+    static const int RewindInterval = 5;
+    static const int RewindKeyframeInterval = 50;
 
+    /// CAOS has booted to the command prompt when the display RAM hasn't
+    /// changed for this many frames (CAOS pauses for up to 1.5 seconds
+    /// while booting, and is at the prompt after about 6.5 seconds)
+    static const int BootStableFrames = 100;
+
+    /// a command from the main thread to the emulator thread
+    struct command {
+        enum code {
+            KeyDown,
+            KeyUp,
+            Power,
+            Reset,
+            StartGame,
+            Quickload,
+        } type = KeyDown;
+        int key = 0;     // key code, or 1 for power on
+        Buffer data;     // game data for Quickload
+    };
+    /// queue a command for the emulator thread
+    void pushCommand(command&& cmd);
+    /// execute queued commands (emulator thread)
+    void processCommands();
+    /// switch the emulated machine on or off (emulator thread)
+    void power(bool on);
+    /// process commands and run the emulator until the audio ring is filled (emulator thread)
+    void step();
+    /// run the emulator in slices, and publish each finished frame, or only every TurboFrames-th with skipVideo (emulator thread)
+    void exec(uint32_t microSecs, bool skipVideo=false);
+    /// called at the end of the visible area of each video frame (emulator thread)
+    void frameDone();
+    /// fill an audio buffer from the audio ring (audio thread)
+    void pullAudio(float* buffer, int numSamples);
+    #if ORYOL_HAS_THREADS
+    /// emulator thread function
+    void threadLoop();
+    #endif
+
+    // main thread state
     bool switchedOn = false;
     DrawState drawState;
     Input::CallbackId inputCallbackId = 0;
+    TimePoint videoStatTime;
+    float videoLatencySum = 0.0f;
+    int videoLatencyCount = 0;
+    float videoLatency = 0.0f;
 
+    // shared state
+    std::atomic<bool> turbo{false};
+    std::atomic<bool> rewindKey{false};
+    std::atomic<bool> rewinding{false};
+    std::atomic<bool> audioPaced{false};
+    std::atomic<float> emulatedMHz{0.0f};
+    std::atomic<float> audioLatency{0.0f};
+    std::atomic<int> numUnderruns{0};
+    std::atomic<int> numOverruns{0};
+    AudioRing audioRing;
+    TripleBuffer frames;
+    Array<command> commands;
+    #if ORYOL_HAS_THREADS
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stop = false;
+    #endif
+
+    // emulator thread state
+    bool powered = false;
+    bool audioValid = false;
+    int audioSampleRate = 0;
+    int audioTarget = 0;
+    TimePoint lapTime;
+    uint32_t rewindMicroSecs = 0;
+    /// emulated frames since the last decoded frame in turbo mode
+    int numSkippedFrames = 0;
+    TimePoint statTime;
+    uint32_t statTicks = 0;
+    int audioFillSum = 0;
+    int audioFillCount = 0;
+    Rewind rewind;
+    /// machine state at the CAOS prompt, captured once after the first boot
+    Buffer bootState;
+    /// true once CAOS has booted to the prompt since power-on
+    bool booted = false;
+    /// display RAM hash and number of frames it has been unchanged, while booting
+    uint64_t displayHash = 0;
+    int numStableFrames = 0;
+    /// false after key input or reset since power-on, boot state is not captured then
+    bool cleanBoot = false;
+    /// game data which is quickloaded as soon as CAOS has booted
+    Buffer pendingGame;
     kc85_t kc85;
     uint32_t pixelBuffer[320 * 256];
 };
 
 } // namespace Oryol
-
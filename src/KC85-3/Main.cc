@@ -5,7 +5,6 @@
 #include "Core/Main.h"
 #include "IO/IO.h"
 #include "HttpFS/HTTPFileSystem.h"
-#include "Core/Time/Clock.h"
 #include "Gfx/Gfx.h"
 #include "Dbg/Dbg.h"
 #include "Input/Input.h"
@@ -43,12 +42,12 @@ public:
     void handleInput();
     void tooltip(const DisplayAttrs& disp, const char* str);
 
-    TimePoint lapTime;
     SceneRenderer scene;
     RayCheck rayChecker;
     glm::mat4 kcModelMatrix;
     CameraHelper camera;
     Emu emu;
+    bool showStats = false;
 };
 OryolMain(KC853App);
 
@@ -94,7 +93,6 @@ KC853App::OnInit() {
 
     // setup the KC emulator
     this->emu.Setup(gfxSetup);
-    this->lapTime = Clock::Now();
 
     glm::mat4 m = glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     m = glm::rotate(m, -glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
@@ -112,7 +110,21 @@ KC853App::OnRunning() {
     this->handleInput();
 
     // update KC85 emu
-    this->emu.Tick(Clock::LapTime(this->lapTime));
+    this->emu.Tick();
+    if (this->emu.Turbo()) {
+        Dbg::CursorPos(1, 1);
+        Dbg::PrintF("TURBO %.1f MHZ", this->emu.EmulatedMHz());
+    }
+    else if (this->emu.Rewinding()) {
+        Dbg::CursorPos(1, 1);
+        Dbg::PrintF("REWIND");
+    }
+    if (this->showStats) {
+        const Emu::Stats stats = this->emu.GetStats();
+        Dbg::CursorPos(1, 3);
+        Dbg::PrintF("AUDIO %.1f MS VIDEO %.1f MS UNDERRUNS %d OVERRUNS %d",
+            stats.AudioLatency, stats.VideoLatency, stats.NumUnderruns, stats.NumOverruns);
+    }
 
     // render the voxel scene and emulator screen
     Gfx::BeginPass();
@@ -138,6 +150,10 @@ KC853App::OnCleanup() {
 //------------------------------------------------------------------------------
 void
 KC853App::handleInput() {
+    // Tab toggles the audio/video latency statistics
+    if (Input::KeyDown(Key::Tab)) {
+        this->showStats = !this->showStats;
+    }
     if (Input::MouseAttached()) {
         glm::vec2 screenSpaceMousePos = Input::MousePosition();
         const bool lmb = Input::MouseButtonDown(MouseButton::Left);
@@ -177,7 +193,15 @@ KC853App::handleInput() {
                 this->tooltip(disp, "TYPE SOMETHING!");
                 break;
             case TapeDeck:
-                this->tooltip(disp, "AN 'LCR-C DATA' TAPE DECK");
+                if (lmb) {
+                    this->emu.ToggleTurbo();
+                }
+                if (this->emu.Turbo()) {
+                    this->tooltip(disp, "FAST-FORWARD OFF");
+                }
+                else {
+                    this->tooltip(disp, "FAST-FORWARD!");
+                }
                 break;
             case Jungle:
                 if (lmb) {
@@ -0,0 +1,259 @@
+//------------------------------------------------------------------------------
+//  Rewind.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Rewind.h"
+#include "Core/Assertion.h"
+#include <string.h>
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+void
+Rewind::Setup(int memBudget, int intv, int keyIntv) {
+    o_assert_dbg(!this->valid);
+    o_assert_dbg((intv > 0) && (keyIntv > 0));
+    this->valid = true;
+    this->memoryBudget = memBudget;
+    this->interval = intv;
+    this->keyframeInterval = keyIntv;
+    const int maxSize = kc85_max_state_size();
+    this->keyState.Add(maxSize);
+    this->curState.Add(maxSize);
+    this->scratch.Add(maxSize);
+    this->Clear();
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::Discard() {
+    o_assert_dbg(this->valid);
+    this->Clear();
+    this->keyState.Clear();
+    this->curState.Clear();
+    this->scratch.Clear();
+    this->packed.Clear();
+    this->valid = false;
+}
+
+//------------------------------------------------------------------------------
+bool
+Rewind::IsValid() const {
+    return this->valid;
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::Clear() {
+    this->states.Clear();
+    this->keyIndex = InvalidIndex;
+    this->frameCount = 0;
+    this->numBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+int
+Rewind::NumStates() const {
+    return this->states.Size();
+}
+
+//------------------------------------------------------------------------------
+int
+Rewind::NumFrames() const {
+    return this->states.Size() * this->interval;
+}
+
+//------------------------------------------------------------------------------
+int
+Rewind::NumBytes() const {
+    return this->numBytes;
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::encode(const uint8_t* src, const uint8_t* ref, int size, Buffer& dst) {
+    // a sequence of (16-bit zero count, 16-bit literal count, literals),
+    // a literal run ends at 4 consecutive zero bytes
+    dst.Clear();
+    int i = 0;
+    while (i < size) {
+        int zeros = 0;
+        while ((i < size) && (zeros < 0xFFFF) && (0 == (src[i] ^ (ref ? ref[i] : 0)))) {
+            zeros++;
+            i++;
+        }
+        const int start = i;
+        while ((i < size) && ((i - start) < 0xFFFF)) {
+            if ((i + 3) < size) {
+                uint32_t a, b = 0;
+                memcpy(&a, src + i, 4);
+                if (ref) {
+                    memcpy(&b, ref + i, 4);
+                }
+                if (0 == (a ^ b)) {
+                    break;
+                }
+            }
+            i++;
+        }
+        const int lits = i - start;
+        uint8_t* ptr = dst.Add(4 + lits);
+        ptr[0] = zeros & 0xFF;
+        ptr[1] = zeros >> 8;
+        ptr[2] = lits & 0xFF;
+        ptr[3] = lits >> 8;
+        for (int l = 0; l < lits; l++) {
+            ptr[4 + l] = src[start + l] ^ (ref ? ref[start + l] : 0);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::decodeXor(const Buffer& src, uint8_t* dst, int size) {
+    const uint8_t* ptr = src.Data();
+    const uint8_t* end = ptr + src.Size();
+    int i = 0;
+    while (ptr < end) {
+        const int zeros = ptr[0] | (ptr[1] << 8);
+        const int lits = ptr[2] | (ptr[3] << 8);
+        ptr += 4;
+        i += zeros;
+        o_assert_dbg((i + lits) <= size);
+        for (int l = 0; l < lits; l++) {
+            dst[i++] ^= *ptr++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+Rewind::decodeState(int index) {
+    const state& st = this->states[index];
+    int keyIdx = index;
+    while (!this->states[keyIdx].keyframe) {
+        keyIdx--;
+    }
+    const state& key = this->states[keyIdx];
+    uint8_t* dst = this->scratch.Data();
+    const int size = st.size > key.size ? st.size : key.size;
+    memset(dst, 0, size);
+    decodeXor(key.data, dst, key.size);
+    if (keyIdx != index) {
+        decodeXor(st.data, dst, st.size);
+    }
+    return st.size;
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::dropOldest() {
+    // drop the first keyframe and all the deltas which depend on it
+    int num = 1;
+    while ((num < this->states.Size()) && !this->states[num].keyframe) {
+        num++;
+    }
+    for (int i = 0; i < num; i++) {
+        this->numBytes -= this->states[0].data.Size();
+        this->states.Erase(0);
+    }
+    if (InvalidIndex != this->keyIndex) {
+        this->keyIndex -= num;
+        if (this->keyIndex < 0) {
+            this->keyIndex = InvalidIndex;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Rewind::Update(kc85_t* sys) {
+    o_assert_dbg(this->valid);
+    if (0 != (this->frameCount++ % this->interval)) {
+        return;
+    }
+    const int maxSize = this->curState.Size();
+    const int size = kc85_save_state(sys, this->curState.Data(), maxSize);
+    o_assert_dbg(size > 0);
+
+    // try to store a delta to the current keyframe, start a new
+    // keyframe if the group is full or the delta got too big
+    bool keyframe = true;
+    if (InvalidIndex != this->keyIndex) {
+        const int keySize = this->states[this->keyIndex].size;
+        if ((this->states.Size() - this->keyIndex) < this->keyframeInterval) {
+            uint8_t* key = this->keyState.Data();
+            if (size > keySize) {
+                memset(key + keySize, 0, size - keySize);
+            }
+            encode(this->curState.Data(), key, size, this->packed);
+            keyframe = this->packed.Size() > (size / 4);
+        }
+    }
+    if (keyframe) {
+        encode(this->curState.Data(), nullptr, size, this->packed);
+        memcpy(this->keyState.Data(), this->curState.Data(), size);
+        this->keyIndex = this->states.Size();
+    }
+    state& st = this->states.Add();
+    st.keyframe = keyframe;
+    st.size = size;
+    st.data.Add(this->packed.Data(), this->packed.Size());
+    this->numBytes += st.data.Size();
+
+    // keep at least the current keyframe group
+    while ((this->numBytes > this->memoryBudget) && (this->keyIndex > 0)) {
+        this->dropOldest();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+Rewind::Restore(kc85_t* sys, int index) {
+    o_assert_dbg(this->valid);
+    if ((index < 0) || (index >= this->states.Size())) {
+        return false;
+    }
+    const int size = this->decodeState(index);
+    if (!kc85_load_state(sys, this->scratch.Data(), size)) {
+        return false;
+    }
+    // drop newer states, and continue capturing from the restored state
+    while (this->states.Size() > (index + 1)) {
+        this->numBytes -= this->states.Back().data.Size();
+        this->states.Erase(this->states.Size() - 1);
+    }
+    int keyIdx = index;
+    while (!this->states[keyIdx].keyframe) {
+        keyIdx--;
+    }
+    if (keyIdx != this->keyIndex) {
+        this->keyIndex = keyIdx;
+        const int keySize = this->states[keyIdx].size;
+        memset(this->keyState.Data(), 0, keySize);
+        decodeXor(this->states[keyIdx].data, this->keyState.Data(), keySize);
+    }
+    this->frameCount = 1;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+Rewind::StepBack(kc85_t* sys) {
+    o_assert_dbg(this->valid);
+    const int index = this->states.Size() - 1;
+    if (index < 0) {
+        return false;
+    }
+    if (!this->Restore(sys, index)) {
+        return false;
+    }
+    this->numBytes -= this->states.Back().data.Size();
+    this->states.Erase(index);
+    if (this->keyIndex >= this->states.Size()) {
+        this->keyIndex = InvalidIndex;
+    }
+    return true;
+}
+
+} // namespace Oryol
@@ -0,0 +1,79 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::Rewind
+    @brief ring of compressed KC85 save states for rewinding the emulator
+
+    Update() captures a kc85_save_state() every Interval frames. States
+    are grouped behind keyframes, a keyframe is stored run-length-encoded,
+    all other states are stored as the run-length-encoded XOR-delta to
+    their keyframe (most of the KC85 RAM doesn't change between frames,
+    so the deltas are mostly zero and very small). Restoring a state
+    needs to decode at most 2 states, no matter how old it is.
+
+    A new keyframe is started every KeyframeInterval states, or when
+    a delta gets too big. When the memory budget is exceeded, the oldest
+    keyframe group is dropped.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "emu/emu.h"
+
+namespace Oryol {
+
+class Rewind {
+public:
+    /// setup with memory budget in bytes, state capture interval in frames, and max states per keyframe group
+    void Setup(int memoryBudget, int interval, int keyframeInterval);
+    /// discard the rewind buffer
+    void Discard();
+    /// return true if the rewind buffer has been setup
+    bool IsValid() const;
+
+    /// call once per emulated frame, captures a state every interval frames
+    void Update(kc85_t* sys);
+    /// restore a state (0 is the oldest), and drop all newer states
+    bool Restore(kc85_t* sys, int index);
+    /// restore the newest state and drop it
+    bool StepBack(kc85_t* sys);
+    /// drop all states
+    void Clear();
+
+    /// number of stored states
+    int NumStates() const;
+    /// number of emulated frames covered by the stored states
+    int NumFrames() const;
+    /// number of bytes used by the compressed states
+    int NumBytes() const;
+
+private:
+    struct state {
+        bool keyframe = false;
+        int size = 0;       // uncompressed size
+        Buffer data;        // RLE compressed state or XOR-delta
+    };
+    /// run-length-encode src (XORed with ref if not null) into dst
+    static void encode(const uint8_t* src, const uint8_t* ref, int size, Buffer& dst);
+    /// decode into dst, XORing with the existing content
+    static void decodeXor(const Buffer& src, uint8_t* dst, int size);
+    /// decode a state into the scratch buffer, return its size
+    int decodeState(int index);
+    /// drop the oldest keyframe group
+    void dropOldest();
+
+    bool valid = false;
+    int memoryBudget = 0;
+    int interval = 0;
+    int keyframeInterval = 0;
+    int frameCount = 0;
+    int numBytes = 0;
+    Array<state> states;
+    /// index of the current keyframe in states (InvalidIndex if none)
+    int keyIndex = InvalidIndex;
+    Buffer keyState;
+    Buffer curState;
+    Buffer scratch;
+    Buffer packed;
+};
+
+} // namespace Oryol
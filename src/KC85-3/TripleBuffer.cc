@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+//  TripleBuffer.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "TripleBuffer.h"
+#include "Core/Assertion.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Time/Clock.h"
+#include <string.h>
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+TripleBuffer::~TripleBuffer() {
+    if (this->frames[0]) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TripleBuffer::Setup(int size) {
+    o_assert_dbg(!this->frames[0]);
+    o_assert_dbg(size > 0);
+    this->frameSize = size;
+    for (int i = 0; i < 3; i++) {
+        this->frames[i] = (uint8_t*) Memory::Alloc(size);
+        memset(this->frames[i], 0, size);
+    }
+    this->back = 0;
+    this->front = 1;
+    this->middle = 2;
+}
+
+//------------------------------------------------------------------------------
+void
+TripleBuffer::Discard() {
+    o_assert_dbg(this->frames[0]);
+    for (int i = 0; i < 3; i++) {
+        Memory::Free(this->frames[i]);
+        this->frames[i] = nullptr;
+    }
+    this->frameSize = 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+TripleBuffer::IsValid() const {
+    return nullptr != this->frames[0];
+}
+
+//------------------------------------------------------------------------------
+int
+TripleBuffer::FrameSize() const {
+    return this->frameSize;
+}
+
+//------------------------------------------------------------------------------
+void*
+TripleBuffer::BackBuffer() {
+    o_assert_dbg(this->frames[0]);
+    return this->frames[this->back];
+}
+
+//------------------------------------------------------------------------------
+void
+TripleBuffer::Publish() {
+    o_assert_dbg(this->frames[0]);
+    this->times[this->back] = Clock::Now();
+    const int prev = this->middle.exchange(this->back | NewFrameBit, std::memory_order_acq_rel);
+    this->back = prev & ~NewFrameBit;
+}
+
+//------------------------------------------------------------------------------
+bool
+TripleBuffer::Consume() {
+    o_assert_dbg(this->frames[0]);
+    if (0 == (this->middle.load(std::memory_order_relaxed) & NewFrameBit)) {
+        return false;
+    }
+    const int prev = this->middle.exchange(this->front, std::memory_order_acq_rel);
+    this->front = prev & ~NewFrameBit;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+const void*
+TripleBuffer::FrontBuffer() const {
+    o_assert_dbg(this->frames[0]);
+    return this->frames[this->front];
+}
+
+//------------------------------------------------------------------------------
+TimePoint
+TripleBuffer::FrontTime() const {
+    return this->times[this->front];
+}
+
+} // namespace Oryol
@@ -0,0 +1,56 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::TripleBuffer
+    @brief lock-free handoff of emulator frames to the render thread
+
+    The producer owns the back buffer, the consumer owns the front
+    buffer, and the third buffer sits in the middle. Publish() swaps
+    back and middle, Consume() swaps middle and front if a new frame
+    has been published since the last Consume(). Neither side ever
+    waits, the consumer always gets the newest complete frame, and
+    frames which are produced faster than they are consumed are
+    dropped.
+*/
+#include "Core/Types.h"
+#include "Core/Time/TimePoint.h"
+#include <atomic>
+
+namespace Oryol {
+
+class TripleBuffer {
+public:
+    /// destructor
+    ~TripleBuffer();
+    /// allocate the 3 buffers, frame size in bytes
+    void Setup(int frameSize);
+    /// free the buffers
+    void Discard();
+    /// return true if the buffers have been setup
+    bool IsValid() const;
+    /// frame size in bytes
+    int FrameSize() const;
+
+    /// get the back buffer (producer only)
+    void* BackBuffer();
+    /// publish the back buffer as the newest frame (producer only)
+    void Publish();
+    /// make the newest frame the front buffer, returns false if there's none (consumer only)
+    bool Consume();
+    /// get the front buffer (consumer only)
+    const void* FrontBuffer() const;
+    /// time when the front buffer was published (consumer only)
+    TimePoint FrontTime() const;
+
+private:
+    static const int NewFrameBit = 4;
+    uint8_t* frames[3] = { };
+    TimePoint times[3];
+    int frameSize = 0;
+    int back = 0;
+    int front = 1;
+    /// index of the middle buffer, plus NewFrameBit if it hasn't been consumed
+    std::atomic<int> middle{2};
+};
+
+} // namespace Oryol
@@ -0,0 +1,1536 @@
+/*
+    _z80_threaded.h
+
+    Alternative z80_exec() with threaded dispatch, z80.h includes this
+    instead of _z80_decoder.h if Z80_THREADED_DISPATCH is defined
+    (needs the GCC/clang 'labels as values' extension).
+
+    The opcode handlers are the same as in _z80_decoder.h, but:
+
+    - each handler dispatches directly to the next handler through a
+      256-entry label table, interrupt, NMI, trap and EI handling and
+      the tick budget check only leave this fast path if needed
+    - DD/FD, ED, CB and DD/FD+CB opcodes have their own handler tables,
+      the DD/FD and DD/FD+CB handlers are compiled with the index
+      register check resolved, and the CB handlers with the opcode's
+      x/y/z fields as constants, instead of decoding them at run time
+      (DD and FD share their handlers, IX or IY is mapped into HL)
+    - IX/IY is unmapped from HL right at the end of a DD/FD instruction
+
+    The tick callback protocol and the CPU state after each instruction
+    are the same as with _z80_decoder.h.
+*/
+
+/* the fast path to the next instruction, or the slow path with interrupt/trap/EI handling */
+#define _Z80_NEXT() if((pins&(Z80_INT|Z80_NMI))||(r2&_BIT_EI)||trap||(ticks>=num_ticks)){goto _z80_slow;}pre_pins=pins;_FETCH(op);goto *_z80_op[op]
+/* end of a DD/FD instruction, unmap IX/IY from HL first */
+#define _Z80_NEXT_IDX() r0=_z80_flush_r0(ws,r0,r2);r1=_z80_flush_r1(ws,r1,r2);r2&=~_BITS_MAP_REGS;map_bits=0;ws=r0;_Z80_NEXT()
+/* CB and DD/FD+CB ops with pre-decoded x/y/z opcode fields */
+#define _Z80_CB(x,y,z) {\
+  const int rz = (7-z)<<3;\
+  /* load the operand (for indexed ops, always from memory!) */\
+  if ((z == 6) || _IDX()) {\
+    _T(1);\
+    addr = _G_HL();\
+    if (_IDX()) {\
+      _T(1);\
+      addr += d;\
+      _S_WZ(addr);\
+    }\
+    _MR(addr,d8);\
+  }\
+  else {\
+    /* simple non-indexed, non-(HL): load register value */\
+    d8 = _G8(ws,rz);\
+  }\
+  uint8_t f = _G_F();\
+  uint8_t r;\
+  switch (x) {\
+    case 0:\
+       /* rot/shift */\
+       switch (y) {\
+         case 0: /*RLC*/ r=d8<<1|d8>>7; f=_z80_szp[r]|(d8>>7&Z80_CF); break;\
+         case 1: /*RRC*/ r=d8>>1|d8<<7; f=_z80_szp[r]|(d8&Z80_CF); break;\
+         case 2: /*RL */ r=d8<<1|(f&Z80_CF); f=_z80_szp[r]|(d8>>7&Z80_CF); break;\
+         case 3: /*RR */ r=d8>>1|((f&Z80_CF)<<7); f=_z80_szp[r]|(d8&Z80_CF); break;\
+         case 4: /*SLA*/ r=d8<<1; f=_z80_szp[r]|(d8>>7&Z80_CF); break;\
+         case 5: /*SRA*/ r=d8>>1|(d8&0x80); f=_z80_szp[r]|(d8&Z80_CF); break;\
+         case 6: /*SLL*/ r=d8<<1|1; f=_z80_szp[r]|(d8>>7&Z80_CF); break;\
+         case 7: /*SRL*/ r=d8>>1; f=_z80_szp[r]|(d8&Z80_CF); break;\
+       }\
+       break;\
+    case 1:\
+      /* BIT (bit test) */\
+      r = d8 & (1<<y);\
+      f = (f&Z80_CF) | Z80_HF | (r?(r&Z80_SF):(Z80_ZF|Z80_PF));\
+      if ((z == 6) || _IDX()) {\
+        f |= (_G_WZ()>>8) & (Z80_YF|Z80_XF);\
+      }\
+      else {\
+        f |= d8 & (Z80_YF|Z80_XF);\
+      }\
+      break;\
+    case 2:\
+      /* RES (bit clear) */\
+      r = d8 & ~(1<<y);\
+      break;\
+    case 3:\
+      /* SET (bit set) */\
+      r = d8 | (1<<y);\
+      break;\
+  }\
+  if (x != 1) {\
+    /* write result back */\
+    if ((z == 6) || _IDX()) {\
+      /* (HL), (IX+d), (IY+d): write back to memory, for extended ops,\
+         even when the op is actually a register op\
+      */\
+      _MW(addr,r);\
+    }\
+    if (z != 6) {\
+      /* write result back to register (special case for indexed + H/L! */\
+      if (_IDX() && ((z==4)||(z==5))) {\
+        _S8(r0,rz,r);\
+      }\
+      else {\
+        _S8(ws,rz,r);\
+      }\
+    }\
+  }\
+  _S_F(f);\
+}
+
+uint32_t z80_exec(z80_t* cpu, uint32_t num_ticks) {
+  /* opcode handler tables: main, DD/FD, ED, CB, DD/FD+CB */
+  static const void* const _z80_op[256] = {
+    &&_op_00,&&_op_01,&&_op_02,&&_op_03,&&_op_04,&&_op_05,&&_op_06,&&_op_07,
+    &&_op_08,&&_op_09,&&_op_0a,&&_op_0b,&&_op_0c,&&_op_0d,&&_op_0e,&&_op_0f,
+    &&_op_10,&&_op_11,&&_op_12,&&_op_13,&&_op_14,&&_op_15,&&_op_16,&&_op_17,
+    &&_op_18,&&_op_19,&&_op_1a,&&_op_1b,&&_op_1c,&&_op_1d,&&_op_1e,&&_op_1f,
+    &&_op_20,&&_op_21,&&_op_22,&&_op_23,&&_op_24,&&_op_25,&&_op_26,&&_op_27,
+    &&_op_28,&&_op_29,&&_op_2a,&&_op_2b,&&_op_2c,&&_op_2d,&&_op_2e,&&_op_2f,
+    &&_op_30,&&_op_31,&&_op_32,&&_op_33,&&_op_34,&&_op_35,&&_op_36,&&_op_37,
+    &&_op_38,&&_op_39,&&_op_3a,&&_op_3b,&&_op_3c,&&_op_3d,&&_op_3e,&&_op_3f,
+    &&_op_40,&&_op_41,&&_op_42,&&_op_43,&&_op_44,&&_op_45,&&_op_46,&&_op_47,
+    &&_op_48,&&_op_49,&&_op_4a,&&_op_4b,&&_op_4c,&&_op_4d,&&_op_4e,&&_op_4f,
+    &&_op_50,&&_op_51,&&_op_52,&&_op_53,&&_op_54,&&_op_55,&&_op_56,&&_op_57,
+    &&_op_58,&&_op_59,&&_op_5a,&&_op_5b,&&_op_5c,&&_op_5d,&&_op_5e,&&_op_5f,
+    &&_op_60,&&_op_61,&&_op_62,&&_op_63,&&_op_64,&&_op_65,&&_op_66,&&_op_67,
+    &&_op_68,&&_op_69,&&_op_6a,&&_op_6b,&&_op_6c,&&_op_6d,&&_op_6e,&&_op_6f,
+    &&_op_70,&&_op_71,&&_op_72,&&_op_73,&&_op_74,&&_op_75,&&_op_76,&&_op_77,
+    &&_op_78,&&_op_79,&&_op_7a,&&_op_7b,&&_op_7c,&&_op_7d,&&_op_7e,&&_op_7f,
+    &&_op_80,&&_op_81,&&_op_82,&&_op_83,&&_op_84,&&_op_85,&&_op_86,&&_op_87,
+    &&_op_88,&&_op_89,&&_op_8a,&&_op_8b,&&_op_8c,&&_op_8d,&&_op_8e,&&_op_8f,
+    &&_op_90,&&_op_91,&&_op_92,&&_op_93,&&_op_94,&&_op_95,&&_op_96,&&_op_97,
+    &&_op_98,&&_op_99,&&_op_9a,&&_op_9b,&&_op_9c,&&_op_9d,&&_op_9e,&&_op_9f,
+    &&_op_a0,&&_op_a1,&&_op_a2,&&_op_a3,&&_op_a4,&&_op_a5,&&_op_a6,&&_op_a7,
+    &&_op_a8,&&_op_a9,&&_op_aa,&&_op_ab,&&_op_ac,&&_op_ad,&&_op_ae,&&_op_af,
+    &&_op_b0,&&_op_b1,&&_op_b2,&&_op_b3,&&_op_b4,&&_op_b5,&&_op_b6,&&_op_b7,
+    &&_op_b8,&&_op_b9,&&_op_ba,&&_op_bb,&&_op_bc,&&_op_bd,&&_op_be,&&_op_bf,
+    &&_op_c0,&&_op_c1,&&_op_c2,&&_op_c3,&&_op_c4,&&_op_c5,&&_op_c6,&&_op_c7,
+    &&_op_c8,&&_op_c9,&&_op_ca,&&_op_cb,&&_op_cc,&&_op_cd,&&_op_ce,&&_op_cf,
+    &&_op_d0,&&_op_d1,&&_op_d2,&&_op_d3,&&_op_d4,&&_op_d5,&&_op_d6,&&_op_d7,
+    &&_op_d8,&&_op_d9,&&_op_da,&&_op_db,&&_op_dc,&&_op_dd,&&_op_de,&&_op_df,
+    &&_op_e0,&&_op_e1,&&_op_e2,&&_op_e3,&&_op_e4,&&_op_e5,&&_op_e6,&&_op_e7,
+    &&_op_e8,&&_op_e9,&&_op_ea,&&_op_eb,&&_op_ec,&&_op_ed,&&_op_ee,&&_op_ef,
+    &&_op_f0,&&_op_f1,&&_op_f2,&&_op_f3,&&_op_f4,&&_op_f5,&&_op_f6,&&_op_f7,
+    &&_op_f8,&&_op_f9,&&_op_fa,&&_op_fb,&&_op_fc,&&_op_fd,&&_op_fe,&&_op_ff,
+  };
+  static const void* const _z80_ix[256] = {
+    &&_ix_00,&&_ix_01,&&_ix_02,&&_ix_03,&&_ix_04,&&_ix_05,&&_ix_06,&&_ix_07,
+    &&_ix_08,&&_ix_09,&&_ix_0a,&&_ix_0b,&&_ix_0c,&&_ix_0d,&&_ix_0e,&&_ix_0f,
+    &&_ix_10,&&_ix_11,&&_ix_12,&&_ix_13,&&_ix_14,&&_ix_15,&&_ix_16,&&_ix_17,
+    &&_ix_18,&&_ix_19,&&_ix_1a,&&_ix_1b,&&_ix_1c,&&_ix_1d,&&_ix_1e,&&_ix_1f,
+    &&_ix_20,&&_ix_21,&&_ix_22,&&_ix_23,&&_ix_24,&&_ix_25,&&_ix_26,&&_ix_27,
+    &&_ix_28,&&_ix_29,&&_ix_2a,&&_ix_2b,&&_ix_2c,&&_ix_2d,&&_ix_2e,&&_ix_2f,
+    &&_ix_30,&&_ix_31,&&_ix_32,&&_ix_33,&&_ix_34,&&_ix_35,&&_ix_36,&&_ix_37,
+    &&_ix_38,&&_ix_39,&&_ix_3a,&&_ix_3b,&&_ix_3c,&&_ix_3d,&&_ix_3e,&&_ix_3f,
+    &&_ix_40,&&_ix_41,&&_ix_42,&&_ix_43,&&_ix_44,&&_ix_45,&&_ix_46,&&_ix_47,
+    &&_ix_48,&&_ix_49,&&_ix_4a,&&_ix_4b,&&_ix_4c,&&_ix_4d,&&_ix_4e,&&_ix_4f,
+    &&_ix_50,&&_ix_51,&&_ix_52,&&_ix_53,&&_ix_54,&&_ix_55,&&_ix_56,&&_ix_57,
+    &&_ix_58,&&_ix_59,&&_ix_5a,&&_ix_5b,&&_ix_5c,&&_ix_5d,&&_ix_5e,&&_ix_5f,
+    &&_ix_60,&&_ix_61,&&_ix_62,&&_ix_63,&&_ix_64,&&_ix_65,&&_ix_66,&&_ix_67,
+    &&_ix_68,&&_ix_69,&&_ix_6a,&&_ix_6b,&&_ix_6c,&&_ix_6d,&&_ix_6e,&&_ix_6f,
+    &&_ix_70,&&_ix_71,&&_ix_72,&&_ix_73,&&_ix_74,&&_ix_75,&&_ix_76,&&_ix_77,
+    &&_ix_78,&&_ix_79,&&_ix_7a,&&_ix_7b,&&_ix_7c,&&_ix_7d,&&_ix_7e,&&_ix_7f,
+    &&_ix_80,&&_ix_81,&&_ix_82,&&_ix_83,&&_ix_84,&&_ix_85,&&_ix_86,&&_ix_87,
+    &&_ix_88,&&_ix_89,&&_ix_8a,&&_ix_8b,&&_ix_8c,&&_ix_8d,&&_ix_8e,&&_ix_8f,
+    &&_ix_90,&&_ix_91,&&_ix_92,&&_ix_93,&&_ix_94,&&_ix_95,&&_ix_96,&&_ix_97,
+    &&_ix_98,&&_ix_99,&&_ix_9a,&&_ix_9b,&&_ix_9c,&&_ix_9d,&&_ix_9e,&&_ix_9f,
+    &&_ix_a0,&&_ix_a1,&&_ix_a2,&&_ix_a3,&&_ix_a4,&&_ix_a5,&&_ix_a6,&&_ix_a7,
+    &&_ix_a8,&&_ix_a9,&&_ix_aa,&&_ix_ab,&&_ix_ac,&&_ix_ad,&&_ix_ae,&&_ix_af,
+    &&_ix_b0,&&_ix_b1,&&_ix_b2,&&_ix_b3,&&_ix_b4,&&_ix_b5,&&_ix_b6,&&_ix_b7,
+    &&_ix_b8,&&_ix_b9,&&_ix_ba,&&_ix_bb,&&_ix_bc,&&_ix_bd,&&_ix_be,&&_ix_bf,
+    &&_ix_c0,&&_ix_c1,&&_ix_c2,&&_ix_c3,&&_ix_c4,&&_ix_c5,&&_ix_c6,&&_ix_c7,
+    &&_ix_c8,&&_ix_c9,&&_ix_ca,&&_ix_cb,&&_ix_cc,&&_ix_cd,&&_ix_ce,&&_ix_cf,
+    &&_ix_d0,&&_ix_d1,&&_ix_d2,&&_ix_d3,&&_ix_d4,&&_ix_d5,&&_ix_d6,&&_ix_d7,
+    &&_ix_d8,&&_ix_d9,&&_ix_da,&&_ix_db,&&_ix_dc,&&_op_dd,&&_ix_de,&&_ix_df,
+    &&_ix_e0,&&_ix_e1,&&_ix_e2,&&_ix_e3,&&_ix_e4,&&_ix_e5,&&_ix_e6,&&_ix_e7,
+    &&_ix_e8,&&_ix_e9,&&_ix_ea,&&_ix_eb,&&_ix_ec,&&_ix_ed,&&_ix_ee,&&_ix_ef,
+    &&_ix_f0,&&_ix_f1,&&_ix_f2,&&_ix_f3,&&_ix_f4,&&_ix_f5,&&_ix_f6,&&_ix_f7,
+    &&_ix_f8,&&_ix_f9,&&_ix_fa,&&_ix_fb,&&_ix_fc,&&_op_fd,&&_ix_fe,&&_ix_ff,
+  };
+  static const void* const _z80_ed[256] = {
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_40,&&_ed_41,&&_ed_42,&&_ed_43,&&_ed_44,&&_ed_45,&&_ed_46,&&_ed_47,
+    &&_ed_48,&&_ed_49,&&_ed_4a,&&_ed_4b,&&_ed_4c,&&_ed_4d,&&_ed_4e,&&_ed_4f,
+    &&_ed_50,&&_ed_51,&&_ed_52,&&_ed_53,&&_ed_54,&&_ed_55,&&_ed_56,&&_ed_57,
+    &&_ed_58,&&_ed_59,&&_ed_5a,&&_ed_5b,&&_ed_5c,&&_ed_5d,&&_ed_5e,&&_ed_5f,
+    &&_ed_60,&&_ed_61,&&_ed_62,&&_ed_63,&&_ed_64,&&_ed_65,&&_ed_66,&&_ed_67,
+    &&_ed_68,&&_ed_69,&&_ed_6a,&&_ed_6b,&&_ed_6c,&&_ed_6d,&&_ed_6e,&&_ed_6f,
+    &&_ed_70,&&_ed_71,&&_ed_72,&&_ed_73,&&_ed_74,&&_ed_75,&&_ed_76,&&_ed_77,
+    &&_ed_78,&&_ed_79,&&_ed_7a,&&_ed_7b,&&_ed_7c,&&_ed_7d,&&_ed_7e,&&_ed_7f,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_a0,&&_ed_a1,&&_ed_a2,&&_ed_a3,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_a8,&&_ed_a9,&&_ed_aa,&&_ed_ab,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_b0,&&_ed_b1,&&_ed_b2,&&_ed_b3,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_b8,&&_ed_b9,&&_ed_ba,&&_ed_bb,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+    &&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,&&_ed_nop,
+  };
+  static const void* const _z80_cb[256] = {
+    &&_cb_00,&&_cb_01,&&_cb_02,&&_cb_03,&&_cb_04,&&_cb_05,&&_cb_06,&&_cb_07,
+    &&_cb_08,&&_cb_09,&&_cb_0a,&&_cb_0b,&&_cb_0c,&&_cb_0d,&&_cb_0e,&&_cb_0f,
+    &&_cb_10,&&_cb_11,&&_cb_12,&&_cb_13,&&_cb_14,&&_cb_15,&&_cb_16,&&_cb_17,
+    &&_cb_18,&&_cb_19,&&_cb_1a,&&_cb_1b,&&_cb_1c,&&_cb_1d,&&_cb_1e,&&_cb_1f,
+    &&_cb_20,&&_cb_21,&&_cb_22,&&_cb_23,&&_cb_24,&&_cb_25,&&_cb_26,&&_cb_27,
+    &&_cb_28,&&_cb_29,&&_cb_2a,&&_cb_2b,&&_cb_2c,&&_cb_2d,&&_cb_2e,&&_cb_2f,
+    &&_cb_30,&&_cb_31,&&_cb_32,&&_cb_33,&&_cb_34,&&_cb_35,&&_cb_36,&&_cb_37,
+    &&_cb_38,&&_cb_39,&&_cb_3a,&&_cb_3b,&&_cb_3c,&&_cb_3d,&&_cb_3e,&&_cb_3f,
+    &&_cb_40,&&_cb_41,&&_cb_42,&&_cb_43,&&_cb_44,&&_cb_45,&&_cb_46,&&_cb_47,
+    &&_cb_48,&&_cb_49,&&_cb_4a,&&_cb_4b,&&_cb_4c,&&_cb_4d,&&_cb_4e,&&_cb_4f,
+    &&_cb_50,&&_cb_51,&&_cb_52,&&_cb_53,&&_cb_54,&&_cb_55,&&_cb_56,&&_cb_57,
+    &&_cb_58,&&_cb_59,&&_cb_5a,&&_cb_5b,&&_cb_5c,&&_cb_5d,&&_cb_5e,&&_cb_5f,
+    &&_cb_60,&&_cb_61,&&_cb_62,&&_cb_63,&&_cb_64,&&_cb_65,&&_cb_66,&&_cb_67,
+    &&_cb_68,&&_cb_69,&&_cb_6a,&&_cb_6b,&&_cb_6c,&&_cb_6d,&&_cb_6e,&&_cb_6f,
+    &&_cb_70,&&_cb_71,&&_cb_72,&&_cb_73,&&_cb_74,&&_cb_75,&&_cb_76,&&_cb_77,
+    &&_cb_78,&&_cb_79,&&_cb_7a,&&_cb_7b,&&_cb_7c,&&_cb_7d,&&_cb_7e,&&_cb_7f,
+    &&_cb_80,&&_cb_81,&&_cb_82,&&_cb_83,&&_cb_84,&&_cb_85,&&_cb_86,&&_cb_87,
+    &&_cb_88,&&_cb_89,&&_cb_8a,&&_cb_8b,&&_cb_8c,&&_cb_8d,&&_cb_8e,&&_cb_8f,
+    &&_cb_90,&&_cb_91,&&_cb_92,&&_cb_93,&&_cb_94,&&_cb_95,&&_cb_96,&&_cb_97,
+    &&_cb_98,&&_cb_99,&&_cb_9a,&&_cb_9b,&&_cb_9c,&&_cb_9d,&&_cb_9e,&&_cb_9f,
+    &&_cb_a0,&&_cb_a1,&&_cb_a2,&&_cb_a3,&&_cb_a4,&&_cb_a5,&&_cb_a6,&&_cb_a7,
+    &&_cb_a8,&&_cb_a9,&&_cb_aa,&&_cb_ab,&&_cb_ac,&&_cb_ad,&&_cb_ae,&&_cb_af,
+    &&_cb_b0,&&_cb_b1,&&_cb_b2,&&_cb_b3,&&_cb_b4,&&_cb_b5,&&_cb_b6,&&_cb_b7,
+    &&_cb_b8,&&_cb_b9,&&_cb_ba,&&_cb_bb,&&_cb_bc,&&_cb_bd,&&_cb_be,&&_cb_bf,
+    &&_cb_c0,&&_cb_c1,&&_cb_c2,&&_cb_c3,&&_cb_c4,&&_cb_c5,&&_cb_c6,&&_cb_c7,
+    &&_cb_c8,&&_cb_c9,&&_cb_ca,&&_cb_cb,&&_cb_cc,&&_cb_cd,&&_cb_ce,&&_cb_cf,
+    &&_cb_d0,&&_cb_d1,&&_cb_d2,&&_cb_d3,&&_cb_d4,&&_cb_d5,&&_cb_d6,&&_cb_d7,
+    &&_cb_d8,&&_cb_d9,&&_cb_da,&&_cb_db,&&_cb_dc,&&_cb_dd,&&_cb_de,&&_cb_df,
+    &&_cb_e0,&&_cb_e1,&&_cb_e2,&&_cb_e3,&&_cb_e4,&&_cb_e5,&&_cb_e6,&&_cb_e7,
+    &&_cb_e8,&&_cb_e9,&&_cb_ea,&&_cb_eb,&&_cb_ec,&&_cb_ed,&&_cb_ee,&&_cb_ef,
+    &&_cb_f0,&&_cb_f1,&&_cb_f2,&&_cb_f3,&&_cb_f4,&&_cb_f5,&&_cb_f6,&&_cb_f7,
+    &&_cb_f8,&&_cb_f9,&&_cb_fa,&&_cb_fb,&&_cb_fc,&&_cb_fd,&&_cb_fe,&&_cb_ff,
+  };
+  static const void* const _z80_ixcb[256] = {
+    &&_ixcb_00,&&_ixcb_01,&&_ixcb_02,&&_ixcb_03,&&_ixcb_04,&&_ixcb_05,&&_ixcb_06,&&_ixcb_07,
+    &&_ixcb_08,&&_ixcb_09,&&_ixcb_0a,&&_ixcb_0b,&&_ixcb_0c,&&_ixcb_0d,&&_ixcb_0e,&&_ixcb_0f,
+    &&_ixcb_10,&&_ixcb_11,&&_ixcb_12,&&_ixcb_13,&&_ixcb_14,&&_ixcb_15,&&_ixcb_16,&&_ixcb_17,
+    &&_ixcb_18,&&_ixcb_19,&&_ixcb_1a,&&_ixcb_1b,&&_ixcb_1c,&&_ixcb_1d,&&_ixcb_1e,&&_ixcb_1f,
+    &&_ixcb_20,&&_ixcb_21,&&_ixcb_22,&&_ixcb_23,&&_ixcb_24,&&_ixcb_25,&&_ixcb_26,&&_ixcb_27,
+    &&_ixcb_28,&&_ixcb_29,&&_ixcb_2a,&&_ixcb_2b,&&_ixcb_2c,&&_ixcb_2d,&&_ixcb_2e,&&_ixcb_2f,
+    &&_ixcb_30,&&_ixcb_31,&&_ixcb_32,&&_ixcb_33,&&_ixcb_34,&&_ixcb_35,&&_ixcb_36,&&_ixcb_37,
+    &&_ixcb_38,&&_ixcb_39,&&_ixcb_3a,&&_ixcb_3b,&&_ixcb_3c,&&_ixcb_3d,&&_ixcb_3e,&&_ixcb_3f,
+    &&_ixcb_40,&&_ixcb_41,&&_ixcb_42,&&_ixcb_43,&&_ixcb_44,&&_ixcb_45,&&_ixcb_46,&&_ixcb_47,
+    &&_ixcb_48,&&_ixcb_49,&&_ixcb_4a,&&_ixcb_4b,&&_ixcb_4c,&&_ixcb_4d,&&_ixcb_4e,&&_ixcb_4f,
+    &&_ixcb_50,&&_ixcb_51,&&_ixcb_52,&&_ixcb_53,&&_ixcb_54,&&_ixcb_55,&&_ixcb_56,&&_ixcb_57,
+    &&_ixcb_58,&&_ixcb_59,&&_ixcb_5a,&&_ixcb_5b,&&_ixcb_5c,&&_ixcb_5d,&&_ixcb_5e,&&_ixcb_5f,
+    &&_ixcb_60,&&_ixcb_61,&&_ixcb_62,&&_ixcb_63,&&_ixcb_64,&&_ixcb_65,&&_ixcb_66,&&_ixcb_67,
+    &&_ixcb_68,&&_ixcb_69,&&_ixcb_6a,&&_ixcb_6b,&&_ixcb_6c,&&_ixcb_6d,&&_ixcb_6e,&&_ixcb_6f,
+    &&_ixcb_70,&&_ixcb_71,&&_ixcb_72,&&_ixcb_73,&&_ixcb_74,&&_ixcb_75,&&_ixcb_76,&&_ixcb_77,
+    &&_ixcb_78,&&_ixcb_79,&&_ixcb_7a,&&_ixcb_7b,&&_ixcb_7c,&&_ixcb_7d,&&_ixcb_7e,&&_ixcb_7f,
+    &&_ixcb_80,&&_ixcb_81,&&_ixcb_82,&&_ixcb_83,&&_ixcb_84,&&_ixcb_85,&&_ixcb_86,&&_ixcb_87,
+    &&_ixcb_88,&&_ixcb_89,&&_ixcb_8a,&&_ixcb_8b,&&_ixcb_8c,&&_ixcb_8d,&&_ixcb_8e,&&_ixcb_8f,
+    &&_ixcb_90,&&_ixcb_91,&&_ixcb_92,&&_ixcb_93,&&_ixcb_94,&&_ixcb_95,&&_ixcb_96,&&_ixcb_97,
+    &&_ixcb_98,&&_ixcb_99,&&_ixcb_9a,&&_ixcb_9b,&&_ixcb_9c,&&_ixcb_9d,&&_ixcb_9e,&&_ixcb_9f,
+    &&_ixcb_a0,&&_ixcb_a1,&&_ixcb_a2,&&_ixcb_a3,&&_ixcb_a4,&&_ixcb_a5,&&_ixcb_a6,&&_ixcb_a7,
+    &&_ixcb_a8,&&_ixcb_a9,&&_ixcb_aa,&&_ixcb_ab,&&_ixcb_ac,&&_ixcb_ad,&&_ixcb_ae,&&_ixcb_af,
+    &&_ixcb_b0,&&_ixcb_b1,&&_ixcb_b2,&&_ixcb_b3,&&_ixcb_b4,&&_ixcb_b5,&&_ixcb_b6,&&_ixcb_b7,
+    &&_ixcb_b8,&&_ixcb_b9,&&_ixcb_ba,&&_ixcb_bb,&&_ixcb_bc,&&_ixcb_bd,&&_ixcb_be,&&_ixcb_bf,
+    &&_ixcb_c0,&&_ixcb_c1,&&_ixcb_c2,&&_ixcb_c3,&&_ixcb_c4,&&_ixcb_c5,&&_ixcb_c6,&&_ixcb_c7,
+    &&_ixcb_c8,&&_ixcb_c9,&&_ixcb_ca,&&_ixcb_cb,&&_ixcb_cc,&&_ixcb_cd,&&_ixcb_ce,&&_ixcb_cf,
+    &&_ixcb_d0,&&_ixcb_d1,&&_ixcb_d2,&&_ixcb_d3,&&_ixcb_d4,&&_ixcb_d5,&&_ixcb_d6,&&_ixcb_d7,
+    &&_ixcb_d8,&&_ixcb_d9,&&_ixcb_da,&&_ixcb_db,&&_ixcb_dc,&&_ixcb_dd,&&_ixcb_de,&&_ixcb_df,
+    &&_ixcb_e0,&&_ixcb_e1,&&_ixcb_e2,&&_ixcb_e3,&&_ixcb_e4,&&_ixcb_e5,&&_ixcb_e6,&&_ixcb_e7,
+    &&_ixcb_e8,&&_ixcb_e9,&&_ixcb_ea,&&_ixcb_eb,&&_ixcb_ec,&&_ixcb_ed,&&_ixcb_ee,&&_ixcb_ef,
+    &&_ixcb_f0,&&_ixcb_f1,&&_ixcb_f2,&&_ixcb_f3,&&_ixcb_f4,&&_ixcb_f5,&&_ixcb_f6,&&_ixcb_f7,
+    &&_ixcb_f8,&&_ixcb_f9,&&_ixcb_fa,&&_ixcb_fb,&&_ixcb_fc,&&_ixcb_fd,&&_ixcb_fe,&&_ixcb_ff,
+  };
+  cpu->trap_id = 0;
+  uint64_t r0 = cpu->bc_de_hl_fa;
+  uint64_t r1 = cpu->wz_ix_iy_sp;
+  uint64_t r2 = cpu->im_ir_pc_bits;
+  uint64_t r3 = cpu->bc_de_hl_fa_;
+  uint64_t ws = _z80_map_regs(r0, r1, r2);
+  uint64_t map_bits = r2 & _BITS_MAP_REGS;
+  uint64_t pins = cpu->pins;
+  const z80_tick_t tick = cpu->tick_cb;
+  const z80_trap_t trap = cpu->trap_cb;
+  void* ud = cpu->user_data;
+  uint32_t ticks = 0;
+  uint8_t op, d8;
+  uint16_t addr, d16;
+  int8_t d = 0;
+  uint16_t pc = _G_PC();
+  uint64_t pre_pins = pins;
+  /* z80_exec() may have returned right after a DD/FD prefix */
+  _FETCH(op);
+  if (map_bits) {
+    goto *_z80_ix[op];
+  }
+  goto *_z80_op[op];
+
+#undef _IDX
+#define _IDX() (0)
+  /* unprefixed ops */
+  _op_00:/*NOP*/{ }_Z80_NEXT();
+  _op_01:/*LD BC,nn*/{_IMM16(d16);_S_BC(d16);}_Z80_NEXT();
+  _op_02:/*LD (BC),A*/{addr=_G_BC();d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT();
+  _op_03:/*INC BC*/{_T(2);_S_BC(_G_BC()+1);}_Z80_NEXT();
+  _op_04:/*INC B*/{d8=_G_B();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_B(d8);}_Z80_NEXT();
+  _op_05:/*DEC B*/{d8=_G_B();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_B(d8);}_Z80_NEXT();
+  _op_06:/*LD B,n*/{_IMM8(d8);_S_B(d8);}_Z80_NEXT();
+  _op_07:/*RLCA*/{ws=_z80_rlca(ws);}_Z80_NEXT();
+  _op_08:/*EX AF,AF'*/{{r0=_z80_flush_r0(ws,r0,r2);uint16_t fa=_G16(r0,_FA);uint16_t fa_=_G16(r3,_FA);_S16(r0,_FA,fa_);_S16(r3,_FA,fa);ws=_z80_map_regs(r0,r1,r2);}}_Z80_NEXT();
+  _op_09:/*ADD HL,BC*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_BC();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT();
+  _op_0a:/*LD A,(BC)*/{addr=_G_BC();_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT();
+  _op_0b:/*DEC BC*/{_T(2);_S_BC(_G_BC()-1);}_Z80_NEXT();
+  _op_0c:/*INC C*/{d8=_G_C();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_C(d8);}_Z80_NEXT();
+  _op_0d:/*DEC C*/{d8=_G_C();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_C(d8);}_Z80_NEXT();
+  _op_0e:/*LD C,n*/{_IMM8(d8);_S_C(d8);}_Z80_NEXT();
+  _op_0f:/*RRCA*/{ws=_z80_rrca(ws);}_Z80_NEXT();
+  _op_10:/*DJNZ*/{{_T(1);int8_t d;_IMM8(d);d8=_G_B()-1;_S_B(d8);if(d8>0){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT();
+  _op_11:/*LD DE,nn*/{_IMM16(d16);_S_DE(d16);}_Z80_NEXT();
+  _op_12:/*LD (DE),A*/{addr=_G_DE();d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT();
+  _op_13:/*INC DE*/{_T(2);_S_DE(_G_DE()+1);}_Z80_NEXT();
+  _op_14:/*INC D*/{d8=_G_D();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_D(d8);}_Z80_NEXT();
+  _op_15:/*DEC D*/{d8=_G_D();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_D(d8);}_Z80_NEXT();
+  _op_16:/*LD D,n*/{_IMM8(d8);_S_D(d8);}_Z80_NEXT();
+  _op_17:/*RLA*/{ws=_z80_rla(ws);}_Z80_NEXT();
+  _op_18:/*JR d*/{{int8_t d;_IMM8(d);pc+=d;_S_WZ(pc);_T(5);}}_Z80_NEXT();
+  _op_19:/*ADD HL,DE*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_DE();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT();
+  _op_1a:/*LD A,(DE)*/{addr=_G_DE();_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT();
+  _op_1b:/*DEC DE*/{_T(2);_S_DE(_G_DE()-1);}_Z80_NEXT();
+  _op_1c:/*INC E*/{d8=_G_E();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_E(d8);}_Z80_NEXT();
+  _op_1d:/*DEC E*/{d8=_G_E();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_E(d8);}_Z80_NEXT();
+  _op_1e:/*LD E,n*/{_IMM8(d8);_S_E(d8);}_Z80_NEXT();
+  _op_1f:/*RRA*/{ws=_z80_rra(ws);}_Z80_NEXT();
+  _op_20:/*JR NZ,d*/{{int8_t d;_IMM8(d);if(!(_G_F()&Z80_ZF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT();
+  _op_21:/*LD HL,nn*/{_IMM16(d16);_S_HL(d16);}_Z80_NEXT();
+  _op_22:/*LD (nn),HL*/{_IMM16(addr);_MW(addr++,_G_L());_MW(addr,_G_H());_S_WZ(addr);}_Z80_NEXT();
+  _op_23:/*INC HL*/{_T(2);_S_HL(_G_HL()+1);}_Z80_NEXT();
+  _op_24:/*INC H*/{d8=_G_H();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_H(d8);}_Z80_NEXT();
+  _op_25:/*DEC H*/{d8=_G_H();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_H(d8);}_Z80_NEXT();
+  _op_26:/*LD H,n*/{_IMM8(d8);_S_H(d8);}_Z80_NEXT();
+  _op_27:/*DAA*/{ws=_z80_daa(ws);}_Z80_NEXT();
+  _op_28:/*JR Z,d*/{{int8_t d;_IMM8(d);if((_G_F()&Z80_ZF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT();
+  _op_29:/*ADD HL,HL*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_HL();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT();
+  _op_2a:/*LD HL,(nn)*/{_IMM16(addr);_MR(addr++,d8);_S_L(d8);_MR(addr,d8);_S_H(d8);_S_WZ(addr);}_Z80_NEXT();
+  _op_2b:/*DEC HL*/{_T(2);_S_HL(_G_HL()-1);}_Z80_NEXT();
+  _op_2c:/*INC L*/{d8=_G_L();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_L(d8);}_Z80_NEXT();
+  _op_2d:/*DEC L*/{d8=_G_L();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_L(d8);}_Z80_NEXT();
+  _op_2e:/*LD L,n*/{_IMM8(d8);_S_L(d8);}_Z80_NEXT();
+  _op_2f:/*CPL*/{ws=_z80_cpl(ws);}_Z80_NEXT();
+  _op_30:/*JR NC,d*/{{int8_t d;_IMM8(d);if(!(_G_F()&Z80_CF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT();
+  _op_31:/*LD SP,nn*/{_IMM16(d16);_S_SP(d16);}_Z80_NEXT();
+  _op_32:/*LD (nn),A*/{_IMM16(addr);d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT();
+  _op_33:/*INC SP*/{_T(2);_S_SP(_G_SP()+1);}_Z80_NEXT();
+  _op_34:/*INC (HL/IX+d/IY+d)*/{_ADDR(addr,5);_T(1);_MR(addr,d8);{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_MW(addr,d8);}_Z80_NEXT();
+  _op_35:/*DEC (HL/IX+d/IY+d)*/{_ADDR(addr,5);_T(1);_MR(addr,d8);{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_MW(addr,d8);}_Z80_NEXT();
+  _op_36:/*LD (HL/IX+d/IY+d),n*/{_ADDR(addr,2);_IMM8(d8);_MW(addr,d8);}_Z80_NEXT();
+  _op_37:/*SCF*/{ws=_z80_scf(ws);}_Z80_NEXT();
+  _op_38:/*JR C,d*/{{int8_t d;_IMM8(d);if((_G_F()&Z80_CF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT();
+  _op_39:/*ADD HL,SP*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_SP();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT();
+  _op_3a:/*LD A,(nn)*/{_IMM16(addr);_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT();
+  _op_3b:/*DEC SP*/{_T(2);_S_SP(_G_SP()-1);}_Z80_NEXT();
+  _op_3c:/*INC A*/{d8=_G_A();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_A(d8);}_Z80_NEXT();
+  _op_3d:/*DEC A*/{d8=_G_A();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_A(d8);}_Z80_NEXT();
+  _op_3e:/*LD A,n*/{_IMM8(d8);_S_A(d8);}_Z80_NEXT();
+  _op_3f:/*CCF*/{ws=_z80_ccf(ws);}_Z80_NEXT();
+  _op_40:/*LD B,B*/{_S_B(_G_B());}_Z80_NEXT();
+  _op_41:/*LD B,C*/{_S_B(_G_C());}_Z80_NEXT();
+  _op_42:/*LD B,D*/{_S_B(_G_D());}_Z80_NEXT();
+  _op_43:/*LD B,E*/{_S_B(_G_E());}_Z80_NEXT();
+  _op_44:/*LD B,H*/{_S_B(_G_H());}_Z80_NEXT();
+  _op_45:/*LD B,L*/{_S_B(_G_L());}_Z80_NEXT();
+  _op_46:/*LD B,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_B(d8);}_Z80_NEXT();
+  _op_47:/*LD B,A*/{_S_B(_G_A());}_Z80_NEXT();
+  _op_48:/*LD C,B*/{_S_C(_G_B());}_Z80_NEXT();
+  _op_49:/*LD C,C*/{_S_C(_G_C());}_Z80_NEXT();
+  _op_4a:/*LD C,D*/{_S_C(_G_D());}_Z80_NEXT();
+  _op_4b:/*LD C,E*/{_S_C(_G_E());}_Z80_NEXT();
+  _op_4c:/*LD C,H*/{_S_C(_G_H());}_Z80_NEXT();
+  _op_4d:/*LD C,L*/{_S_C(_G_L());}_Z80_NEXT();
+  _op_4e:/*LD C,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_C(d8);}_Z80_NEXT();
+  _op_4f:/*LD C,A*/{_S_C(_G_A());}_Z80_NEXT();
+  _op_50:/*LD D,B*/{_S_D(_G_B());}_Z80_NEXT();
+  _op_51:/*LD D,C*/{_S_D(_G_C());}_Z80_NEXT();
+  _op_52:/*LD D,D*/{_S_D(_G_D());}_Z80_NEXT();
+  _op_53:/*LD D,E*/{_S_D(_G_E());}_Z80_NEXT();
+  _op_54:/*LD D,H*/{_S_D(_G_H());}_Z80_NEXT();
+  _op_55:/*LD D,L*/{_S_D(_G_L());}_Z80_NEXT();
+  _op_56:/*LD D,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_D(d8);}_Z80_NEXT();
+  _op_57:/*LD D,A*/{_S_D(_G_A());}_Z80_NEXT();
+  _op_58:/*LD E,B*/{_S_E(_G_B());}_Z80_NEXT();
+  _op_59:/*LD E,C*/{_S_E(_G_C());}_Z80_NEXT();
+  _op_5a:/*LD E,D*/{_S_E(_G_D());}_Z80_NEXT();
+  _op_5b:/*LD E,E*/{_S_E(_G_E());}_Z80_NEXT();
+  _op_5c:/*LD E,H*/{_S_E(_G_H());}_Z80_NEXT();
+  _op_5d:/*LD E,L*/{_S_E(_G_L());}_Z80_NEXT();
+  _op_5e:/*LD E,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_E(d8);}_Z80_NEXT();
+  _op_5f:/*LD E,A*/{_S_E(_G_A());}_Z80_NEXT();
+  _op_60:/*LD H,B*/{_S_H(_G_B());}_Z80_NEXT();
+  _op_61:/*LD H,C*/{_S_H(_G_C());}_Z80_NEXT();
+  _op_62:/*LD H,D*/{_S_H(_G_D());}_Z80_NEXT();
+  _op_63:/*LD H,E*/{_S_H(_G_E());}_Z80_NEXT();
+  _op_64:/*LD H,H*/{_S_H(_G_H());}_Z80_NEXT();
+  _op_65:/*LD H,L*/{_S_H(_G_L());}_Z80_NEXT();
+  _op_66:/*LD H,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);if(_IDX()){_S8(r0,_H,d8);}else{_S_H(d8);}}_Z80_NEXT();
+  _op_67:/*LD H,A*/{_S_H(_G_A());}_Z80_NEXT();
+  _op_68:/*LD L,B*/{_S_L(_G_B());}_Z80_NEXT();
+  _op_69:/*LD L,C*/{_S_L(_G_C());}_Z80_NEXT();
+  _op_6a:/*LD L,D*/{_S_L(_G_D());}_Z80_NEXT();
+  _op_6b:/*LD L,E*/{_S_L(_G_E());}_Z80_NEXT();
+  _op_6c:/*LD L,H*/{_S_L(_G_H());}_Z80_NEXT();
+  _op_6d:/*LD L,L*/{_S_L(_G_L());}_Z80_NEXT();
+  _op_6e:/*LD L,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);if(_IDX()){_S8(r0,_L,d8);}else{_S_L(d8);}}_Z80_NEXT();
+  _op_6f:/*LD L,A*/{_S_L(_G_A());}_Z80_NEXT();
+  _op_70:/*LD (HL/IX+d/IY+d),B*/{d8=_G_B();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_71:/*LD (HL/IX+d/IY+d),C*/{d8=_G_C();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_72:/*LD (HL/IX+d/IY+d),D*/{d8=_G_D();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_73:/*LD (HL/IX+d/IY+d),E*/{d8=_G_E();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_74:/*LD (HL/IX+d/IY+d),H*/{d8=_IDX()?_G8(r0,_H):_G_H();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_75:/*LD (HL/IX+d/IY+d),L*/{d8=_IDX()?_G8(r0,_L):_G_L();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_76:/*HALT*/{pins|=Z80_HALT;pc--;}_Z80_NEXT();
+  _op_77:/*LD (HL/IX+d/IY+d),A*/{d8=_G_A();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT();
+  _op_78:/*LD A,B*/{_S_A(_G_B());}_Z80_NEXT();
+  _op_79:/*LD A,C*/{_S_A(_G_C());}_Z80_NEXT();
+  _op_7a:/*LD A,D*/{_S_A(_G_D());}_Z80_NEXT();
+  _op_7b:/*LD A,E*/{_S_A(_G_E());}_Z80_NEXT();
+  _op_7c:/*LD A,H*/{_S_A(_G_H());}_Z80_NEXT();
+  _op_7d:/*LD A,L*/{_S_A(_G_L());}_Z80_NEXT();
+  _op_7e:/*LD A,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_A(d8);}_Z80_NEXT();
+  _op_7f:/*LD A,A*/{_S_A(_G_A());}_Z80_NEXT();
+  _op_80:/*ADD B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_81:/*ADD C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_82:/*ADD D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_83:/*ADD E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_84:/*ADD H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_85:/*ADD L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_86:/*ADD,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_87:/*ADD A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_88:/*ADC B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_89:/*ADC C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8a:/*ADC D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8b:/*ADC E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8c:/*ADC H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8d:/*ADC L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8e:/*ADC,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_8f:/*ADC A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_90:/*SUB B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_91:/*SUB C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_92:/*SUB D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_93:/*SUB E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_94:/*SUB H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_95:/*SUB L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_96:/*SUB,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_97:/*SUB A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_98:/*SBC B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_99:/*SBC C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9a:/*SBC D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9b:/*SBC E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9c:/*SBC H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9d:/*SBC L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9e:/*SBC,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_9f:/*SBC A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_a0:/*AND B*/{d8=_G_B();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a1:/*AND C*/{d8=_G_C();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a2:/*AND D*/{d8=_G_D();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a3:/*AND E*/{d8=_G_E();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a4:/*AND H*/{d8=_G_H();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a5:/*AND L*/{d8=_G_L();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a6:/*AND,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a7:/*AND A*/{d8=_G_A();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_a8:/*XOR B*/{d8=_G_B();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_a9:/*XOR C*/{d8=_G_C();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_aa:/*XOR D*/{d8=_G_D();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_ab:/*XOR E*/{d8=_G_E();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_ac:/*XOR H*/{d8=_G_H();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_ad:/*XOR L*/{d8=_G_L();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_ae:/*XOR,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_af:/*XOR A*/{d8=_G_A();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b0:/*OR B*/{d8=_G_B();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b1:/*OR C*/{d8=_G_C();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b2:/*OR D*/{d8=_G_D();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b3:/*OR E*/{d8=_G_E();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b4:/*OR H*/{d8=_G_H();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b5:/*OR L*/{d8=_G_L();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b6:/*OR,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b7:/*OR A*/{d8=_G_A();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_b8:/*CP B*/{d8=_G_B();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_b9:/*CP C*/{d8=_G_C();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_ba:/*CP D*/{d8=_G_D();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_bb:/*CP E*/{d8=_G_E();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_bc:/*CP H*/{d8=_G_H();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_bd:/*CP L*/{d8=_G_L();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_be:/*CP,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_bf:/*CP A*/{d8=_G_A();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_c0:/*RET NZ*/{_T(1);if (!(_G_F()&Z80_ZF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_c1:/*POP BC*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_BC(d16);_S_SP(addr);}_Z80_NEXT();
+  _op_c2:/*JP NZ,nn*/{_IMM16(addr);if(!(_G_F()&Z80_ZF)){pc=addr;}}_Z80_NEXT();
+  _op_c3:/*JP nn*/{_IMM16(pc);}_Z80_NEXT();
+  _op_c4:/*CALL NZ,nn*/{_IMM16(addr);if(!(_G_F()&Z80_ZF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_c5:/*PUSH BC*/{_T(1);addr=_G_SP();d16=_G_BC();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT();
+  _op_c6:/*ADD n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_c7:/*RST 0x0*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x0;_S_WZ(pc);}_Z80_NEXT();
+  _op_c8:/*RET Z*/{_T(1);if ((_G_F()&Z80_ZF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_c9:/*RET*/{d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);}_Z80_NEXT();
+  _op_ca:/*JP Z,nn*/{_IMM16(addr);if((_G_F()&Z80_ZF)){pc=addr;}}_Z80_NEXT();
+  _op_cc:/*CALL Z,nn*/{_IMM16(addr);if((_G_F()&Z80_ZF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_cd:/*CALL nn*/{_IMM16(addr);_T(1);d16=_G_SP();_MW(--d16,pc>>8);_MW(--d16,pc);_S_SP(d16);pc=addr;}_Z80_NEXT();
+  _op_ce:/*ADC n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_cf:/*RST 0x8*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x8;_S_WZ(pc);}_Z80_NEXT();
+  _op_d0:/*RET NC*/{_T(1);if (!(_G_F()&Z80_CF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_d1:/*POP DE*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_DE(d16);_S_SP(addr);}_Z80_NEXT();
+  _op_d2:/*JP NC,nn*/{_IMM16(addr);if(!(_G_F()&Z80_CF)){pc=addr;}}_Z80_NEXT();
+  _op_d3:/*OUT (n),A*/{{_IMM8(d8);uint8_t a=_G_A();addr=(a<<8)|d8;_OUT(addr,a);_S_WZ((addr&0xFF00)|((addr+1)&0x00FF));}}_Z80_NEXT();
+  _op_d4:/*CALL NC,nn*/{_IMM16(addr);if(!(_G_F()&Z80_CF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_d5:/*PUSH DE*/{_T(1);addr=_G_SP();d16=_G_DE();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT();
+  _op_d6:/*SUB n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_d7:/*RST 0x10*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x10;_S_WZ(pc);}_Z80_NEXT();
+  _op_d8:/*RET C*/{_T(1);if ((_G_F()&Z80_CF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_d9:/*EXX*/{{r0=_z80_flush_r0(ws,r0,r2);const uint64_t rx=r3;r3=(r3&0xffff)|(r0&0xffffffffffff0000);r0=(r0&0xffff)|(rx&0xffffffffffff0000);ws=_z80_map_regs(r0, r1, r2);}}_Z80_NEXT();
+  _op_da:/*JP C,nn*/{_IMM16(addr);if((_G_F()&Z80_CF)){pc=addr;}}_Z80_NEXT();
+  _op_db:/*IN A,(n)*/{{_IMM8(d8);uint8_t a=_G_A();addr=(a<<8)|d8;_IN(addr++,a);_S_A(a);_S_WZ(addr);}}_Z80_NEXT();
+  _op_dc:/*CALL C,nn*/{_IMM16(addr);if((_G_F()&Z80_CF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_de:/*SBC n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _op_df:/*RST 0x18*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x18;_S_WZ(pc);}_Z80_NEXT();
+  _op_e0:/*RET PO*/{_T(1);if (!(_G_F()&Z80_PF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_e1:/*POP HL*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_HL(d16);_S_SP(addr);}_Z80_NEXT();
+  _op_e2:/*JP PO,nn*/{_IMM16(addr);if(!(_G_F()&Z80_PF)){pc=addr;}}_Z80_NEXT();
+  _op_e3:/*EX (SP),HL*/{{_T(3);addr=_G_SP();d16=_G_HL();uint8_t l,h;_MR(addr,l);_MR(addr+1,h);_MW(addr,d16);_MW(addr+1,d16>>8);d16=(h<<8)|l;_S_HL(d16);_S_WZ(d16);}}_Z80_NEXT();
+  _op_e4:/*CALL PO,nn*/{_IMM16(addr);if(!(_G_F()&Z80_PF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_e5:/*PUSH HL*/{_T(1);addr=_G_SP();d16=_G_HL();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT();
+  _op_e6:/*AND n*/{_IMM8(d8);{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT();
+  _op_e7:/*RST 0x20*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x20;_S_WZ(pc);}_Z80_NEXT();
+  _op_e8:/*RET PE*/{_T(1);if ((_G_F()&Z80_PF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_e9:/*JP HL*/{pc=_G_HL();}_Z80_NEXT();
+  _op_ea:/*JP PE,nn*/{_IMM16(addr);if((_G_F()&Z80_PF)){pc=addr;}}_Z80_NEXT();
+  _op_eb:/*EX DE,HL*/{{r0=_z80_flush_r0(ws,r0,r2);uint16_t de=_G16(r0,_DE);uint16_t hl=_G16(r0,_HL);_S16(r0,_DE,hl);_S16(r0,_HL,de);ws=_z80_map_regs(r0,r1,r2);}}_Z80_NEXT();
+  _op_ec:/*CALL PE,nn*/{_IMM16(addr);if((_G_F()&Z80_PF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_ee:/*XOR n*/{_IMM8(d8);{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_ef:/*RST 0x28*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x28;_S_WZ(pc);}_Z80_NEXT();
+  _op_f0:/*RET P*/{_T(1);if (!(_G_F()&Z80_SF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_f1:/*POP FA*/{addr=_G_SP();_MR(addr++,d8);d16=d8<<8;_MR(addr++,d8);d16|=d8;_S_FA(d16);_S_SP(addr);}_Z80_NEXT();
+  _op_f2:/*JP P,nn*/{_IMM16(addr);if(!(_G_F()&Z80_SF)){pc=addr;}}_Z80_NEXT();
+  _op_f3:/*DI*/{r2&=~(_BIT_IFF1|_BIT_IFF2);}_Z80_NEXT();
+  _op_f4:/*CALL P,nn*/{_IMM16(addr);if(!(_G_F()&Z80_SF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_f5:/*PUSH FA*/{_T(1);addr=_G_SP();d16=_G_FA();_MW(--addr,d16);_MW(--addr,d16>>8);_S_SP(addr);}_Z80_NEXT();
+  _op_f6:/*OR n*/{_IMM8(d8);{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT();
+  _op_f7:/*RST 0x30*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x30;_S_WZ(pc);}_Z80_NEXT();
+  _op_f8:/*RET M*/{_T(1);if ((_G_F()&Z80_SF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT();
+  _op_f9:/*LD SP,HL*/{_T(2);_S_SP(_G_HL());}_Z80_NEXT();
+  _op_fa:/*JP M,nn*/{_IMM16(addr);if((_G_F()&Z80_SF)){pc=addr;}}_Z80_NEXT();
+  _op_fb:/*EI*/{r2=(r2&~(_BIT_IFF1|_BIT_IFF2))|_BIT_EI;}_Z80_NEXT();
+  _op_fc:/*CALL M,nn*/{_IMM16(addr);if((_G_F()&Z80_SF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT();
+  _op_fe:/*CP n*/{_IMM8(d8);{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT();
+  _op_ff:/*RST 0x38*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x38;_S_WZ(pc);}_Z80_NEXT();
+  _op_cb:
+    _FETCH_CB(op);
+    goto *_z80_cb[op];
+  _op_ed:
+    _FETCH(op);
+    goto *_z80_ed[op];
+  _op_dd:
+    map_bits |= _BIT_USE_IX;
+    goto _z80_prefix;
+  _op_fd:
+    map_bits |= _BIT_USE_IY;
+    goto _z80_prefix;
+  _z80_prefix:
+    /* like the switch decoder, may return after the prefix byte */
+    if (ticks >= num_ticks) {
+      goto _z80_exit;
+    }
+    _FETCH(op);
+    if (map_bits != (r2 & _BITS_MAP_REGS)) {
+      const uint64_t old_map_bits = r2 & _BITS_MAP_REGS;
+      r0 = _z80_flush_r0(ws, r0, old_map_bits);
+      r1 = _z80_flush_r1(ws, r1, old_map_bits);
+      r2 = (r2 & ~_BITS_MAP_REGS) | map_bits;
+      ws = _z80_map_regs(r0, r1, r2);
+    }
+    goto *_z80_ix[op];
+  /* ED ops */
+  _ed_40:/*IN B,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_B(d8);}}_Z80_NEXT();
+  _ed_41:/*OUT (C),B*/{addr=_G_BC();_OUT(addr++,_G_B());_S_WZ(addr);}_Z80_NEXT();
+  _ed_42:/*SBC HL,BC*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_BC();uint32_t r=acc-d16-(_G_F()&Z80_CF);uint8_t f=Z80_NF|(((d16^acc)&(acc^r)&0x8000)>>13);_S_HL(r);f|=((acc^r^d16)>>8) & Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_43:/*LD (nn),BC*/{_IMM16(addr);d16=_G_BC();_MW(addr++,d16&0xFF);_MW(addr,d16>>8);_S_WZ(addr);}_Z80_NEXT();
+  _ed_44:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_45:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_46:/*IM 0*/{_S_IM(0);}_Z80_NEXT();
+  _ed_47:/*LD I,A*/{_T(1);_S_I(_G_A());}_Z80_NEXT();
+  _ed_48:/*IN C,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_C(d8);}}_Z80_NEXT();
+  _ed_49:/*OUT (C),C*/{addr=_G_BC();_OUT(addr++,_G_C());_S_WZ(addr);}_Z80_NEXT();
+  _ed_4a:/*ADC HL,BC*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_BC();uint32_t r=acc+d16+(_G_F()&Z80_CF);_S_HL(r);uint8_t f=((d16^acc^0x8000)&(d16^r)&0x8000)>>13;f|=((acc^r^d16)>>8)&Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_4b:/*LD BC,(nn)*/{_IMM16(addr);_MR(addr++,d8);d16=d8;_MR(addr,d8);d16|=d8<<8;_S_BC(d16);_S_WZ(addr);}_Z80_NEXT();
+  _ed_4c:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_4d:/*RETI*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_4e:/*IM 0*/{_S_IM(0);}_Z80_NEXT();
+  _ed_4f:/*LD R,A*/{_T(1);_S_R(_G_A());}_Z80_NEXT();
+  _ed_50:/*IN D,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_D(d8);}}_Z80_NEXT();
+  _ed_51:/*OUT (C),D*/{addr=_G_BC();_OUT(addr++,_G_D());_S_WZ(addr);}_Z80_NEXT();
+  _ed_52:/*SBC HL,DE*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_DE();uint32_t r=acc-d16-(_G_F()&Z80_CF);uint8_t f=Z80_NF|(((d16^acc)&(acc^r)&0x8000)>>13);_S_HL(r);f|=((acc^r^d16)>>8) & Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_53:/*LD (nn),DE*/{_IMM16(addr);d16=_G_DE();_MW(addr++,d16&0xFF);_MW(addr,d16>>8);_S_WZ(addr);}_Z80_NEXT();
+  _ed_54:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_55:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_56:/*IM 1*/{_S_IM(1);}_Z80_NEXT();
+  _ed_57:/*LD A,I*/{_T(1);d8=_G_I();_S_A(d8);_S_F(_SZIFF2_FLAGS(d8));}_Z80_NEXT();
+  _ed_58:/*IN E,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_E(d8);}}_Z80_NEXT();
+  _ed_59:/*OUT (C),E*/{addr=_G_BC();_OUT(addr++,_G_E());_S_WZ(addr);}_Z80_NEXT();
+  _ed_5a:/*ADC HL,DE*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_DE();uint32_t r=acc+d16+(_G_F()&Z80_CF);_S_HL(r);uint8_t f=((d16^acc^0x8000)&(d16^r)&0x8000)>>13;f|=((acc^r^d16)>>8)&Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_5b:/*LD DE,(nn)*/{_IMM16(addr);_MR(addr++,d8);d16=d8;_MR(addr,d8);d16|=d8<<8;_S_DE(d16);_S_WZ(addr);}_Z80_NEXT();
+  _ed_5c:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_5d:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_5e:/*IM 2*/{_S_IM(2);}_Z80_NEXT();
+  _ed_5f:/*LD A,R*/{_T(1);d8=_G_R();_S_A(d8);_S_F(_SZIFF2_FLAGS(d8));}_Z80_NEXT();
+  _ed_60:/*IN H,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_H(d8);}}_Z80_NEXT();
+  _ed_61:/*OUT (C),H*/{addr=_G_BC();_OUT(addr++,_G_H());_S_WZ(addr);}_Z80_NEXT();
+  _ed_62:/*SBC HL,HL*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_HL();uint32_t r=acc-d16-(_G_F()&Z80_CF);uint8_t f=Z80_NF|(((d16^acc)&(acc^r)&0x8000)>>13);_S_HL(r);f|=((acc^r^d16)>>8) & Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_63:/*LD (nn),HL*/{_IMM16(addr);d16=_G_HL();_MW(addr++,d16&0xFF);_MW(addr,d16>>8);_S_WZ(addr);}_Z80_NEXT();
+  _ed_64:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_65:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_66:/*IM 0*/{_S_IM(0);}_Z80_NEXT();
+  _ed_67:/*RRD*/{{addr=_G_HL();uint8_t a=_G_A();_MR(addr,d8);uint8_t l=a&0x0F;a=(a&0xF0)|(d8&0x0F);_S_A(a);d8=(d8>>4)|(l<<4);_MW(addr++,d8);_S_WZ(addr);_S_F((_G_F()&Z80_CF)|_z80_szp[a]);_T(4);}}_Z80_NEXT();
+  _ed_68:/*IN L,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_L(d8);}}_Z80_NEXT();
+  _ed_69:/*OUT (C),L*/{addr=_G_BC();_OUT(addr++,_G_L());_S_WZ(addr);}_Z80_NEXT();
+  _ed_6a:/*ADC HL,HL*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_HL();uint32_t r=acc+d16+(_G_F()&Z80_CF);_S_HL(r);uint8_t f=((d16^acc^0x8000)&(d16^r)&0x8000)>>13;f|=((acc^r^d16)>>8)&Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_6b:/*LD HL,(nn)*/{_IMM16(addr);_MR(addr++,d8);d16=d8;_MR(addr,d8);d16|=d8<<8;_S_HL(d16);_S_WZ(addr);}_Z80_NEXT();
+  _ed_6c:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_6d:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_6e:/*IM 0*/{_S_IM(0);}_Z80_NEXT();
+  _ed_6f:/*RLD*/{{addr=_G_HL();uint8_t a=_G_A();_MR(addr,d8);uint8_t l=a&0x0F;a=(a&0xF0)|(d8>>4);_S_A(a);d8=(d8<<4)|l;_MW(addr++,d8);_S_WZ(addr);_S_F((_G_F()&Z80_CF)|_z80_szp[a]);_T(4);}}_Z80_NEXT();
+  _ed_70:/*IN HL,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);}}_Z80_NEXT();
+  _ed_71:/*OUT (C),HL*/{addr=_G_BC();_OUT(addr++,0);_S_WZ(addr);}_Z80_NEXT();
+  _ed_72:/*SBC HL,SP*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_SP();uint32_t r=acc-d16-(_G_F()&Z80_CF);uint8_t f=Z80_NF|(((d16^acc)&(acc^r)&0x8000)>>13);_S_HL(r);f|=((acc^r^d16)>>8) & Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_73:/*LD (nn),SP*/{_IMM16(addr);d16=_G_SP();_MW(addr++,d16&0xFF);_MW(addr,d16>>8);_S_WZ(addr);}_Z80_NEXT();
+  _ed_74:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_75:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_76:/*IM 1*/{_S_IM(1);}_Z80_NEXT();
+  _ed_77:/*NOP (ED)*/{ }_Z80_NEXT();
+  _ed_78:/*IN A,(C)*/{{addr=_G_BC();_IN(addr++,d8);_S_WZ(addr);uint8_t f=(_G_F()&Z80_CF)|_z80_szp[d8];_S8(ws,_F,f);_S_A(d8);}}_Z80_NEXT();
+  _ed_79:/*OUT (C),A*/{addr=_G_BC();_OUT(addr++,_G_A());_S_WZ(addr);}_Z80_NEXT();
+  _ed_7a:/*ADC HL,SP*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_SP();uint32_t r=acc+d16+(_G_F()&Z80_CF);_S_HL(r);uint8_t f=((d16^acc^0x8000)&(d16^r)&0x8000)>>13;f|=((acc^r^d16)>>8)&Z80_HF;f|=(r>>16)&Z80_CF;f|=(r>>8)&(Z80_SF|Z80_YF|Z80_XF);f|=(r&0xFFFF)?0:Z80_ZF;_S_F(f);_T(7);}}_Z80_NEXT();
+  _ed_7b:/*LD SP,(nn)*/{_IMM16(addr);_MR(addr++,d8);d16=d8;_MR(addr,d8);d16|=d8<<8;_S_SP(d16);_S_WZ(addr);}_Z80_NEXT();
+  _ed_7c:/*NEG*/{d8=_G_A();_S_A(0);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT();
+  _ed_7d:/*RETN*/{pins|=Z80_RETI;d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);if (r2&_BIT_IFF2){r2|=_BIT_IFF1;}else{r2&=~_BIT_IFF1;}}_Z80_NEXT();
+  _ed_7e:/*IM 2*/{_S_IM(2);}_Z80_NEXT();
+  _ed_7f:/*NOP (ED)*/{ }_Z80_NEXT();
+  _ed_a0:/*LDI*/{{uint16_t hl=_G_HL();uint16_t de=_G_DE();_MR(hl,d8);_MW(de,d8);hl++;de++;_S_HL(hl);_S_DE(de);_T(2);d8+=_G_A();uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_CF);if(d8&0x02){f|=Z80_YF;}if(d8&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S_F(f);}}_Z80_NEXT();
+  _ed_a1:/*CPI*/{{uint16_t hl = _G_HL();_MR(hl,d8);uint16_t wz = _G_WZ();hl++;wz++;_S_WZ(wz);_S_HL(hl);_T(5);int r=((int)_G_A())-d8;uint8_t f=(_G_F()&Z80_CF)|Z80_NF|_SZ(r);if((r&0x0F)>(_G_A()&0x0F)){f|=Z80_HF;r--;}if(r&0x02){f|=Z80_YF;}if(r&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S8(ws,_F,f);}}_Z80_NEXT();
+  _ed_a2:/*INI*/{{_T(1);addr=_G_BC();uint16_t hl=_G_HL();_IN(addr,d8);_MW(hl,d8);uint8_t b=_G_B();uint8_t c=_G_C();b--;addr++;hl++;c++;_S_B(b);_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)(c&0xFF)+d8;if(t&0x100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);}}_Z80_NEXT();
+  _ed_a3:/*OUTI*/{{_T(1);uint16_t hl=_G_HL();_MR(hl,d8);uint8_t b=_G_B();b--;_S_B(b);addr=_G_BC();_OUT(addr,d8);addr++; hl++;_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)_G_L()+(uint32_t)d8;if (t&0x0100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);}}_Z80_NEXT();
+  _ed_a8:/*LDD*/{{uint16_t hl=_G_HL();uint16_t de=_G_DE();_MR(hl,d8);_MW(de,d8);hl--;de--;_S_HL(hl);_S_DE(de);_T(2);d8+=_G_A();uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_CF);if(d8&0x02){f|=Z80_YF;}if(d8&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S_F(f);}}_Z80_NEXT();
+  _ed_a9:/*CPD*/{{uint16_t hl = _G_HL();_MR(hl,d8);uint16_t wz = _G_WZ();hl--;wz--;_S_WZ(wz);_S_HL(hl);_T(5);int r=((int)_G_A())-d8;uint8_t f=(_G_F()&Z80_CF)|Z80_NF|_SZ(r);if((r&0x0F)>(_G_A()&0x0F)){f|=Z80_HF;r--;}if(r&0x02){f|=Z80_YF;}if(r&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S8(ws,_F,f);}}_Z80_NEXT();
+  _ed_aa:/*IND*/{{_T(1);addr=_G_BC();uint16_t hl=_G_HL();_IN(addr,d8);_MW(hl,d8);uint8_t b=_G_B();uint8_t c=_G_C();b--;addr--;hl--;c--;_S_B(b);_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)(c&0xFF)+d8;if(t&0x100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);}}_Z80_NEXT();
+  _ed_ab:/*OUTD*/{{_T(1);uint16_t hl=_G_HL();_MR(hl,d8);uint8_t b=_G_B();b--;_S_B(b);addr=_G_BC();_OUT(addr,d8);addr--;hl--;_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)_G_L()+(uint32_t)d8;if (t&0x0100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);}}_Z80_NEXT();
+  _ed_b0:/*LDIR*/{{uint16_t hl=_G_HL();uint16_t de=_G_DE();_MR(hl,d8);_MW(de,d8);hl++;de++;_S_HL(hl);_S_DE(de);_T(2);d8+=_G_A();uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_CF);if(d8&0x02){f|=Z80_YF;}if(d8&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S_F(f);if(bc){pc-=2;_S_WZ(pc+1);_T(5);}}}_Z80_NEXT();
+  _ed_b1:/*CPIR*/{{uint16_t hl = _G_HL();_MR(hl,d8);uint16_t wz = _G_WZ();hl++;wz++;_S_WZ(wz);_S_HL(hl);_T(5);int r=((int)_G_A())-d8;uint8_t f=(_G_F()&Z80_CF)|Z80_NF|_SZ(r);if((r&0x0F)>(_G_A()&0x0F)){f|=Z80_HF;r--;}if(r&0x02){f|=Z80_YF;}if(r&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S8(ws,_F,f);if(bc&&!(f&Z80_ZF)){pc-=2;_S_WZ(pc+1);_T(5);}}}_Z80_NEXT();
+  _ed_b2:/*INIR*/{{_T(1);addr=_G_BC();uint16_t hl=_G_HL();_IN(addr,d8);_MW(hl,d8);uint8_t b=_G_B();uint8_t c=_G_C();b--;addr++;hl++;c++;_S_B(b);_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)(c&0xFF)+d8;if(t&0x100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);if(b){pc-=2;_T(5);}}}_Z80_NEXT();
+  _ed_b3:/*OTIR*/{{_T(1);uint16_t hl=_G_HL();_MR(hl,d8);uint8_t b=_G_B();b--;_S_B(b);addr=_G_BC();_OUT(addr,d8);addr++; hl++;_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)_G_L()+(uint32_t)d8;if (t&0x0100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);if(b){pc-=2;_T(5);}}}_Z80_NEXT();
+  _ed_b8:/*LDDR*/{{uint16_t hl=_G_HL();uint16_t de=_G_DE();_MR(hl,d8);_MW(de,d8);hl--;de--;_S_HL(hl);_S_DE(de);_T(2);d8+=_G_A();uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_CF);if(d8&0x02){f|=Z80_YF;}if(d8&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S_F(f);if(bc){pc-=2;_S_WZ(pc+1);_T(5);}}}_Z80_NEXT();
+  _ed_b9:/*CPDR*/{{uint16_t hl = _G_HL();_MR(hl,d8);uint16_t wz = _G_WZ();hl--;wz--;_S_WZ(wz);_S_HL(hl);_T(5);int r=((int)_G_A())-d8;uint8_t f=(_G_F()&Z80_CF)|Z80_NF|_SZ(r);if((r&0x0F)>(_G_A()&0x0F)){f|=Z80_HF;r--;}if(r&0x02){f|=Z80_YF;}if(r&0x08){f|=Z80_XF;}uint16_t bc=_G_BC();bc--;_S_BC(bc);if(bc){f|=Z80_VF;}_S8(ws,_F,f);if(bc&&!(f&Z80_ZF)){pc-=2;_S_WZ(pc+1);_T(5);}}}_Z80_NEXT();
+  _ed_ba:/*INDR*/{{_T(1);addr=_G_BC();uint16_t hl=_G_HL();_IN(addr,d8);_MW(hl,d8);uint8_t b=_G_B();uint8_t c=_G_C();b--;addr--;hl--;c--;_S_B(b);_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)(c&0xFF)+d8;if(t&0x100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);if(b){pc-=2;_T(5);}}}_Z80_NEXT();
+  _ed_bb:/*OTDR*/{{_T(1);uint16_t hl=_G_HL();_MR(hl,d8);uint8_t b=_G_B();b--;_S_B(b);addr=_G_BC();_OUT(addr,d8);addr--;hl--;_S_HL(hl);_S_WZ(addr);uint8_t f=(b?(b&Z80_SF):Z80_ZF)|(b&(Z80_XF|Z80_YF));if(d8&Z80_SF){f|=Z80_NF;}uint32_t t=(uint32_t)_G_L()+(uint32_t)d8;if (t&0x0100){f|=Z80_HF|Z80_CF;}f|=_z80_szp[((uint8_t)(t&0x07))^b]&Z80_PF;_S_F(f);if(b){pc-=2;_T(5);}}}_Z80_NEXT();
+  _ed_nop:/*NOP (ED)*/_Z80_NEXT();
+  /* CB ops */
+  _cb_00:_Z80_CB(0,0,0);_Z80_NEXT();
+  _cb_01:_Z80_CB(0,0,1);_Z80_NEXT();
+  _cb_02:_Z80_CB(0,0,2);_Z80_NEXT();
+  _cb_03:_Z80_CB(0,0,3);_Z80_NEXT();
+  _cb_04:_Z80_CB(0,0,4);_Z80_NEXT();
+  _cb_05:_Z80_CB(0,0,5);_Z80_NEXT();
+  _cb_06:_Z80_CB(0,0,6);_Z80_NEXT();
+  _cb_07:_Z80_CB(0,0,7);_Z80_NEXT();
+  _cb_08:_Z80_CB(0,1,0);_Z80_NEXT();
+  _cb_09:_Z80_CB(0,1,1);_Z80_NEXT();
+  _cb_0a:_Z80_CB(0,1,2);_Z80_NEXT();
+  _cb_0b:_Z80_CB(0,1,3);_Z80_NEXT();
+  _cb_0c:_Z80_CB(0,1,4);_Z80_NEXT();
+  _cb_0d:_Z80_CB(0,1,5);_Z80_NEXT();
+  _cb_0e:_Z80_CB(0,1,6);_Z80_NEXT();
+  _cb_0f:_Z80_CB(0,1,7);_Z80_NEXT();
+  _cb_10:_Z80_CB(0,2,0);_Z80_NEXT();
+  _cb_11:_Z80_CB(0,2,1);_Z80_NEXT();
+  _cb_12:_Z80_CB(0,2,2);_Z80_NEXT();
+  _cb_13:_Z80_CB(0,2,3);_Z80_NEXT();
+  _cb_14:_Z80_CB(0,2,4);_Z80_NEXT();
+  _cb_15:_Z80_CB(0,2,5);_Z80_NEXT();
+  _cb_16:_Z80_CB(0,2,6);_Z80_NEXT();
+  _cb_17:_Z80_CB(0,2,7);_Z80_NEXT();
+  _cb_18:_Z80_CB(0,3,0);_Z80_NEXT();
+  _cb_19:_Z80_CB(0,3,1);_Z80_NEXT();
+  _cb_1a:_Z80_CB(0,3,2);_Z80_NEXT();
+  _cb_1b:_Z80_CB(0,3,3);_Z80_NEXT();
+  _cb_1c:_Z80_CB(0,3,4);_Z80_NEXT();
+  _cb_1d:_Z80_CB(0,3,5);_Z80_NEXT();
+  _cb_1e:_Z80_CB(0,3,6);_Z80_NEXT();
+  _cb_1f:_Z80_CB(0,3,7);_Z80_NEXT();
+  _cb_20:_Z80_CB(0,4,0);_Z80_NEXT();
+  _cb_21:_Z80_CB(0,4,1);_Z80_NEXT();
+  _cb_22:_Z80_CB(0,4,2);_Z80_NEXT();
+  _cb_23:_Z80_CB(0,4,3);_Z80_NEXT();
+  _cb_24:_Z80_CB(0,4,4);_Z80_NEXT();
+  _cb_25:_Z80_CB(0,4,5);_Z80_NEXT();
+  _cb_26:_Z80_CB(0,4,6);_Z80_NEXT();
+  _cb_27:_Z80_CB(0,4,7);_Z80_NEXT();
+  _cb_28:_Z80_CB(0,5,0);_Z80_NEXT();
+  _cb_29:_Z80_CB(0,5,1);_Z80_NEXT();
+  _cb_2a:_Z80_CB(0,5,2);_Z80_NEXT();
+  _cb_2b:_Z80_CB(0,5,3);_Z80_NEXT();
+  _cb_2c:_Z80_CB(0,5,4);_Z80_NEXT();
+  _cb_2d:_Z80_CB(0,5,5);_Z80_NEXT();
+  _cb_2e:_Z80_CB(0,5,6);_Z80_NEXT();
+  _cb_2f:_Z80_CB(0,5,7);_Z80_NEXT();
+  _cb_30:_Z80_CB(0,6,0);_Z80_NEXT();
+  _cb_31:_Z80_CB(0,6,1);_Z80_NEXT();
+  _cb_32:_Z80_CB(0,6,2);_Z80_NEXT();
+  _cb_33:_Z80_CB(0,6,3);_Z80_NEXT();
+  _cb_34:_Z80_CB(0,6,4);_Z80_NEXT();
+  _cb_35:_Z80_CB(0,6,5);_Z80_NEXT();
+  _cb_36:_Z80_CB(0,6,6);_Z80_NEXT();
+  _cb_37:_Z80_CB(0,6,7);_Z80_NEXT();
+  _cb_38:_Z80_CB(0,7,0);_Z80_NEXT();
+  _cb_39:_Z80_CB(0,7,1);_Z80_NEXT();
+  _cb_3a:_Z80_CB(0,7,2);_Z80_NEXT();
+  _cb_3b:_Z80_CB(0,7,3);_Z80_NEXT();
+  _cb_3c:_Z80_CB(0,7,4);_Z80_NEXT();
+  _cb_3d:_Z80_CB(0,7,5);_Z80_NEXT();
+  _cb_3e:_Z80_CB(0,7,6);_Z80_NEXT();
+  _cb_3f:_Z80_CB(0,7,7);_Z80_NEXT();
+  _cb_40:_Z80_CB(1,0,0);_Z80_NEXT();
+  _cb_41:_Z80_CB(1,0,1);_Z80_NEXT();
+  _cb_42:_Z80_CB(1,0,2);_Z80_NEXT();
+  _cb_43:_Z80_CB(1,0,3);_Z80_NEXT();
+  _cb_44:_Z80_CB(1,0,4);_Z80_NEXT();
+  _cb_45:_Z80_CB(1,0,5);_Z80_NEXT();
+  _cb_46:_Z80_CB(1,0,6);_Z80_NEXT();
+  _cb_47:_Z80_CB(1,0,7);_Z80_NEXT();
+  _cb_48:_Z80_CB(1,1,0);_Z80_NEXT();
+  _cb_49:_Z80_CB(1,1,1);_Z80_NEXT();
+  _cb_4a:_Z80_CB(1,1,2);_Z80_NEXT();
+  _cb_4b:_Z80_CB(1,1,3);_Z80_NEXT();
+  _cb_4c:_Z80_CB(1,1,4);_Z80_NEXT();
+  _cb_4d:_Z80_CB(1,1,5);_Z80_NEXT();
+  _cb_4e:_Z80_CB(1,1,6);_Z80_NEXT();
+  _cb_4f:_Z80_CB(1,1,7);_Z80_NEXT();
+  _cb_50:_Z80_CB(1,2,0);_Z80_NEXT();
+  _cb_51:_Z80_CB(1,2,1);_Z80_NEXT();
+  _cb_52:_Z80_CB(1,2,2);_Z80_NEXT();
+  _cb_53:_Z80_CB(1,2,3);_Z80_NEXT();
+  _cb_54:_Z80_CB(1,2,4);_Z80_NEXT();
+  _cb_55:_Z80_CB(1,2,5);_Z80_NEXT();
+  _cb_56:_Z80_CB(1,2,6);_Z80_NEXT();
+  _cb_57:_Z80_CB(1,2,7);_Z80_NEXT();
+  _cb_58:_Z80_CB(1,3,0);_Z80_NEXT();
+  _cb_59:_Z80_CB(1,3,1);_Z80_NEXT();
+  _cb_5a:_Z80_CB(1,3,2);_Z80_NEXT();
+  _cb_5b:_Z80_CB(1,3,3);_Z80_NEXT();
+  _cb_5c:_Z80_CB(1,3,4);_Z80_NEXT();
+  _cb_5d:_Z80_CB(1,3,5);_Z80_NEXT();
+  _cb_5e:_Z80_CB(1,3,6);_Z80_NEXT();
+  _cb_5f:_Z80_CB(1,3,7);_Z80_NEXT();
+  _cb_60:_Z80_CB(1,4,0);_Z80_NEXT();
+  _cb_61:_Z80_CB(1,4,1);_Z80_NEXT();
+  _cb_62:_Z80_CB(1,4,2);_Z80_NEXT();
+  _cb_63:_Z80_CB(1,4,3);_Z80_NEXT();
+  _cb_64:_Z80_CB(1,4,4);_Z80_NEXT();
+  _cb_65:_Z80_CB(1,4,5);_Z80_NEXT();
+  _cb_66:_Z80_CB(1,4,6);_Z80_NEXT();
+  _cb_67:_Z80_CB(1,4,7);_Z80_NEXT();
+  _cb_68:_Z80_CB(1,5,0);_Z80_NEXT();
+  _cb_69:_Z80_CB(1,5,1);_Z80_NEXT();
+  _cb_6a:_Z80_CB(1,5,2);_Z80_NEXT();
+  _cb_6b:_Z80_CB(1,5,3);_Z80_NEXT();
+  _cb_6c:_Z80_CB(1,5,4);_Z80_NEXT();
+  _cb_6d:_Z80_CB(1,5,5);_Z80_NEXT();
+  _cb_6e:_Z80_CB(1,5,6);_Z80_NEXT();
+  _cb_6f:_Z80_CB(1,5,7);_Z80_NEXT();
+  _cb_70:_Z80_CB(1,6,0);_Z80_NEXT();
+  _cb_71:_Z80_CB(1,6,1);_Z80_NEXT();
+  _cb_72:_Z80_CB(1,6,2);_Z80_NEXT();
+  _cb_73:_Z80_CB(1,6,3);_Z80_NEXT();
+  _cb_74:_Z80_CB(1,6,4);_Z80_NEXT();
+  _cb_75:_Z80_CB(1,6,5);_Z80_NEXT();
+  _cb_76:_Z80_CB(1,6,6);_Z80_NEXT();
+  _cb_77:_Z80_CB(1,6,7);_Z80_NEXT();
+  _cb_78:_Z80_CB(1,7,0);_Z80_NEXT();
+  _cb_79:_Z80_CB(1,7,1);_Z80_NEXT();
+  _cb_7a:_Z80_CB(1,7,2);_Z80_NEXT();
+  _cb_7b:_Z80_CB(1,7,3);_Z80_NEXT();
+  _cb_7c:_Z80_CB(1,7,4);_Z80_NEXT();
+  _cb_7d:_Z80_CB(1,7,5);_Z80_NEXT();
+  _cb_7e:_Z80_CB(1,7,6);_Z80_NEXT();
+  _cb_7f:_Z80_CB(1,7,7);_Z80_NEXT();
+  _cb_80:_Z80_CB(2,0,0);_Z80_NEXT();
+  _cb_81:_Z80_CB(2,0,1);_Z80_NEXT();
+  _cb_82:_Z80_CB(2,0,2);_Z80_NEXT();
+  _cb_83:_Z80_CB(2,0,3);_Z80_NEXT();
+  _cb_84:_Z80_CB(2,0,4);_Z80_NEXT();
+  _cb_85:_Z80_CB(2,0,5);_Z80_NEXT();
+  _cb_86:_Z80_CB(2,0,6);_Z80_NEXT();
+  _cb_87:_Z80_CB(2,0,7);_Z80_NEXT();
+  _cb_88:_Z80_CB(2,1,0);_Z80_NEXT();
+  _cb_89:_Z80_CB(2,1,1);_Z80_NEXT();
+  _cb_8a:_Z80_CB(2,1,2);_Z80_NEXT();
+  _cb_8b:_Z80_CB(2,1,3);_Z80_NEXT();
+  _cb_8c:_Z80_CB(2,1,4);_Z80_NEXT();
+  _cb_8d:_Z80_CB(2,1,5);_Z80_NEXT();
+  _cb_8e:_Z80_CB(2,1,6);_Z80_NEXT();
+  _cb_8f:_Z80_CB(2,1,7);_Z80_NEXT();
+  _cb_90:_Z80_CB(2,2,0);_Z80_NEXT();
+  _cb_91:_Z80_CB(2,2,1);_Z80_NEXT();
+  _cb_92:_Z80_CB(2,2,2);_Z80_NEXT();
+  _cb_93:_Z80_CB(2,2,3);_Z80_NEXT();
+  _cb_94:_Z80_CB(2,2,4);_Z80_NEXT();
+  _cb_95:_Z80_CB(2,2,5);_Z80_NEXT();
+  _cb_96:_Z80_CB(2,2,6);_Z80_NEXT();
+  _cb_97:_Z80_CB(2,2,7);_Z80_NEXT();
+  _cb_98:_Z80_CB(2,3,0);_Z80_NEXT();
+  _cb_99:_Z80_CB(2,3,1);_Z80_NEXT();
+  _cb_9a:_Z80_CB(2,3,2);_Z80_NEXT();
+  _cb_9b:_Z80_CB(2,3,3);_Z80_NEXT();
+  _cb_9c:_Z80_CB(2,3,4);_Z80_NEXT();
+  _cb_9d:_Z80_CB(2,3,5);_Z80_NEXT();
+  _cb_9e:_Z80_CB(2,3,6);_Z80_NEXT();
+  _cb_9f:_Z80_CB(2,3,7);_Z80_NEXT();
+  _cb_a0:_Z80_CB(2,4,0);_Z80_NEXT();
+  _cb_a1:_Z80_CB(2,4,1);_Z80_NEXT();
+  _cb_a2:_Z80_CB(2,4,2);_Z80_NEXT();
+  _cb_a3:_Z80_CB(2,4,3);_Z80_NEXT();
+  _cb_a4:_Z80_CB(2,4,4);_Z80_NEXT();
+  _cb_a5:_Z80_CB(2,4,5);_Z80_NEXT();
+  _cb_a6:_Z80_CB(2,4,6);_Z80_NEXT();
+  _cb_a7:_Z80_CB(2,4,7);_Z80_NEXT();
+  _cb_a8:_Z80_CB(2,5,0);_Z80_NEXT();
+  _cb_a9:_Z80_CB(2,5,1);_Z80_NEXT();
+  _cb_aa:_Z80_CB(2,5,2);_Z80_NEXT();
+  _cb_ab:_Z80_CB(2,5,3);_Z80_NEXT();
+  _cb_ac:_Z80_CB(2,5,4);_Z80_NEXT();
+  _cb_ad:_Z80_CB(2,5,5);_Z80_NEXT();
+  _cb_ae:_Z80_CB(2,5,6);_Z80_NEXT();
+  _cb_af:_Z80_CB(2,5,7);_Z80_NEXT();
+  _cb_b0:_Z80_CB(2,6,0);_Z80_NEXT();
+  _cb_b1:_Z80_CB(2,6,1);_Z80_NEXT();
+  _cb_b2:_Z80_CB(2,6,2);_Z80_NEXT();
+  _cb_b3:_Z80_CB(2,6,3);_Z80_NEXT();
+  _cb_b4:_Z80_CB(2,6,4);_Z80_NEXT();
+  _cb_b5:_Z80_CB(2,6,5);_Z80_NEXT();
+  _cb_b6:_Z80_CB(2,6,6);_Z80_NEXT();
+  _cb_b7:_Z80_CB(2,6,7);_Z80_NEXT();
+  _cb_b8:_Z80_CB(2,7,0);_Z80_NEXT();
+  _cb_b9:_Z80_CB(2,7,1);_Z80_NEXT();
+  _cb_ba:_Z80_CB(2,7,2);_Z80_NEXT();
+  _cb_bb:_Z80_CB(2,7,3);_Z80_NEXT();
+  _cb_bc:_Z80_CB(2,7,4);_Z80_NEXT();
+  _cb_bd:_Z80_CB(2,7,5);_Z80_NEXT();
+  _cb_be:_Z80_CB(2,7,6);_Z80_NEXT();
+  _cb_bf:_Z80_CB(2,7,7);_Z80_NEXT();
+  _cb_c0:_Z80_CB(3,0,0);_Z80_NEXT();
+  _cb_c1:_Z80_CB(3,0,1);_Z80_NEXT();
+  _cb_c2:_Z80_CB(3,0,2);_Z80_NEXT();
+  _cb_c3:_Z80_CB(3,0,3);_Z80_NEXT();
+  _cb_c4:_Z80_CB(3,0,4);_Z80_NEXT();
+  _cb_c5:_Z80_CB(3,0,5);_Z80_NEXT();
+  _cb_c6:_Z80_CB(3,0,6);_Z80_NEXT();
+  _cb_c7:_Z80_CB(3,0,7);_Z80_NEXT();
+  _cb_c8:_Z80_CB(3,1,0);_Z80_NEXT();
+  _cb_c9:_Z80_CB(3,1,1);_Z80_NEXT();
+  _cb_ca:_Z80_CB(3,1,2);_Z80_NEXT();
+  _cb_cb:_Z80_CB(3,1,3);_Z80_NEXT();
+  _cb_cc:_Z80_CB(3,1,4);_Z80_NEXT();
+  _cb_cd:_Z80_CB(3,1,5);_Z80_NEXT();
+  _cb_ce:_Z80_CB(3,1,6);_Z80_NEXT();
+  _cb_cf:_Z80_CB(3,1,7);_Z80_NEXT();
+  _cb_d0:_Z80_CB(3,2,0);_Z80_NEXT();
+  _cb_d1:_Z80_CB(3,2,1);_Z80_NEXT();
+  _cb_d2:_Z80_CB(3,2,2);_Z80_NEXT();
+  _cb_d3:_Z80_CB(3,2,3);_Z80_NEXT();
+  _cb_d4:_Z80_CB(3,2,4);_Z80_NEXT();
+  _cb_d5:_Z80_CB(3,2,5);_Z80_NEXT();
+  _cb_d6:_Z80_CB(3,2,6);_Z80_NEXT();
+  _cb_d7:_Z80_CB(3,2,7);_Z80_NEXT();
+  _cb_d8:_Z80_CB(3,3,0);_Z80_NEXT();
+  _cb_d9:_Z80_CB(3,3,1);_Z80_NEXT();
+  _cb_da:_Z80_CB(3,3,2);_Z80_NEXT();
+  _cb_db:_Z80_CB(3,3,3);_Z80_NEXT();
+  _cb_dc:_Z80_CB(3,3,4);_Z80_NEXT();
+  _cb_dd:_Z80_CB(3,3,5);_Z80_NEXT();
+  _cb_de:_Z80_CB(3,3,6);_Z80_NEXT();
+  _cb_df:_Z80_CB(3,3,7);_Z80_NEXT();
+  _cb_e0:_Z80_CB(3,4,0);_Z80_NEXT();
+  _cb_e1:_Z80_CB(3,4,1);_Z80_NEXT();
+  _cb_e2:_Z80_CB(3,4,2);_Z80_NEXT();
+  _cb_e3:_Z80_CB(3,4,3);_Z80_NEXT();
+  _cb_e4:_Z80_CB(3,4,4);_Z80_NEXT();
+  _cb_e5:_Z80_CB(3,4,5);_Z80_NEXT();
+  _cb_e6:_Z80_CB(3,4,6);_Z80_NEXT();
+  _cb_e7:_Z80_CB(3,4,7);_Z80_NEXT();
+  _cb_e8:_Z80_CB(3,5,0);_Z80_NEXT();
+  _cb_e9:_Z80_CB(3,5,1);_Z80_NEXT();
+  _cb_ea:_Z80_CB(3,5,2);_Z80_NEXT();
+  _cb_eb:_Z80_CB(3,5,3);_Z80_NEXT();
+  _cb_ec:_Z80_CB(3,5,4);_Z80_NEXT();
+  _cb_ed:_Z80_CB(3,5,5);_Z80_NEXT();
+  _cb_ee:_Z80_CB(3,5,6);_Z80_NEXT();
+  _cb_ef:_Z80_CB(3,5,7);_Z80_NEXT();
+  _cb_f0:_Z80_CB(3,6,0);_Z80_NEXT();
+  _cb_f1:_Z80_CB(3,6,1);_Z80_NEXT();
+  _cb_f2:_Z80_CB(3,6,2);_Z80_NEXT();
+  _cb_f3:_Z80_CB(3,6,3);_Z80_NEXT();
+  _cb_f4:_Z80_CB(3,6,4);_Z80_NEXT();
+  _cb_f5:_Z80_CB(3,6,5);_Z80_NEXT();
+  _cb_f6:_Z80_CB(3,6,6);_Z80_NEXT();
+  _cb_f7:_Z80_CB(3,6,7);_Z80_NEXT();
+  _cb_f8:_Z80_CB(3,7,0);_Z80_NEXT();
+  _cb_f9:_Z80_CB(3,7,1);_Z80_NEXT();
+  _cb_fa:_Z80_CB(3,7,2);_Z80_NEXT();
+  _cb_fb:_Z80_CB(3,7,3);_Z80_NEXT();
+  _cb_fc:_Z80_CB(3,7,4);_Z80_NEXT();
+  _cb_fd:_Z80_CB(3,7,5);_Z80_NEXT();
+  _cb_fe:_Z80_CB(3,7,6);_Z80_NEXT();
+  _cb_ff:_Z80_CB(3,7,7);_Z80_NEXT();
+#undef _IDX
+#define _IDX() (1)
+  /* DD/FD ops */
+  _ix_00:/*NOP*/{ }_Z80_NEXT_IDX();
+  _ix_01:/*LD BC,nn*/{_IMM16(d16);_S_BC(d16);}_Z80_NEXT_IDX();
+  _ix_02:/*LD (BC),A*/{addr=_G_BC();d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT_IDX();
+  _ix_03:/*INC BC*/{_T(2);_S_BC(_G_BC()+1);}_Z80_NEXT_IDX();
+  _ix_04:/*INC B*/{d8=_G_B();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_B(d8);}_Z80_NEXT_IDX();
+  _ix_05:/*DEC B*/{d8=_G_B();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_B(d8);}_Z80_NEXT_IDX();
+  _ix_06:/*LD B,n*/{_IMM8(d8);_S_B(d8);}_Z80_NEXT_IDX();
+  _ix_07:/*RLCA*/{ws=_z80_rlca(ws);}_Z80_NEXT_IDX();
+  _ix_08:/*EX AF,AF'*/{{r0=_z80_flush_r0(ws,r0,r2);uint16_t fa=_G16(r0,_FA);uint16_t fa_=_G16(r3,_FA);_S16(r0,_FA,fa_);_S16(r3,_FA,fa);ws=_z80_map_regs(r0,r1,r2);}}_Z80_NEXT_IDX();
+  _ix_09:/*ADD HL,BC*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_BC();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT_IDX();
+  _ix_0a:/*LD A,(BC)*/{addr=_G_BC();_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT_IDX();
+  _ix_0b:/*DEC BC*/{_T(2);_S_BC(_G_BC()-1);}_Z80_NEXT_IDX();
+  _ix_0c:/*INC C*/{d8=_G_C();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_C(d8);}_Z80_NEXT_IDX();
+  _ix_0d:/*DEC C*/{d8=_G_C();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_C(d8);}_Z80_NEXT_IDX();
+  _ix_0e:/*LD C,n*/{_IMM8(d8);_S_C(d8);}_Z80_NEXT_IDX();
+  _ix_0f:/*RRCA*/{ws=_z80_rrca(ws);}_Z80_NEXT_IDX();
+  _ix_10:/*DJNZ*/{{_T(1);int8_t d;_IMM8(d);d8=_G_B()-1;_S_B(d8);if(d8>0){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT_IDX();
+  _ix_11:/*LD DE,nn*/{_IMM16(d16);_S_DE(d16);}_Z80_NEXT_IDX();
+  _ix_12:/*LD (DE),A*/{addr=_G_DE();d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT_IDX();
+  _ix_13:/*INC DE*/{_T(2);_S_DE(_G_DE()+1);}_Z80_NEXT_IDX();
+  _ix_14:/*INC D*/{d8=_G_D();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_D(d8);}_Z80_NEXT_IDX();
+  _ix_15:/*DEC D*/{d8=_G_D();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_D(d8);}_Z80_NEXT_IDX();
+  _ix_16:/*LD D,n*/{_IMM8(d8);_S_D(d8);}_Z80_NEXT_IDX();
+  _ix_17:/*RLA*/{ws=_z80_rla(ws);}_Z80_NEXT_IDX();
+  _ix_18:/*JR d*/{{int8_t d;_IMM8(d);pc+=d;_S_WZ(pc);_T(5);}}_Z80_NEXT_IDX();
+  _ix_19:/*ADD HL,DE*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_DE();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT_IDX();
+  _ix_1a:/*LD A,(DE)*/{addr=_G_DE();_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT_IDX();
+  _ix_1b:/*DEC DE*/{_T(2);_S_DE(_G_DE()-1);}_Z80_NEXT_IDX();
+  _ix_1c:/*INC E*/{d8=_G_E();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_E(d8);}_Z80_NEXT_IDX();
+  _ix_1d:/*DEC E*/{d8=_G_E();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_E(d8);}_Z80_NEXT_IDX();
+  _ix_1e:/*LD E,n*/{_IMM8(d8);_S_E(d8);}_Z80_NEXT_IDX();
+  _ix_1f:/*RRA*/{ws=_z80_rra(ws);}_Z80_NEXT_IDX();
+  _ix_20:/*JR NZ,d*/{{int8_t d;_IMM8(d);if(!(_G_F()&Z80_ZF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT_IDX();
+  _ix_21:/*LD HL,nn*/{_IMM16(d16);_S_HL(d16);}_Z80_NEXT_IDX();
+  _ix_22:/*LD (nn),HL*/{_IMM16(addr);_MW(addr++,_G_L());_MW(addr,_G_H());_S_WZ(addr);}_Z80_NEXT_IDX();
+  _ix_23:/*INC HL*/{_T(2);_S_HL(_G_HL()+1);}_Z80_NEXT_IDX();
+  _ix_24:/*INC H*/{d8=_G_H();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_H(d8);}_Z80_NEXT_IDX();
+  _ix_25:/*DEC H*/{d8=_G_H();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_H(d8);}_Z80_NEXT_IDX();
+  _ix_26:/*LD H,n*/{_IMM8(d8);_S_H(d8);}_Z80_NEXT_IDX();
+  _ix_27:/*DAA*/{ws=_z80_daa(ws);}_Z80_NEXT_IDX();
+  _ix_28:/*JR Z,d*/{{int8_t d;_IMM8(d);if((_G_F()&Z80_ZF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT_IDX();
+  _ix_29:/*ADD HL,HL*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_HL();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT_IDX();
+  _ix_2a:/*LD HL,(nn)*/{_IMM16(addr);_MR(addr++,d8);_S_L(d8);_MR(addr,d8);_S_H(d8);_S_WZ(addr);}_Z80_NEXT_IDX();
+  _ix_2b:/*DEC HL*/{_T(2);_S_HL(_G_HL()-1);}_Z80_NEXT_IDX();
+  _ix_2c:/*INC L*/{d8=_G_L();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_L(d8);}_Z80_NEXT_IDX();
+  _ix_2d:/*DEC L*/{d8=_G_L();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_L(d8);}_Z80_NEXT_IDX();
+  _ix_2e:/*LD L,n*/{_IMM8(d8);_S_L(d8);}_Z80_NEXT_IDX();
+  _ix_2f:/*CPL*/{ws=_z80_cpl(ws);}_Z80_NEXT_IDX();
+  _ix_30:/*JR NC,d*/{{int8_t d;_IMM8(d);if(!(_G_F()&Z80_CF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT_IDX();
+  _ix_31:/*LD SP,nn*/{_IMM16(d16);_S_SP(d16);}_Z80_NEXT_IDX();
+  _ix_32:/*LD (nn),A*/{_IMM16(addr);d8=_G_A();_MW(addr++,d8);_S_WZ((d8<<8)|(addr&0x00FF));}_Z80_NEXT_IDX();
+  _ix_33:/*INC SP*/{_T(2);_S_SP(_G_SP()+1);}_Z80_NEXT_IDX();
+  _ix_34:/*INC (HL/IX+d/IY+d)*/{_ADDR(addr,5);_T(1);_MR(addr,d8);{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_35:/*DEC (HL/IX+d/IY+d)*/{_ADDR(addr,5);_T(1);_MR(addr,d8);{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_36:/*LD (HL/IX+d/IY+d),n*/{_ADDR(addr,2);_IMM8(d8);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_37:/*SCF*/{ws=_z80_scf(ws);}_Z80_NEXT_IDX();
+  _ix_38:/*JR C,d*/{{int8_t d;_IMM8(d);if((_G_F()&Z80_CF)){pc+=d;_S_WZ(pc);_T(5);}}}_Z80_NEXT_IDX();
+  _ix_39:/*ADD HL,SP*/{{uint16_t acc=_G_HL();_S_WZ(acc+1);d16=_G_SP();uint32_t r=acc+d16;_S_HL(r);uint8_t f=_G_F()&(Z80_SF|Z80_ZF|Z80_VF);f|=((acc^r^d16)>>8)&Z80_HF;f|=((r>>16)&Z80_CF)|((r>>8)&(Z80_YF|Z80_XF));_S_F(f);_T(7);}}_Z80_NEXT_IDX();
+  _ix_3a:/*LD A,(nn)*/{_IMM16(addr);_MR(addr++,d8);_S_A(d8);_S_WZ(addr);}_Z80_NEXT_IDX();
+  _ix_3b:/*DEC SP*/{_T(2);_S_SP(_G_SP()-1);}_Z80_NEXT_IDX();
+  _ix_3c:/*INC A*/{d8=_G_A();{uint8_t r=d8+1;uint8_t f=_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x80){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_A(d8);}_Z80_NEXT_IDX();
+  _ix_3d:/*DEC A*/{d8=_G_A();{uint8_t r=d8-1;uint8_t f=Z80_NF|_SZ(r)|(r&(Z80_XF|Z80_YF))|((r^d8)&Z80_HF);if(r==0x7F){f|=Z80_VF;}_S_F(f|(_G_F()&Z80_CF));d8=r;}_S_A(d8);}_Z80_NEXT_IDX();
+  _ix_3e:/*LD A,n*/{_IMM8(d8);_S_A(d8);}_Z80_NEXT_IDX();
+  _ix_3f:/*CCF*/{ws=_z80_ccf(ws);}_Z80_NEXT_IDX();
+  _ix_40:/*LD B,B*/{_S_B(_G_B());}_Z80_NEXT_IDX();
+  _ix_41:/*LD B,C*/{_S_B(_G_C());}_Z80_NEXT_IDX();
+  _ix_42:/*LD B,D*/{_S_B(_G_D());}_Z80_NEXT_IDX();
+  _ix_43:/*LD B,E*/{_S_B(_G_E());}_Z80_NEXT_IDX();
+  _ix_44:/*LD B,H*/{_S_B(_G_H());}_Z80_NEXT_IDX();
+  _ix_45:/*LD B,L*/{_S_B(_G_L());}_Z80_NEXT_IDX();
+  _ix_46:/*LD B,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_B(d8);}_Z80_NEXT_IDX();
+  _ix_47:/*LD B,A*/{_S_B(_G_A());}_Z80_NEXT_IDX();
+  _ix_48:/*LD C,B*/{_S_C(_G_B());}_Z80_NEXT_IDX();
+  _ix_49:/*LD C,C*/{_S_C(_G_C());}_Z80_NEXT_IDX();
+  _ix_4a:/*LD C,D*/{_S_C(_G_D());}_Z80_NEXT_IDX();
+  _ix_4b:/*LD C,E*/{_S_C(_G_E());}_Z80_NEXT_IDX();
+  _ix_4c:/*LD C,H*/{_S_C(_G_H());}_Z80_NEXT_IDX();
+  _ix_4d:/*LD C,L*/{_S_C(_G_L());}_Z80_NEXT_IDX();
+  _ix_4e:/*LD C,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_C(d8);}_Z80_NEXT_IDX();
+  _ix_4f:/*LD C,A*/{_S_C(_G_A());}_Z80_NEXT_IDX();
+  _ix_50:/*LD D,B*/{_S_D(_G_B());}_Z80_NEXT_IDX();
+  _ix_51:/*LD D,C*/{_S_D(_G_C());}_Z80_NEXT_IDX();
+  _ix_52:/*LD D,D*/{_S_D(_G_D());}_Z80_NEXT_IDX();
+  _ix_53:/*LD D,E*/{_S_D(_G_E());}_Z80_NEXT_IDX();
+  _ix_54:/*LD D,H*/{_S_D(_G_H());}_Z80_NEXT_IDX();
+  _ix_55:/*LD D,L*/{_S_D(_G_L());}_Z80_NEXT_IDX();
+  _ix_56:/*LD D,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_D(d8);}_Z80_NEXT_IDX();
+  _ix_57:/*LD D,A*/{_S_D(_G_A());}_Z80_NEXT_IDX();
+  _ix_58:/*LD E,B*/{_S_E(_G_B());}_Z80_NEXT_IDX();
+  _ix_59:/*LD E,C*/{_S_E(_G_C());}_Z80_NEXT_IDX();
+  _ix_5a:/*LD E,D*/{_S_E(_G_D());}_Z80_NEXT_IDX();
+  _ix_5b:/*LD E,E*/{_S_E(_G_E());}_Z80_NEXT_IDX();
+  _ix_5c:/*LD E,H*/{_S_E(_G_H());}_Z80_NEXT_IDX();
+  _ix_5d:/*LD E,L*/{_S_E(_G_L());}_Z80_NEXT_IDX();
+  _ix_5e:/*LD E,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_E(d8);}_Z80_NEXT_IDX();
+  _ix_5f:/*LD E,A*/{_S_E(_G_A());}_Z80_NEXT_IDX();
+  _ix_60:/*LD H,B*/{_S_H(_G_B());}_Z80_NEXT_IDX();
+  _ix_61:/*LD H,C*/{_S_H(_G_C());}_Z80_NEXT_IDX();
+  _ix_62:/*LD H,D*/{_S_H(_G_D());}_Z80_NEXT_IDX();
+  _ix_63:/*LD H,E*/{_S_H(_G_E());}_Z80_NEXT_IDX();
+  _ix_64:/*LD H,H*/{_S_H(_G_H());}_Z80_NEXT_IDX();
+  _ix_65:/*LD H,L*/{_S_H(_G_L());}_Z80_NEXT_IDX();
+  _ix_66:/*LD H,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);if(_IDX()){_S8(r0,_H,d8);}else{_S_H(d8);}}_Z80_NEXT_IDX();
+  _ix_67:/*LD H,A*/{_S_H(_G_A());}_Z80_NEXT_IDX();
+  _ix_68:/*LD L,B*/{_S_L(_G_B());}_Z80_NEXT_IDX();
+  _ix_69:/*LD L,C*/{_S_L(_G_C());}_Z80_NEXT_IDX();
+  _ix_6a:/*LD L,D*/{_S_L(_G_D());}_Z80_NEXT_IDX();
+  _ix_6b:/*LD L,E*/{_S_L(_G_E());}_Z80_NEXT_IDX();
+  _ix_6c:/*LD L,H*/{_S_L(_G_H());}_Z80_NEXT_IDX();
+  _ix_6d:/*LD L,L*/{_S_L(_G_L());}_Z80_NEXT_IDX();
+  _ix_6e:/*LD L,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);if(_IDX()){_S8(r0,_L,d8);}else{_S_L(d8);}}_Z80_NEXT_IDX();
+  _ix_6f:/*LD L,A*/{_S_L(_G_A());}_Z80_NEXT_IDX();
+  _ix_70:/*LD (HL/IX+d/IY+d),B*/{d8=_G_B();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_71:/*LD (HL/IX+d/IY+d),C*/{d8=_G_C();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_72:/*LD (HL/IX+d/IY+d),D*/{d8=_G_D();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_73:/*LD (HL/IX+d/IY+d),E*/{d8=_G_E();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_74:/*LD (HL/IX+d/IY+d),H*/{d8=_IDX()?_G8(r0,_H):_G_H();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_75:/*LD (HL/IX+d/IY+d),L*/{d8=_IDX()?_G8(r0,_L):_G_L();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_76:/*HALT*/{pins|=Z80_HALT;pc--;}_Z80_NEXT_IDX();
+  _ix_77:/*LD (HL/IX+d/IY+d),A*/{d8=_G_A();_ADDR(addr,5);_MW(addr,d8);}_Z80_NEXT_IDX();
+  _ix_78:/*LD A,B*/{_S_A(_G_B());}_Z80_NEXT_IDX();
+  _ix_79:/*LD A,C*/{_S_A(_G_C());}_Z80_NEXT_IDX();
+  _ix_7a:/*LD A,D*/{_S_A(_G_D());}_Z80_NEXT_IDX();
+  _ix_7b:/*LD A,E*/{_S_A(_G_E());}_Z80_NEXT_IDX();
+  _ix_7c:/*LD A,H*/{_S_A(_G_H());}_Z80_NEXT_IDX();
+  _ix_7d:/*LD A,L*/{_S_A(_G_L());}_Z80_NEXT_IDX();
+  _ix_7e:/*LD A,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);_S_A(d8);}_Z80_NEXT_IDX();
+  _ix_7f:/*LD A,A*/{_S_A(_G_A());}_Z80_NEXT_IDX();
+  _ix_80:/*ADD B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_81:/*ADD C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_82:/*ADD D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_83:/*ADD E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_84:/*ADD H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_85:/*ADD L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_86:/*ADD,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_87:/*ADD A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_88:/*ADC B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_89:/*ADC C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8a:/*ADC D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8b:/*ADC E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8c:/*ADC H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8d:/*ADC L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8e:/*ADC,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_8f:/*ADC A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_90:/*SUB B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_91:/*SUB C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_92:/*SUB D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_93:/*SUB E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_94:/*SUB H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_95:/*SUB L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_96:/*SUB,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_97:/*SUB A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_98:/*SBC B*/{d8=_G_B();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_99:/*SBC C*/{d8=_G_C();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9a:/*SBC D*/{d8=_G_D();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9b:/*SBC E*/{d8=_G_E();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9c:/*SBC H*/{d8=_G_H();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9d:/*SBC L*/{d8=_G_L();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9e:/*SBC,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_9f:/*SBC A*/{d8=_G_A();{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_a0:/*AND B*/{d8=_G_B();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a1:/*AND C*/{d8=_G_C();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a2:/*AND D*/{d8=_G_D();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a3:/*AND E*/{d8=_G_E();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a4:/*AND H*/{d8=_G_H();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a5:/*AND L*/{d8=_G_L();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a6:/*AND,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a7:/*AND A*/{d8=_G_A();{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a8:/*XOR B*/{d8=_G_B();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_a9:/*XOR C*/{d8=_G_C();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_aa:/*XOR D*/{d8=_G_D();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_ab:/*XOR E*/{d8=_G_E();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_ac:/*XOR H*/{d8=_G_H();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_ad:/*XOR L*/{d8=_G_L();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_ae:/*XOR,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_af:/*XOR A*/{d8=_G_A();{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b0:/*OR B*/{d8=_G_B();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b1:/*OR C*/{d8=_G_C();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b2:/*OR D*/{d8=_G_D();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b3:/*OR E*/{d8=_G_E();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b4:/*OR H*/{d8=_G_H();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b5:/*OR L*/{d8=_G_L();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b6:/*OR,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b7:/*OR A*/{d8=_G_A();{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_b8:/*CP B*/{d8=_G_B();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_b9:/*CP C*/{d8=_G_C();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_ba:/*CP D*/{d8=_G_D();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_bb:/*CP E*/{d8=_G_E();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_bc:/*CP H*/{d8=_G_H();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_bd:/*CP L*/{d8=_G_L();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_be:/*CP,(HL/IX+d/IY+d)*/{_ADDR(addr,5);_MR(addr,d8);{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_bf:/*CP A*/{d8=_G_A();{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_c0:/*RET NZ*/{_T(1);if (!(_G_F()&Z80_ZF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_c1:/*POP BC*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_BC(d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_c2:/*JP NZ,nn*/{_IMM16(addr);if(!(_G_F()&Z80_ZF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_c3:/*JP nn*/{_IMM16(pc);}_Z80_NEXT_IDX();
+  _ix_c4:/*CALL NZ,nn*/{_IMM16(addr);if(!(_G_F()&Z80_ZF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_c5:/*PUSH BC*/{_T(1);addr=_G_SP();d16=_G_BC();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_c6:/*ADD n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=acc+d8;_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_c7:/*RST 0x0*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x0;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_c8:/*RET Z*/{_T(1);if ((_G_F()&Z80_ZF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_c9:/*RET*/{d16=_G_SP();_MR(d16++,d8);pc=d8;_MR(d16++,d8);pc|=d8<<8;_S_SP(d16);_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_ca:/*JP Z,nn*/{_IMM16(addr);if((_G_F()&Z80_ZF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_cc:/*CALL Z,nn*/{_IMM16(addr);if((_G_F()&Z80_ZF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_cd:/*CALL nn*/{_IMM16(addr);_T(1);d16=_G_SP();_MW(--d16,pc>>8);_MW(--d16,pc);_S_SP(d16);pc=addr;}_Z80_NEXT_IDX();
+  _ix_ce:/*ADC n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=acc+d8+(_G_F()&Z80_CF);_S_F(_ADD_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_cf:/*RST 0x8*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x8;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_d0:/*RET NC*/{_T(1);if (!(_G_F()&Z80_CF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_d1:/*POP DE*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_DE(d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_d2:/*JP NC,nn*/{_IMM16(addr);if(!(_G_F()&Z80_CF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_d3:/*OUT (n),A*/{{_IMM8(d8);uint8_t a=_G_A();addr=(a<<8)|d8;_OUT(addr,a);_S_WZ((addr&0xFF00)|((addr+1)&0x00FF));}}_Z80_NEXT_IDX();
+  _ix_d4:/*CALL NC,nn*/{_IMM16(addr);if(!(_G_F()&Z80_CF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_d5:/*PUSH DE*/{_T(1);addr=_G_SP();d16=_G_DE();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_d6:/*SUB n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_d7:/*RST 0x10*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x10;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_d8:/*RET C*/{_T(1);if ((_G_F()&Z80_CF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_d9:/*EXX*/{{r0=_z80_flush_r0(ws,r0,r2);const uint64_t rx=r3;r3=(r3&0xffff)|(r0&0xffffffffffff0000);r0=(r0&0xffff)|(rx&0xffffffffffff0000);ws=_z80_map_regs(r0, r1, r2);}}_Z80_NEXT_IDX();
+  _ix_da:/*JP C,nn*/{_IMM16(addr);if((_G_F()&Z80_CF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_db:/*IN A,(n)*/{{_IMM8(d8);uint8_t a=_G_A();addr=(a<<8)|d8;_IN(addr++,a);_S_A(a);_S_WZ(addr);}}_Z80_NEXT_IDX();
+  _ix_dc:/*CALL C,nn*/{_IMM16(addr);if((_G_F()&Z80_CF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_de:/*SBC n*/{_IMM8(d8);{uint8_t acc=_G_A();uint32_t res=(uint32_t)((int)acc-(int)d8-(_G_F()&Z80_CF));_S_F(_SUB_FLAGS(acc,d8,res));_S_A(res);}}_Z80_NEXT_IDX();
+  _ix_df:/*RST 0x18*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x18;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_e0:/*RET PO*/{_T(1);if (!(_G_F()&Z80_PF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_e1:/*POP HL*/{addr=_G_SP();_MR(addr++,d8);d16=d8;_MR(addr++,d8);d16|=d8<<8;_S_HL(d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_e2:/*JP PO,nn*/{_IMM16(addr);if(!(_G_F()&Z80_PF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_e3:/*EX (SP),HL*/{{_T(3);addr=_G_SP();d16=_G_HL();uint8_t l,h;_MR(addr,l);_MR(addr+1,h);_MW(addr,d16);_MW(addr+1,d16>>8);d16=(h<<8)|l;_S_HL(d16);_S_WZ(d16);}}_Z80_NEXT_IDX();
+  _ix_e4:/*CALL PO,nn*/{_IMM16(addr);if(!(_G_F()&Z80_PF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_e5:/*PUSH HL*/{_T(1);addr=_G_SP();d16=_G_HL();_MW(--addr,d16>>8);_MW(--addr,d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_e6:/*AND n*/{_IMM8(d8);{d8&=_G_A();_S_F(_z80_szp[d8]|Z80_HF);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_e7:/*RST 0x20*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x20;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_e8:/*RET PE*/{_T(1);if ((_G_F()&Z80_PF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_e9:/*JP HL*/{pc=_G_HL();}_Z80_NEXT_IDX();
+  _ix_ea:/*JP PE,nn*/{_IMM16(addr);if((_G_F()&Z80_PF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_eb:/*EX DE,HL*/{{r0=_z80_flush_r0(ws,r0,r2);uint16_t de=_G16(r0,_DE);uint16_t hl=_G16(r0,_HL);_S16(r0,_DE,hl);_S16(r0,_HL,de);ws=_z80_map_regs(r0,r1,r2);}}_Z80_NEXT_IDX();
+  _ix_ec:/*CALL PE,nn*/{_IMM16(addr);if((_G_F()&Z80_PF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_ee:/*XOR n*/{_IMM8(d8);{d8^=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_ef:/*RST 0x28*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x28;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_f0:/*RET P*/{_T(1);if (!(_G_F()&Z80_SF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_f1:/*POP FA*/{addr=_G_SP();_MR(addr++,d8);d16=d8<<8;_MR(addr++,d8);d16|=d8;_S_FA(d16);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_f2:/*JP P,nn*/{_IMM16(addr);if(!(_G_F()&Z80_SF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_f3:/*DI*/{r2&=~(_BIT_IFF1|_BIT_IFF2);}_Z80_NEXT_IDX();
+  _ix_f4:/*CALL P,nn*/{_IMM16(addr);if(!(_G_F()&Z80_SF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_f5:/*PUSH FA*/{_T(1);addr=_G_SP();d16=_G_FA();_MW(--addr,d16);_MW(--addr,d16>>8);_S_SP(addr);}_Z80_NEXT_IDX();
+  _ix_f6:/*OR n*/{_IMM8(d8);{d8|=_G_A();_S_F(_z80_szp[d8]);_S_A(d8);}}_Z80_NEXT_IDX();
+  _ix_f7:/*RST 0x30*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x30;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_f8:/*RET M*/{_T(1);if ((_G_F()&Z80_SF)){uint8_t w,z;d16=_G_SP();_MR(d16++,z);_MR(d16++,w);_S_SP(d16);pc=(w<<8)|z;_S_WZ(pc);}}_Z80_NEXT_IDX();
+  _ix_f9:/*LD SP,HL*/{_T(2);_S_SP(_G_HL());}_Z80_NEXT_IDX();
+  _ix_fa:/*JP M,nn*/{_IMM16(addr);if((_G_F()&Z80_SF)){pc=addr;}}_Z80_NEXT_IDX();
+  _ix_fb:/*EI*/{r2=(r2&~(_BIT_IFF1|_BIT_IFF2))|_BIT_EI;}_Z80_NEXT_IDX();
+  _ix_fc:/*CALL M,nn*/{_IMM16(addr);if((_G_F()&Z80_SF)){_T(1);uint16_t sp=_G_SP();_MW(--sp,pc>>8);_MW(--sp,pc);_S_SP(sp);pc=addr;}}_Z80_NEXT_IDX();
+  _ix_fe:/*CP n*/{_IMM8(d8);{uint8_t acc=_G_A();int32_t res=(uint32_t)((int)acc-(int)d8);_S_F(_CP_FLAGS(acc,d8,res));}}_Z80_NEXT_IDX();
+  _ix_ff:/*RST 0x38*/{_T(1);d16= _G_SP();_MW(--d16, pc>>8);_MW(--d16, pc);_S_SP(d16);pc=0x38;_S_WZ(pc);}_Z80_NEXT_IDX();
+  _ix_cb:
+    _IMM8(d);
+    _FETCH_CB(op);
+    goto *_z80_ixcb[op];
+  _ix_ed:
+    /* ED ignores a DD/FD prefix */
+    map_bits &= ~(_BIT_USE_IX|_BIT_USE_IY);
+    r0 = _z80_flush_r0(ws, r0, r2);
+    r1 = _z80_flush_r1(ws, r1, r2);
+    r2 &= ~_BITS_MAP_REGS;
+    ws = r0;
+    goto _op_ed;
+  /* DD/FD+CB ops */
+  _ixcb_00:_Z80_CB(0,0,0);_Z80_NEXT_IDX();
+  _ixcb_01:_Z80_CB(0,0,1);_Z80_NEXT_IDX();
+  _ixcb_02:_Z80_CB(0,0,2);_Z80_NEXT_IDX();
+  _ixcb_03:_Z80_CB(0,0,3);_Z80_NEXT_IDX();
+  _ixcb_04:_Z80_CB(0,0,4);_Z80_NEXT_IDX();
+  _ixcb_05:_Z80_CB(0,0,5);_Z80_NEXT_IDX();
+  _ixcb_06:_Z80_CB(0,0,6);_Z80_NEXT_IDX();
+  _ixcb_07:_Z80_CB(0,0,7);_Z80_NEXT_IDX();
+  _ixcb_08:_Z80_CB(0,1,0);_Z80_NEXT_IDX();
+  _ixcb_09:_Z80_CB(0,1,1);_Z80_NEXT_IDX();
+  _ixcb_0a:_Z80_CB(0,1,2);_Z80_NEXT_IDX();
+  _ixcb_0b:_Z80_CB(0,1,3);_Z80_NEXT_IDX();
+  _ixcb_0c:_Z80_CB(0,1,4);_Z80_NEXT_IDX();
+  _ixcb_0d:_Z80_CB(0,1,5);_Z80_NEXT_IDX();
+  _ixcb_0e:_Z80_CB(0,1,6);_Z80_NEXT_IDX();
+  _ixcb_0f:_Z80_CB(0,1,7);_Z80_NEXT_IDX();
+  _ixcb_10:_Z80_CB(0,2,0);_Z80_NEXT_IDX();
+  _ixcb_11:_Z80_CB(0,2,1);_Z80_NEXT_IDX();
+  _ixcb_12:_Z80_CB(0,2,2);_Z80_NEXT_IDX();
+  _ixcb_13:_Z80_CB(0,2,3);_Z80_NEXT_IDX();
+  _ixcb_14:_Z80_CB(0,2,4);_Z80_NEXT_IDX();
+  _ixcb_15:_Z80_CB(0,2,5);_Z80_NEXT_IDX();
+  _ixcb_16:_Z80_CB(0,2,6);_Z80_NEXT_IDX();
+  _ixcb_17:_Z80_CB(0,2,7);_Z80_NEXT_IDX();
+  _ixcb_18:_Z80_CB(0,3,0);_Z80_NEXT_IDX();
+  _ixcb_19:_Z80_CB(0,3,1);_Z80_NEXT_IDX();
+  _ixcb_1a:_Z80_CB(0,3,2);_Z80_NEXT_IDX();
+  _ixcb_1b:_Z80_CB(0,3,3);_Z80_NEXT_IDX();
+  _ixcb_1c:_Z80_CB(0,3,4);_Z80_NEXT_IDX();
+  _ixcb_1d:_Z80_CB(0,3,5);_Z80_NEXT_IDX();
+  _ixcb_1e:_Z80_CB(0,3,6);_Z80_NEXT_IDX();
+  _ixcb_1f:_Z80_CB(0,3,7);_Z80_NEXT_IDX();
+  _ixcb_20:_Z80_CB(0,4,0);_Z80_NEXT_IDX();
+  _ixcb_21:_Z80_CB(0,4,1);_Z80_NEXT_IDX();
+  _ixcb_22:_Z80_CB(0,4,2);_Z80_NEXT_IDX();
+  _ixcb_23:_Z80_CB(0,4,3);_Z80_NEXT_IDX();
+  _ixcb_24:_Z80_CB(0,4,4);_Z80_NEXT_IDX();
+  _ixcb_25:_Z80_CB(0,4,5);_Z80_NEXT_IDX();
+  _ixcb_26:_Z80_CB(0,4,6);_Z80_NEXT_IDX();
+  _ixcb_27:_Z80_CB(0,4,7);_Z80_NEXT_IDX();
+  _ixcb_28:_Z80_CB(0,5,0);_Z80_NEXT_IDX();
+  _ixcb_29:_Z80_CB(0,5,1);_Z80_NEXT_IDX();
+  _ixcb_2a:_Z80_CB(0,5,2);_Z80_NEXT_IDX();
+  _ixcb_2b:_Z80_CB(0,5,3);_Z80_NEXT_IDX();
+  _ixcb_2c:_Z80_CB(0,5,4);_Z80_NEXT_IDX();
+  _ixcb_2d:_Z80_CB(0,5,5);_Z80_NEXT_IDX();
+  _ixcb_2e:_Z80_CB(0,5,6);_Z80_NEXT_IDX();
+  _ixcb_2f:_Z80_CB(0,5,7);_Z80_NEXT_IDX();
+  _ixcb_30:_Z80_CB(0,6,0);_Z80_NEXT_IDX();
+  _ixcb_31:_Z80_CB(0,6,1);_Z80_NEXT_IDX();
+  _ixcb_32:_Z80_CB(0,6,2);_Z80_NEXT_IDX();
+  _ixcb_33:_Z80_CB(0,6,3);_Z80_NEXT_IDX();
+  _ixcb_34:_Z80_CB(0,6,4);_Z80_NEXT_IDX();
+  _ixcb_35:_Z80_CB(0,6,5);_Z80_NEXT_IDX();
+  _ixcb_36:_Z80_CB(0,6,6);_Z80_NEXT_IDX();
+  _ixcb_37:_Z80_CB(0,6,7);_Z80_NEXT_IDX();
+  _ixcb_38:_Z80_CB(0,7,0);_Z80_NEXT_IDX();
+  _ixcb_39:_Z80_CB(0,7,1);_Z80_NEXT_IDX();
+  _ixcb_3a:_Z80_CB(0,7,2);_Z80_NEXT_IDX();
+  _ixcb_3b:_Z80_CB(0,7,3);_Z80_NEXT_IDX();
+  _ixcb_3c:_Z80_CB(0,7,4);_Z80_NEXT_IDX();
+  _ixcb_3d:_Z80_CB(0,7,5);_Z80_NEXT_IDX();
+  _ixcb_3e:_Z80_CB(0,7,6);_Z80_NEXT_IDX();
+  _ixcb_3f:_Z80_CB(0,7,7);_Z80_NEXT_IDX();
+  _ixcb_40:_Z80_CB(1,0,0);_Z80_NEXT_IDX();
+  _ixcb_41:_Z80_CB(1,0,1);_Z80_NEXT_IDX();
+  _ixcb_42:_Z80_CB(1,0,2);_Z80_NEXT_IDX();
+  _ixcb_43:_Z80_CB(1,0,3);_Z80_NEXT_IDX();
+  _ixcb_44:_Z80_CB(1,0,4);_Z80_NEXT_IDX();
+  _ixcb_45:_Z80_CB(1,0,5);_Z80_NEXT_IDX();
+  _ixcb_46:_Z80_CB(1,0,6);_Z80_NEXT_IDX();
+  _ixcb_47:_Z80_CB(1,0,7);_Z80_NEXT_IDX();
+  _ixcb_48:_Z80_CB(1,1,0);_Z80_NEXT_IDX();
+  _ixcb_49:_Z80_CB(1,1,1);_Z80_NEXT_IDX();
+  _ixcb_4a:_Z80_CB(1,1,2);_Z80_NEXT_IDX();
+  _ixcb_4b:_Z80_CB(1,1,3);_Z80_NEXT_IDX();
+  _ixcb_4c:_Z80_CB(1,1,4);_Z80_NEXT_IDX();
+  _ixcb_4d:_Z80_CB(1,1,5);_Z80_NEXT_IDX();
+  _ixcb_4e:_Z80_CB(1,1,6);_Z80_NEXT_IDX();
+  _ixcb_4f:_Z80_CB(1,1,7);_Z80_NEXT_IDX();
+  _ixcb_50:_Z80_CB(1,2,0);_Z80_NEXT_IDX();
+  _ixcb_51:_Z80_CB(1,2,1);_Z80_NEXT_IDX();
+  _ixcb_52:_Z80_CB(1,2,2);_Z80_NEXT_IDX();
+  _ixcb_53:_Z80_CB(1,2,3);_Z80_NEXT_IDX();
+  _ixcb_54:_Z80_CB(1,2,4);_Z80_NEXT_IDX();
+  _ixcb_55:_Z80_CB(1,2,5);_Z80_NEXT_IDX();
+  _ixcb_56:_Z80_CB(1,2,6);_Z80_NEXT_IDX();
+  _ixcb_57:_Z80_CB(1,2,7);_Z80_NEXT_IDX();
+  _ixcb_58:_Z80_CB(1,3,0);_Z80_NEXT_IDX();
+  _ixcb_59:_Z80_CB(1,3,1);_Z80_NEXT_IDX();
+  _ixcb_5a:_Z80_CB(1,3,2);_Z80_NEXT_IDX();
+  _ixcb_5b:_Z80_CB(1,3,3);_Z80_NEXT_IDX();
+  _ixcb_5c:_Z80_CB(1,3,4);_Z80_NEXT_IDX();
+  _ixcb_5d:_Z80_CB(1,3,5);_Z80_NEXT_IDX();
+  _ixcb_5e:_Z80_CB(1,3,6);_Z80_NEXT_IDX();
+  _ixcb_5f:_Z80_CB(1,3,7);_Z80_NEXT_IDX();
+  _ixcb_60:_Z80_CB(1,4,0);_Z80_NEXT_IDX();
+  _ixcb_61:_Z80_CB(1,4,1);_Z80_NEXT_IDX();
+  _ixcb_62:_Z80_CB(1,4,2);_Z80_NEXT_IDX();
+  _ixcb_63:_Z80_CB(1,4,3);_Z80_NEXT_IDX();
+  _ixcb_64:_Z80_CB(1,4,4);_Z80_NEXT_IDX();
+  _ixcb_65:_Z80_CB(1,4,5);_Z80_NEXT_IDX();
+  _ixcb_66:_Z80_CB(1,4,6);_Z80_NEXT_IDX();
+  _ixcb_67:_Z80_CB(1,4,7);_Z80_NEXT_IDX();
+  _ixcb_68:_Z80_CB(1,5,0);_Z80_NEXT_IDX();
+  _ixcb_69:_Z80_CB(1,5,1);_Z80_NEXT_IDX();
+  _ixcb_6a:_Z80_CB(1,5,2);_Z80_NEXT_IDX();
+  _ixcb_6b:_Z80_CB(1,5,3);_Z80_NEXT_IDX();
+  _ixcb_6c:_Z80_CB(1,5,4);_Z80_NEXT_IDX();
+  _ixcb_6d:_Z80_CB(1,5,5);_Z80_NEXT_IDX();
+  _ixcb_6e:_Z80_CB(1,5,6);_Z80_NEXT_IDX();
+  _ixcb_6f:_Z80_CB(1,5,7);_Z80_NEXT_IDX();
+  _ixcb_70:_Z80_CB(1,6,0);_Z80_NEXT_IDX();
+  _ixcb_71:_Z80_CB(1,6,1);_Z80_NEXT_IDX();
+  _ixcb_72:_Z80_CB(1,6,2);_Z80_NEXT_IDX();
+  _ixcb_73:_Z80_CB(1,6,3);_Z80_NEXT_IDX();
+  _ixcb_74:_Z80_CB(1,6,4);_Z80_NEXT_IDX();
+  _ixcb_75:_Z80_CB(1,6,5);_Z80_NEXT_IDX();
+  _ixcb_76:_Z80_CB(1,6,6);_Z80_NEXT_IDX();
+  _ixcb_77:_Z80_CB(1,6,7);_Z80_NEXT_IDX();
+  _ixcb_78:_Z80_CB(1,7,0);_Z80_NEXT_IDX();
+  _ixcb_79:_Z80_CB(1,7,1);_Z80_NEXT_IDX();
+  _ixcb_7a:_Z80_CB(1,7,2);_Z80_NEXT_IDX();
+  _ixcb_7b:_Z80_CB(1,7,3);_Z80_NEXT_IDX();
+  _ixcb_7c:_Z80_CB(1,7,4);_Z80_NEXT_IDX();
+  _ixcb_7d:_Z80_CB(1,7,5);_Z80_NEXT_IDX();
+  _ixcb_7e:_Z80_CB(1,7,6);_Z80_NEXT_IDX();
+  _ixcb_7f:_Z80_CB(1,7,7);_Z80_NEXT_IDX();
+  _ixcb_80:_Z80_CB(2,0,0);_Z80_NEXT_IDX();
+  _ixcb_81:_Z80_CB(2,0,1);_Z80_NEXT_IDX();
+  _ixcb_82:_Z80_CB(2,0,2);_Z80_NEXT_IDX();
+  _ixcb_83:_Z80_CB(2,0,3);_Z80_NEXT_IDX();
+  _ixcb_84:_Z80_CB(2,0,4);_Z80_NEXT_IDX();
+  _ixcb_85:_Z80_CB(2,0,5);_Z80_NEXT_IDX();
+  _ixcb_86:_Z80_CB(2,0,6);_Z80_NEXT_IDX();
+  _ixcb_87:_Z80_CB(2,0,7);_Z80_NEXT_IDX();
+  _ixcb_88:_Z80_CB(2,1,0);_Z80_NEXT_IDX();
+  _ixcb_89:_Z80_CB(2,1,1);_Z80_NEXT_IDX();
+  _ixcb_8a:_Z80_CB(2,1,2);_Z80_NEXT_IDX();
+  _ixcb_8b:_Z80_CB(2,1,3);_Z80_NEXT_IDX();
+  _ixcb_8c:_Z80_CB(2,1,4);_Z80_NEXT_IDX();
+  _ixcb_8d:_Z80_CB(2,1,5);_Z80_NEXT_IDX();
+  _ixcb_8e:_Z80_CB(2,1,6);_Z80_NEXT_IDX();
+  _ixcb_8f:_Z80_CB(2,1,7);_Z80_NEXT_IDX();
+  _ixcb_90:_Z80_CB(2,2,0);_Z80_NEXT_IDX();
+  _ixcb_91:_Z80_CB(2,2,1);_Z80_NEXT_IDX();
+  _ixcb_92:_Z80_CB(2,2,2);_Z80_NEXT_IDX();
+  _ixcb_93:_Z80_CB(2,2,3);_Z80_NEXT_IDX();
+  _ixcb_94:_Z80_CB(2,2,4);_Z80_NEXT_IDX();
+  _ixcb_95:_Z80_CB(2,2,5);_Z80_NEXT_IDX();
+  _ixcb_96:_Z80_CB(2,2,6);_Z80_NEXT_IDX();
+  _ixcb_97:_Z80_CB(2,2,7);_Z80_NEXT_IDX();
+  _ixcb_98:_Z80_CB(2,3,0);_Z80_NEXT_IDX();
+  _ixcb_99:_Z80_CB(2,3,1);_Z80_NEXT_IDX();
+  _ixcb_9a:_Z80_CB(2,3,2);_Z80_NEXT_IDX();
+  _ixcb_9b:_Z80_CB(2,3,3);_Z80_NEXT_IDX();
+  _ixcb_9c:_Z80_CB(2,3,4);_Z80_NEXT_IDX();
+  _ixcb_9d:_Z80_CB(2,3,5);_Z80_NEXT_IDX();
+  _ixcb_9e:_Z80_CB(2,3,6);_Z80_NEXT_IDX();
+  _ixcb_9f:_Z80_CB(2,3,7);_Z80_NEXT_IDX();
+  _ixcb_a0:_Z80_CB(2,4,0);_Z80_NEXT_IDX();
+  _ixcb_a1:_Z80_CB(2,4,1);_Z80_NEXT_IDX();
+  _ixcb_a2:_Z80_CB(2,4,2);_Z80_NEXT_IDX();
+  _ixcb_a3:_Z80_CB(2,4,3);_Z80_NEXT_IDX();
+  _ixcb_a4:_Z80_CB(2,4,4);_Z80_NEXT_IDX();
+  _ixcb_a5:_Z80_CB(2,4,5);_Z80_NEXT_IDX();
+  _ixcb_a6:_Z80_CB(2,4,6);_Z80_NEXT_IDX();
+  _ixcb_a7:_Z80_CB(2,4,7);_Z80_NEXT_IDX();
+  _ixcb_a8:_Z80_CB(2,5,0);_Z80_NEXT_IDX();
+  _ixcb_a9:_Z80_CB(2,5,1);_Z80_NEXT_IDX();
+  _ixcb_aa:_Z80_CB(2,5,2);_Z80_NEXT_IDX();
+  _ixcb_ab:_Z80_CB(2,5,3);_Z80_NEXT_IDX();
+  _ixcb_ac:_Z80_CB(2,5,4);_Z80_NEXT_IDX();
+  _ixcb_ad:_Z80_CB(2,5,5);_Z80_NEXT_IDX();
+  _ixcb_ae:_Z80_CB(2,5,6);_Z80_NEXT_IDX();
+  _ixcb_af:_Z80_CB(2,5,7);_Z80_NEXT_IDX();
+  _ixcb_b0:_Z80_CB(2,6,0);_Z80_NEXT_IDX();
+  _ixcb_b1:_Z80_CB(2,6,1);_Z80_NEXT_IDX();
+  _ixcb_b2:_Z80_CB(2,6,2);_Z80_NEXT_IDX();
+  _ixcb_b3:_Z80_CB(2,6,3);_Z80_NEXT_IDX();
+  _ixcb_b4:_Z80_CB(2,6,4);_Z80_NEXT_IDX();
+  _ixcb_b5:_Z80_CB(2,6,5);_Z80_NEXT_IDX();
+  _ixcb_b6:_Z80_CB(2,6,6);_Z80_NEXT_IDX();
+  _ixcb_b7:_Z80_CB(2,6,7);_Z80_NEXT_IDX();
+  _ixcb_b8:_Z80_CB(2,7,0);_Z80_NEXT_IDX();
+  _ixcb_b9:_Z80_CB(2,7,1);_Z80_NEXT_IDX();
+  _ixcb_ba:_Z80_CB(2,7,2);_Z80_NEXT_IDX();
+  _ixcb_bb:_Z80_CB(2,7,3);_Z80_NEXT_IDX();
+  _ixcb_bc:_Z80_CB(2,7,4);_Z80_NEXT_IDX();
+  _ixcb_bd:_Z80_CB(2,7,5);_Z80_NEXT_IDX();
+  _ixcb_be:_Z80_CB(2,7,6);_Z80_NEXT_IDX();
+  _ixcb_bf:_Z80_CB(2,7,7);_Z80_NEXT_IDX();
+  _ixcb_c0:_Z80_CB(3,0,0);_Z80_NEXT_IDX();
+  _ixcb_c1:_Z80_CB(3,0,1);_Z80_NEXT_IDX();
+  _ixcb_c2:_Z80_CB(3,0,2);_Z80_NEXT_IDX();
+  _ixcb_c3:_Z80_CB(3,0,3);_Z80_NEXT_IDX();
+  _ixcb_c4:_Z80_CB(3,0,4);_Z80_NEXT_IDX();
+  _ixcb_c5:_Z80_CB(3,0,5);_Z80_NEXT_IDX();
+  _ixcb_c6:_Z80_CB(3,0,6);_Z80_NEXT_IDX();
+  _ixcb_c7:_Z80_CB(3,0,7);_Z80_NEXT_IDX();
+  _ixcb_c8:_Z80_CB(3,1,0);_Z80_NEXT_IDX();
+  _ixcb_c9:_Z80_CB(3,1,1);_Z80_NEXT_IDX();
+  _ixcb_ca:_Z80_CB(3,1,2);_Z80_NEXT_IDX();
+  _ixcb_cb:_Z80_CB(3,1,3);_Z80_NEXT_IDX();
+  _ixcb_cc:_Z80_CB(3,1,4);_Z80_NEXT_IDX();
+  _ixcb_cd:_Z80_CB(3,1,5);_Z80_NEXT_IDX();
+  _ixcb_ce:_Z80_CB(3,1,6);_Z80_NEXT_IDX();
+  _ixcb_cf:_Z80_CB(3,1,7);_Z80_NEXT_IDX();
+  _ixcb_d0:_Z80_CB(3,2,0);_Z80_NEXT_IDX();
+  _ixcb_d1:_Z80_CB(3,2,1);_Z80_NEXT_IDX();
+  _ixcb_d2:_Z80_CB(3,2,2);_Z80_NEXT_IDX();
+  _ixcb_d3:_Z80_CB(3,2,3);_Z80_NEXT_IDX();
+  _ixcb_d4:_Z80_CB(3,2,4);_Z80_NEXT_IDX();
+  _ixcb_d5:_Z80_CB(3,2,5);_Z80_NEXT_IDX();
+  _ixcb_d6:_Z80_CB(3,2,6);_Z80_NEXT_IDX();
+  _ixcb_d7:_Z80_CB(3,2,7);_Z80_NEXT_IDX();
+  _ixcb_d8:_Z80_CB(3,3,0);_Z80_NEXT_IDX();
+  _ixcb_d9:_Z80_CB(3,3,1);_Z80_NEXT_IDX();
+  _ixcb_da:_Z80_CB(3,3,2);_Z80_NEXT_IDX();
+  _ixcb_db:_Z80_CB(3,3,3);_Z80_NEXT_IDX();
+  _ixcb_dc:_Z80_CB(3,3,4);_Z80_NEXT_IDX();
+  _ixcb_dd:_Z80_CB(3,3,5);_Z80_NEXT_IDX();
+  _ixcb_de:_Z80_CB(3,3,6);_Z80_NEXT_IDX();
+  _ixcb_df:_Z80_CB(3,3,7);_Z80_NEXT_IDX();
+  _ixcb_e0:_Z80_CB(3,4,0);_Z80_NEXT_IDX();
+  _ixcb_e1:_Z80_CB(3,4,1);_Z80_NEXT_IDX();
+  _ixcb_e2:_Z80_CB(3,4,2);_Z80_NEXT_IDX();
+  _ixcb_e3:_Z80_CB(3,4,3);_Z80_NEXT_IDX();
+  _ixcb_e4:_Z80_CB(3,4,4);_Z80_NEXT_IDX();
+  _ixcb_e5:_Z80_CB(3,4,5);_Z80_NEXT_IDX();
+  _ixcb_e6:_Z80_CB(3,4,6);_Z80_NEXT_IDX();
+  _ixcb_e7:_Z80_CB(3,4,7);_Z80_NEXT_IDX();
+  _ixcb_e8:_Z80_CB(3,5,0);_Z80_NEXT_IDX();
+  _ixcb_e9:_Z80_CB(3,5,1);_Z80_NEXT_IDX();
+  _ixcb_ea:_Z80_CB(3,5,2);_Z80_NEXT_IDX();
+  _ixcb_eb:_Z80_CB(3,5,3);_Z80_NEXT_IDX();
+  _ixcb_ec:_Z80_CB(3,5,4);_Z80_NEXT_IDX();
+  _ixcb_ed:_Z80_CB(3,5,5);_Z80_NEXT_IDX();
+  _ixcb_ee:_Z80_CB(3,5,6);_Z80_NEXT_IDX();
+  _ixcb_ef:_Z80_CB(3,5,7);_Z80_NEXT_IDX();
+  _ixcb_f0:_Z80_CB(3,6,0);_Z80_NEXT_IDX();
+  _ixcb_f1:_Z80_CB(3,6,1);_Z80_NEXT_IDX();
+  _ixcb_f2:_Z80_CB(3,6,2);_Z80_NEXT_IDX();
+  _ixcb_f3:_Z80_CB(3,6,3);_Z80_NEXT_IDX();
+  _ixcb_f4:_Z80_CB(3,6,4);_Z80_NEXT_IDX();
+  _ixcb_f5:_Z80_CB(3,6,5);_Z80_NEXT_IDX();
+  _ixcb_f6:_Z80_CB(3,6,6);_Z80_NEXT_IDX();
+  _ixcb_f7:_Z80_CB(3,6,7);_Z80_NEXT_IDX();
+  _ixcb_f8:_Z80_CB(3,7,0);_Z80_NEXT_IDX();
+  _ixcb_f9:_Z80_CB(3,7,1);_Z80_NEXT_IDX();
+  _ixcb_fa:_Z80_CB(3,7,2);_Z80_NEXT_IDX();
+  _ixcb_fb:_Z80_CB(3,7,3);_Z80_NEXT_IDX();
+  _ixcb_fc:_Z80_CB(3,7,4);_Z80_NEXT_IDX();
+  _ixcb_fd:_Z80_CB(3,7,5);_Z80_NEXT_IDX();
+  _ixcb_fe:_Z80_CB(3,7,6);_Z80_NEXT_IDX();
+  _ixcb_ff:_Z80_CB(3,7,7);_Z80_NEXT_IDX();
+#undef _IDX
+#define _IDX() (0!=(r2&(_BIT_USE_IX|_BIT_USE_IY)))
+  _z80_slow:
+  {
+    bool nmi = 0 != ((pins & (pre_pins ^ pins)) & Z80_NMI);
+    if (nmi || (((pins & (Z80_INT|Z80_BUSREQ))==Z80_INT) && (r2 & _BIT_IFF1))) {
+      r2 &= ~_BIT_IFF1;
+      if (pins & Z80_INT) {
+        r2 &= ~_BIT_IFF2;
+      }
+      if (pins & Z80_HALT) {
+        pins &= ~Z80_HALT;
+        pc++;
+      }
+      _SA(pc);
+      if (nmi) {
+        _TWM(5,Z80_M1|Z80_MREQ|Z80_RD);_BUMPR();
+        uint16_t sp = _G_SP();
+        _MW(--sp,pc>>8);
+        _MW(--sp,pc);
+        _S_SP(sp);
+        pc = 0x0066;
+        _S_WZ(pc);
+      }
+      else {
+        _TWM(4,Z80_M1|Z80_IORQ);
+        const uint8_t int_vec = _GD();
+        _BUMPR();
+        _T(2);
+        switch (_G_IM()) {
+          case 0:
+            break;
+          case 1:
+            {
+              uint16_t sp = _G_SP();
+              _MW(--sp,pc>>8);
+              _MW(--sp,pc);
+              _S_SP(sp);
+              pc = 0x0038;
+              _S_WZ(pc);
+            }
+            break;
+          case 2:
+            {
+              uint16_t sp = _G_SP();
+              _MW(--sp,pc>>8);
+              _MW(--sp,pc);
+              _S_SP(sp);
+              addr = (_G_I()<<8) | (int_vec & 0xFE);
+              uint8_t z,w;
+              _MR(addr++,z);
+              _MR(addr,w);
+              pc = (w<<8)|z;
+              _S_WZ(pc);
+            }
+            break;
+        }
+       }
+    }
+  }
+  if (trap) {
+    int trap_id = trap(pc,ticks,pins,cpu->trap_user_data);
+    if (trap_id) {
+      cpu->trap_id=trap_id;
+      goto _z80_exit;
+    }
+  }
+  pins&=~Z80_INT;
+  /* delay-enable interrupt flags */
+  if (r2 & _BIT_EI) {
+    r2 &= ~_BIT_EI;
+    r2 |= (_BIT_IFF1 | _BIT_IFF2);
+  }
+  pre_pins = pins;
+  if (ticks >= num_ticks) {
+    goto _z80_exit;
+  }
+  _FETCH(op);
+  goto *_z80_op[op];
+  _z80_exit:
+  _S_PC(pc);
+  r0 = _z80_flush_r0(ws, r0, r2);
+  r1 = _z80_flush_r1(ws, r1, r2);
+  r2 = (r2 & ~_BITS_MAP_REGS) | map_bits;
+  cpu->bc_de_hl_fa = r0;
+  cpu->wz_ix_iy_sp = r1;
+  cpu->im_ir_pc_bits = r2;
+  cpu->bc_de_hl_fa_ = r3;
+  cpu->pins = pins;
+  return ticks;
+}
+#undef _Z80_NEXT
+#undef _Z80_NEXT_IDX
+#undef _Z80_CB
@@ -53,6 +53,14 @@ static inline void beeper_set(beeper_t* beeper, bool state) {
 static inline void beeper_toggle(beeper_t* beeper) {
     beeper->state = !beeper->state;
 }
+/* return number of ticks until beeper_tick() returns true */
+static inline int beeper_ticks_to_sample(beeper_t* beeper) {
+    return (beeper->counter > 0) ? ((beeper->counter + BEEPER_FIXEDPOINT_SCALE - 1) / BEEPER_FIXEDPOINT_SCALE) : 1;
+}
+/* advance the beeper by num_ticks, must be less than beeper_ticks_to_sample() */
+static inline void beeper_skip(beeper_t* beeper, int num_ticks) {
+    beeper->counter -= num_ticks * BEEPER_FIXEDPOINT_SCALE;
+}
 /* tick the beeper, return true if a new sample is ready */
 static inline bool beeper_tick(beeper_t* beeper) {
     /* generate a new sample? */
@@ -234,6 +234,52 @@
     - display needling
     - audio volume is currently not implemented
 
+    ## Fast-Forward
+
+    Video decoding and audio sample generation can be switched off
+    at runtime with kc85_enable_video() and kc85_enable_audio() (both
+    are on after kc85_init()). This is useful for running the emulator
+    faster than realtime, only the last emulated frame needs to be
+    decoded into the pixel buffer. Note that the beepers aren't ticked
+    while audio is off, the emulated system itself isn't affected.
+
+    ## Dirty Scanlines
+
+    CPU writes into the displayed video memory mark the affected scanlines
+    as dirty (one scanline for a pixel byte, and for KC85/4 color bytes,
+    the 4 scanlines of an 8x4 color block for KC85/2 and /3 color bytes).
+    Only dirty scanlines are decoded into the pixel buffer. Toggling the
+    blink flag, changing the blink-enable bit, switching the displayed
+    image on the KC85/4, or writing memory from outside the CPU (e.g.
+    kc85_quickload()) marks all scanlines dirty.
+    kc85_display_changed() returns true if any scanline has been decoded
+    since the last call, the pixel buffer doesn't need to be uploaded
+    to the GPU otherwise.
+
+    ## Save States
+
+    kc85_save_state() writes the complete emulator state (CPU, CTC, PIO,
+    beepers, keyboard buffer, memory mapping, RAM and expansion modules)
+    into a memory buffer, kc85_load_state() restores it. A buffer of
+    kc85_max_state_size() bytes is always big enough, the actual
+    size is smaller because only the RAM banks which exist in the emulated
+    model are saved, and ROMs aren't saved at all. A state can only be
+    loaded into a kc85_t of the same model type, and which has been
+    initialized with the same ROM images. States are plain memory dumps of
+    the chip structs, and are only compatible between builds of the same
+    emulator version (KC85_STATE_VERSION) on the same platform. Host
+    resources (pixel buffer, callbacks, user data) and the video/audio
+    enabled flags are not part of the state. After kc85_load_state()
+    all scanlines are dirty.
+
+    ## Multiple Instances
+
+    kc85_t instances are independent of each other and can run on
+    different threads, except for some lookup tables which are shared
+    by all instances and initialized in the first kc85_init() call. The
+    first kc85_init() must have returned before instances are created
+    or run on other threads.
+
     ## zlib/libpng license
 
     Copyright (c) 2018 Andre Weissflog
@@ -264,6 +310,7 @@ extern "C" {
 #define KC85_MAX_TAPE_SIZE (64 * 1024)      /* max size of a snapshot file in bytes */
 #define KC85_NUM_SLOTS (2)                  /* 2 expansion slots in main unit, each needs one mem_t layer! */
 #define KC85_EXP_BUFSIZE (KC85_NUM_SLOTS*64*1024) /* expansion system buffer size (64 KB per slot) */
+#define KC85_STATE_VERSION (1)              /* bumped when the kc85_save_state() format changes */
 
 /* IO bits */
 #define KC85_PIO_A_CAOS_ROM        (1<<0)
@@ -393,6 +440,10 @@ typedef struct {
     int scanline_period;
     int scanline_counter;
     int cur_scanline;
+    bool video_enabled;     /* decode scanlines into pixel buffer */
+    bool audio_enabled;     /* generate audio samples */
+    uint32_t dirty_lines[8];    /* one bit per visible scanline which needs to be decoded */
+    bool display_changed;   /* true if a scanline has been decoded since kc85_display_changed() */
 
     clk_t clk;
     kbd_t kbd;
@@ -428,8 +479,14 @@ int kc85_display_width(kc85_t* sys);
 int kc85_display_height(kc85_t* sys);
 /* reset a KC85 instance */
 void kc85_reset(kc85_t* sys);
-/* run KC85 emulation for a given number of microseconds */
-void kc85_exec(kc85_t* sys, uint32_t micro_seconds);
+/* run KC85 emulation for a given number of microseconds, return executed ticks */
+uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds);
+/* switch scanline decoding into the pixel buffer on/off */
+void kc85_enable_video(kc85_t* sys, bool enabled);
+/* switch audio sample generation on/off */
+void kc85_enable_audio(kc85_t* sys, bool enabled);
+/* return true if the pixel buffer has changed since the last call */
+bool kc85_display_changed(kc85_t* sys);
 /* send a key-down event */
 void kc85_key_down(kc85_t* sys, int key_code);
 /* send a key-up event */
@@ -458,6 +515,12 @@ const char* kc85_slot_mod_name(kc85_t* sys, uint8_t slot_addr);
 uint8_t kc85_slot_ctrl(kc85_t* sys, uint8_t slot_addr);
 /* load a .KCC or .TAP snapshot file into the emulator */
 bool kc85_quickload(kc85_t* sys, const uint8_t* ptr, int num_bytes);
+/* get the max byte size of a state written by kc85_save_state() */
+int kc85_max_state_size(void);
+/* save the emulator state into a buffer, return number of bytes written (0 if buffer too small) */
+int kc85_save_state(kc85_t* sys, void* ptr, int max_bytes);
+/* restore the emulator state from a buffer written by kc85_save_state() */
+bool kc85_load_state(kc85_t* sys, const void* ptr, int num_bytes);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -470,6 +533,14 @@ bool kc85_quickload(kc85_t* sys, const uint8_t* ptr, int num_bytes);
     #include <assert.h>
     #define CHIPS_ASSERT(c) assert(c)
 #endif
+/* define KC85_NO_SIMD to use the scalar video decoder */
+#if !defined(KC85_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+    #include <emmintrin.h>
+    #define _KC85_USE_SSE2 (1)
+#elif !defined(KC85_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #include <arm_neon.h>
+    #define _KC85_USE_NEON (1)
+#endif
 
 #define _KC85_DISPLAY_WIDTH (320)
 #define _KC85_DISPLAY_HEIGHT (256)
@@ -483,6 +554,10 @@ static uint64_t _kc85_tick(int num, uint64_t pins, void* user_data);
 static uint8_t _kc85_pio_in(int port_id, void* user_data);
 static void _kc85_pio_out(int port_id, uint8_t data, void* user_data);
 static void _kc85_decode_scanline(kc85_t* sys);
+static void _kc85_init_irm_lut(void);
+static void _kc85_init_decode_luts(void);
+static void _kc85_dirty_all(kc85_t* sys);
+static inline void _kc85_track_irm_write(kc85_t* sys, uint16_t addr);
 static void _kc85_update_memory_map(kc85_t* sys);
 static void _kc85_init_memory_map(kc85_t* sys);
 static void _kc85_handle_keyboard(kc85_t* sys);
@@ -582,6 +657,11 @@ void kc85_init(kc85_t* sys, const kc85_desc_t* desc) {
 
     sys->scanline_period = (sys->type == KC85_TYPE_4) ? 113 : 112;
     sys->scanline_counter = sys->scanline_period;
+    sys->video_enabled = true;
+    sys->audio_enabled = true;
+    _kc85_init_irm_lut();
+    _kc85_init_decode_luts();
+    _kc85_dirty_all(sys);
 
     /* expansion module system */
     _kc85_exp_init(sys);
@@ -640,6 +720,7 @@ void kc85_reset(kc85_t* sys) {
     sys->io86 = 0;
     sys->cur_scanline = 0;
     sys->scanline_counter = sys->scanline_period;
+    _kc85_dirty_all(sys);
     _kc85_exp_reset(sys);
     sys->pio_a = KC85_PIO_A_RAM | KC85_PIO_A_RAM_RO | KC85_PIO_A_IRM | KC85_PIO_A_CAOS_ROM;
     _kc85_update_memory_map(sys);
@@ -648,13 +729,31 @@ void kc85_reset(kc85_t* sys) {
     z80_set_pc(&sys->cpu, 0xE000);
 }
 
-void kc85_exec(kc85_t* sys, uint32_t micro_seconds) {
+uint32_t kc85_exec(kc85_t* sys, uint32_t micro_seconds) {
     CHIPS_ASSERT(sys && sys->valid);
     uint32_t ticks_to_run = clk_ticks_to_run(&sys->clk, micro_seconds);
     uint32_t ticks_executed = z80_exec(&sys->cpu, ticks_to_run);
     clk_ticks_executed(&sys->clk, ticks_executed);
     kbd_update(&sys->kbd);
     _kc85_handle_keyboard(sys);
+    return ticks_executed;
+}
+
+void kc85_enable_video(kc85_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->video_enabled = enabled;
+}
+
+void kc85_enable_audio(kc85_t* sys, bool enabled) {
+    CHIPS_ASSERT(sys && sys->valid);
+    sys->audio_enabled = enabled;
+}
+
+bool kc85_display_changed(kc85_t* sys) {
+    CHIPS_ASSERT(sys && sys->valid);
+    bool changed = sys->display_changed;
+    sys->display_changed = false;
+    return changed;
 }
 
 void kc85_key_down(kc85_t* sys, int key_code) {
@@ -674,8 +773,14 @@ static uint64_t _kc85_tick(int num_ticks, uint64_t pins, void* user_data) {
     sys->scanline_counter -= num_ticks;
     if (sys->scanline_counter <= 0) {
         sys->scanline_counter += sys->scanline_period;
-        if (sys->cur_scanline < _KC85_DISPLAY_HEIGHT) {
-            _kc85_decode_scanline(sys);
+        if (sys->video_enabled && (sys->cur_scanline < _KC85_DISPLAY_HEIGHT)) {
+            const int y = sys->cur_scanline;
+            const uint32_t mask = 1U<<(y & 31);
+            if (sys->dirty_lines[y>>5] & mask) {
+                sys->dirty_lines[y>>5] &= ~mask;
+                _kc85_decode_scanline(sys);
+                sys->display_changed = true;
+            }
         }
         sys->cur_scanline++;
         /* vertical blank signal? this triggers CTC2 for the video blinking effect */
@@ -685,8 +790,32 @@ static uint64_t _kc85_tick(int num_ticks, uint64_t pins, void* user_data) {
         }
     }
 
-    /* tick the CTC and beepers */
+    /* tick the CTC and beepers, ticks without any CTC or beeper event
+       are skipped in one step (define KC85_TICK_REFERENCE to tick
+       everything one by one for comparison)
+    */
     for (int i = 0; i < num_ticks; i++) {
+        #if !defined(KC85_TICK_REFERENCE)
+        int skip = z80ctc_ticks_to_event(&sys->ctc, pins, num_ticks - i + 1) - 1;
+        if (sys->audio_enabled && (skip > 0)) {
+            const int b1 = beeper_ticks_to_sample(&sys->beeper_1) - 1;
+            const int b2 = beeper_ticks_to_sample(&sys->beeper_2) - 1;
+            skip = (b1 < skip) ? b1 : skip;
+            skip = (b2 < skip) ? b2 : skip;
+        }
+        if (skip > 0) {
+            z80ctc_skip(&sys->ctc, skip);
+            if (sys->audio_enabled) {
+                beeper_skip(&sys->beeper_1, skip);
+                beeper_skip(&sys->beeper_2, skip);
+            }
+            i += skip;
+            pins &= Z80_PIN_MASK;
+            if (i >= num_ticks) {
+                break;
+            }
+        }
+        #endif
         pins = z80ctc_tick(&sys->ctc, pins);
         /* CTC channels 0 and 1 triggers control audio frequencies */
         if (pins & Z80CTC_ZCTO0) {
@@ -698,17 +827,22 @@ static uint64_t _kc85_tick(int num_ticks, uint64_t pins, void* user_data) {
         /* CTC channel 2 trigger controls video blink frequency */
         if (pins & Z80CTC_ZCTO2) {
             sys->blink_flag = !sys->blink_flag;
+            if (sys->pio_b & KC85_PIO_B_BLINK_ENABLED) {
+                _kc85_dirty_all(sys);
+            }
         }
         pins &= Z80_PIN_MASK;
-        beeper_tick(&sys->beeper_1);
-        if (beeper_tick(&sys->beeper_2)) {
-            /* new audio sample ready */
-            sys->sample_buffer[sys->sample_pos++] = sys->beeper_1.sample + sys->beeper_2.sample;
-            if (sys->sample_pos == sys->num_samples) {
-                if (sys->audio_cb) {
-                    sys->audio_cb(sys->sample_buffer, sys->num_samples, sys->user_data);
+        if (sys->audio_enabled) {
+            beeper_tick(&sys->beeper_1);
+            if (beeper_tick(&sys->beeper_2)) {
+                /* new audio sample ready */
+                sys->sample_buffer[sys->sample_pos++] = sys->beeper_1.sample + sys->beeper_2.sample;
+                if (sys->sample_pos == sys->num_samples) {
+                    if (sys->audio_cb) {
+                        sys->audio_cb(sys->sample_buffer, sys->num_samples, sys->user_data);
+                    }
+                    sys->sample_pos = 0;
                 }
-                sys->sample_pos = 0;
             }
         }
     }    
@@ -722,6 +856,9 @@ static uint64_t _kc85_tick(int num_ticks, uint64_t pins, void* user_data) {
         }
         else if (pins & Z80_WR) {
             mem_wr(&sys->mem, addr, Z80_GET_DATA(pins));
+            if (addr >= 0x8000) {
+                _kc85_track_irm_write(sys, addr);
+            }
         }
     }
     else if (pins & Z80_IORQ) {
@@ -797,6 +934,9 @@ static uint64_t _kc85_tick(int num_ticks, uint64_t pins, void* user_data) {
                     case 0x04:
                         /* port 0x84, KC85/4 only, this is a write-only 8-bit latch */
                         if ((KC85_TYPE_4 == sys->type) && (pins & Z80_WR)) {
+                            if ((sys->io84 ^ data) & KC85_IO84_SEL_VIEW_IMG) {
+                                _kc85_dirty_all(sys);
+                            }
                             sys->io84 = data;
                             _kc85_update_memory_map(sys);
                         }
@@ -835,6 +975,9 @@ static void _kc85_pio_out(int port_id, uint8_t data, void* user_data) {
         sys->pio_a = data;
     }
     else {
+        if ((sys->pio_b ^ data) & KC85_PIO_B_BLINK_ENABLED) {
+            _kc85_dirty_all(sys);
+        }
         sys->pio_b = data;
         /* FIXME: audio volume */
     }
@@ -896,6 +1039,140 @@ static inline void _kc85_decode_8pixels(uint32_t* ptr, uint8_t pixels, uint8_t c
     ptr[7] = pixels & 0x01 ? fg : bg;   
 }
 
+/*
+    Lookup tables for the table-driven line decoder (same result
+    as _kc85_decode_8pixels(), which is kept as reference):
+
+    _kc85_pixel_mask: the 8 pixel bits of a byte expanded into 8
+    32-bit lane masks (all bits set for foreground pixels)
+
+    _kc85_color_lut: the foreground and background color for each
+    color byte, with and without the blink flag
+*/
+static uint32_t _kc85_pixel_mask[256][8];
+static uint32_t _kc85_color_lut[2][256][2];
+static bool _kc85_decode_luts_valid = false;
+
+/* decode a scanline of num bytes into 8*num RGBA8 pixels */
+static void _kc85_decode_line(uint32_t* dst, const uint8_t* pixels, const uint8_t* colors, int num, bool blink_bg) {
+    const uint32_t (*color_lut)[2] = _kc85_color_lut[blink_bg ? 1 : 0];
+    for (int x = 0; x < num; x++, dst += 8) {
+        const uint32_t* mask = _kc85_pixel_mask[pixels[x]];
+        const uint32_t fg = color_lut[colors[x]][0];
+        const uint32_t bg = color_lut[colors[x]][1];
+        #if defined(_KC85_USE_SSE2)
+            const __m128i fg4 = _mm_set1_epi32((int)fg);
+            const __m128i bg4 = _mm_set1_epi32((int)bg);
+            const __m128i m0 = _mm_loadu_si128((const __m128i*)&mask[0]);
+            const __m128i m1 = _mm_loadu_si128((const __m128i*)&mask[4]);
+            _mm_storeu_si128((__m128i*)&dst[0], _mm_or_si128(_mm_and_si128(m0, fg4), _mm_andnot_si128(m0, bg4)));
+            _mm_storeu_si128((__m128i*)&dst[4], _mm_or_si128(_mm_and_si128(m1, fg4), _mm_andnot_si128(m1, bg4)));
+        #elif defined(_KC85_USE_NEON)
+            const uint32x4_t fg4 = vdupq_n_u32(fg);
+            const uint32x4_t bg4 = vdupq_n_u32(bg);
+            vst1q_u32(&dst[0], vbslq_u32(vld1q_u32(&mask[0]), fg4, bg4));
+            vst1q_u32(&dst[4], vbslq_u32(vld1q_u32(&mask[4]), fg4, bg4));
+        #else
+            for (int i = 0; i < 8; i++) {
+                dst[i] = (fg & mask[i]) | (bg & ~mask[i]);
+            }
+        #endif
+    }
+}
+
+static void _kc85_init_decode_luts(void) {
+    if (_kc85_decode_luts_valid) {
+        return;
+    }
+    _kc85_decode_luts_valid = true;
+    for (int p = 0; p < 256; p++) {
+        for (int i = 0; i < 8; i++) {
+            _kc85_pixel_mask[p][i] = (p & (0x80>>i)) ? 0xFFFFFFFF : 0;
+        }
+    }
+    for (int blink = 0; blink < 2; blink++) {
+        for (int c = 0; c < 256; c++) {
+            const uint32_t bg = _kc85_bg_pal[c & 0x7];
+            _kc85_color_lut[blink][c][0] = (blink && (c & 0x80)) ? bg : _kc85_fg_pal[(c>>3)&0xF];
+            _kc85_color_lut[blink][c][1] = bg;
+        }
+    }
+}
+
+/*
+    Reverse lookup table from KC85/2 and /3 video memory offsets to the
+    first scanline which displays the byte (-1 if the byte isn't visible),
+    pixel bytes are at 0x0000..0x27FF and affect one scanline, color
+    bytes at 0x2800..0x31FF affect 4 scanlines. The KC85/4 needs no
+    table, the offset of a pixel or color byte is (y | (x<<8)).
+*/
+static int16_t _kc85_irm_lut[0x4000];
+static bool _kc85_irm_lut_valid = false;
+
+static void _kc85_init_irm_lut(void) {
+    if (_kc85_irm_lut_valid) {
+        return;
+    }
+    _kc85_irm_lut_valid = true;
+    for (int i = 0; i < 0x4000; i++) {
+        _kc85_irm_lut[i] = -1;
+    }
+    /* same address computation as _kc85_decode_scanline() */
+    for (int y = 0; y < _KC85_DISPLAY_HEIGHT; y++) {
+        const int left_pixel_offset  = (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>4)&0xF)<<9);
+        const int left_color_offset  = (((y>>2)&0x3f)<<5);
+        const int right_pixel_offset = (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>6)&0x3)<<9);
+        const int right_color_offset = (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | (((y>>6)&0x3)<<7);
+        for (int x = 0; x < (_KC85_DISPLAY_WIDTH>>3); x++) {
+            int pixel_offset, color_offset;
+            if (x < 0x20) {
+                pixel_offset = x | left_pixel_offset;
+                color_offset = x | left_color_offset;
+            }
+            else {
+                pixel_offset = 0x2000 + ((x&0x7) | right_pixel_offset);
+                color_offset = 0x0800 + ((x&0x7) | right_color_offset);
+            }
+            _kc85_irm_lut[pixel_offset] = y;
+            _kc85_irm_lut[0x2800 + color_offset] = y & ~3;
+        }
+    }
+}
+
+static void _kc85_dirty_all(kc85_t* sys) {
+    memset(sys->dirty_lines, 0xFF, sizeof(sys->dirty_lines));
+}
+
+/* called after a CPU write at 0x8000 and above, mark scanlines dirty if video memory was written */
+static inline void _kc85_track_irm_write(kc85_t* sys, uint16_t addr) {
+    const uintptr_t ptr = (uintptr_t) (sys->mem.page_table[addr>>MEM_PAGE_SHIFT].write_ptr + (addr & MEM_PAGE_MASK));
+    const uintptr_t irm = (uintptr_t) sys->ram[_KC85_IRM0_PAGE];
+    if ((ptr < irm) || (ptr >= (irm + 4*0x4000))) {
+        return;
+    }
+    const int bank = (int)((ptr - irm)>>14);
+    const int offset = (int)((ptr - irm) & 0x3FFF);
+    if (KC85_TYPE_4 == sys->type) {
+        /* only the displayed pixel/color bank pair matters */
+        if (((bank>>1) == (sys->io84 & KC85_IO84_SEL_VIEW_IMG)) && (offset < 0x2800)) {
+            const int y = offset & 0xFF;
+            sys->dirty_lines[y>>5] |= 1U<<(y & 31);
+        }
+    }
+    else if (0 == bank) {
+        const int y = _kc85_irm_lut[offset];
+        if (y >= 0) {
+            if (offset >= 0x2800) {
+                /* a color byte covers 4 scanlines, y is a multiple of 4 */
+                sys->dirty_lines[y>>5] |= 0xFU<<(y & 31);
+            }
+            else {
+                sys->dirty_lines[y>>5] |= 1U<<(y & 31);
+            }
+        }
+    }
+}
+
 static void _kc85_decode_scanline(kc85_t* sys) {
     /* early out if no pixel buffer was set */
     if (!sys->pixel_buffer) {
@@ -905,15 +1182,17 @@ static void _kc85_decode_scanline(kc85_t* sys) {
     const bool blink_bg = sys->blink_flag && (sys->pio_b & KC85_PIO_B_BLINK_ENABLED);
     const int width = _KC85_DISPLAY_WIDTH>>3;
     unsigned int* dst_ptr = &(sys->pixel_buffer[y*_KC85_DISPLAY_WIDTH]);
+    /* gather the pixel and color bytes of the scanline, then decode in one go */
+    uint8_t src_pixels[_KC85_DISPLAY_WIDTH>>3];
+    uint8_t src_colors[_KC85_DISPLAY_WIDTH>>3];
     if (KC85_TYPE_4 == sys->type) {
         int irm_index = (sys->io84 & 1) * 2;
         const uint8_t* pixel_data = sys->ram[_KC85_IRM0_PAGE + irm_index];
         const uint8_t* color_data = sys->ram[_KC85_IRM0_PAGE + irm_index + 1];
         for (int x = 0; x < width; x++) {
             int offset = y | (x<<8);
-            uint8_t src_pixels = pixel_data[offset];
-            uint8_t src_colors = color_data[offset];
-            _kc85_decode_8pixels(&(dst_ptr[x<<3]), src_pixels, src_colors, blink_bg);
+            src_pixels[x] = pixel_data[offset];
+            src_colors[x] = color_data[offset];
         }
     }
     else {
@@ -923,23 +1202,18 @@ static void _kc85_decode_scanline(kc85_t* sys) {
         const int left_color_offset  = (((y>>2)&0x3f)<<5);
         const int right_pixel_offset = (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | ((y&0x3)<<7) | (((y>>6)&0x3)<<9);
         const int right_color_offset = (((y>>4)&0x3)<<3) | (((y>>2)&0x3)<<5) | (((y>>6)&0x3)<<7);
-        int pixel_offset, color_offset;
-        for (int x = 0; x < width; x++) {
-            if (x < 0x20) {
-                /* left 256x256 quad */
-                pixel_offset = x | left_pixel_offset;
-                color_offset = x | left_color_offset;
-            }
-            else {
-                /* right 64x256 strip */
-                pixel_offset = 0x2000 + ((x&0x7) | right_pixel_offset);
-                color_offset = 0x0800 + ((x&0x7) | right_color_offset);
-            }
-            uint8_t src_pixels = pixel_data[pixel_offset];
-            uint8_t src_colors = color_data[color_offset];
-            _kc85_decode_8pixels(&(dst_ptr[x<<3]), src_pixels, src_colors, blink_bg);
+        /* left 256x256 quad */
+        for (int x = 0; x < 0x20; x++) {
+            src_pixels[x] = pixel_data[x | left_pixel_offset];
+            src_colors[x] = color_data[x | left_color_offset];
+        }
+        /* right 64x256 strip */
+        for (int x = 0x20; x < width; x++) {
+            src_pixels[x] = pixel_data[0x2000 + ((x&0x7) | right_pixel_offset)];
+            src_colors[x] = color_data[0x0800 + ((x&0x7) | right_color_offset)];
         }
     }
+    _kc85_decode_line(dst_ptr, src_pixels, src_colors, width, blink_bg);
 }
 
 static void _kc85_init_memory_map(kc85_t* sys) {
@@ -1567,6 +1841,8 @@ static bool _kc85_load_kctap(kc85_t* sys, const uint8_t* ptr, int num_bytes) {
 
 bool kc85_quickload(kc85_t* sys, const uint8_t* ptr, int num_bytes) {
     CHIPS_ASSERT(sys && sys->valid && ptr);
+    /* memory is written directly, bypassing the video memory write tracking */
+    _kc85_dirty_all(sys);
     /* first check for KC-TAP format, since this can be properly identified */
     if (_kc85_is_valid_kctap(ptr, num_bytes)) {
         return _kc85_load_kctap(sys, ptr, num_bytes);
@@ -1580,4 +1856,191 @@ bool kc85_quickload(kc85_t* sys, const uint8_t* ptr, int num_bytes) {
     }
 }
 
+/*=== SAVE STATES ============================================================*/
+#define _KC85_STATE_MAGIC (0x3538434B)  /* 'KC85' */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t type;
+    uint32_t size;      /* overall size including header */
+} _kc85_state_header_t;
+
+/* only the RAM banks which exist in the emulated model are saved */
+static bool _kc85_ram_bank_used(kc85_t* sys, int bank) {
+    return (KC85_TYPE_4 == sys->type) || (0 == bank) || (_KC85_IRM0_PAGE == bank);
+}
+
+/* append or read a chunk of state data, return false on buffer overflow */
+static bool _kc85_state_put(uint8_t** ptr, uint8_t* end, const void* src, int num_bytes) {
+    if ((*ptr + num_bytes) > end) {
+        return false;
+    }
+    memcpy(*ptr, src, num_bytes);
+    *ptr += num_bytes;
+    return true;
+}
+
+static bool _kc85_state_get(const uint8_t** ptr, const uint8_t* end, void* dst, int num_bytes) {
+    if ((*ptr + num_bytes) > end) {
+        return false;
+    }
+    memcpy(dst, *ptr, num_bytes);
+    *ptr += num_bytes;
+    return true;
+}
+
+int kc85_max_state_size(void) {
+    const kc85_t* sys = 0;
+    return (int) (sizeof(_kc85_state_header_t) +
+        sizeof(sys->cpu) + sizeof(sys->ctc) + sizeof(sys->pio) +
+        sizeof(sys->beeper_1) + sizeof(sys->beeper_2) +
+        5 /* pio_a, pio_b, io84, io86, blink_flag */ + sizeof(sys->scanline_counter) + sizeof(sys->cur_scanline) +
+        sizeof(sys->clk) + sizeof(sys->kbd) + sizeof(sys->exp) +
+        sizeof(sys->sample_pos) + sizeof(sys->sample_buffer) +
+        sizeof(sys->ram) + sizeof(sys->exp_buf));
+}
+
+int kc85_save_state(kc85_t* sys, void* ptr, int max_bytes) {
+    CHIPS_ASSERT(sys && sys->valid && ptr);
+    uint8_t* start = (uint8_t*) ptr;
+    uint8_t* end = start + max_bytes;
+    uint8_t* p = start + sizeof(_kc85_state_header_t);
+    if (p > end) {
+        return 0;
+    }
+    bool ok = _kc85_state_put(&p, end, &sys->cpu, sizeof(sys->cpu)) &&
+        _kc85_state_put(&p, end, &sys->ctc, sizeof(sys->ctc)) &&
+        _kc85_state_put(&p, end, &sys->pio, sizeof(sys->pio)) &&
+        _kc85_state_put(&p, end, &sys->beeper_1, sizeof(sys->beeper_1)) &&
+        _kc85_state_put(&p, end, &sys->beeper_2, sizeof(sys->beeper_2)) &&
+        _kc85_state_put(&p, end, &sys->pio_a, 1) &&
+        _kc85_state_put(&p, end, &sys->pio_b, 1) &&
+        _kc85_state_put(&p, end, &sys->io84, 1) &&
+        _kc85_state_put(&p, end, &sys->io86, 1) &&
+        _kc85_state_put(&p, end, &sys->blink_flag, 1) &&
+        _kc85_state_put(&p, end, &sys->scanline_counter, sizeof(sys->scanline_counter)) &&
+        _kc85_state_put(&p, end, &sys->cur_scanline, sizeof(sys->cur_scanline)) &&
+        _kc85_state_put(&p, end, &sys->clk, sizeof(sys->clk)) &&
+        _kc85_state_put(&p, end, &sys->kbd, sizeof(sys->kbd)) &&
+        _kc85_state_put(&p, end, &sys->exp, sizeof(sys->exp)) &&
+        /* pending audio samples which haven't been handed to the audio callback yet */
+        _kc85_state_put(&p, end, &sys->sample_pos, sizeof(sys->sample_pos)) &&
+        _kc85_state_put(&p, end, sys->sample_buffer, sys->sample_pos * (int)sizeof(float));
+    for (int i = 0; i < 8; i++) {
+        if (_kc85_ram_bank_used(sys, i)) {
+            ok = ok && _kc85_state_put(&p, end, sys->ram[i], sizeof(sys->ram[i]));
+        }
+    }
+    ok = ok && _kc85_state_put(&p, end, sys->exp_buf, sys->exp.buf_top);
+    if (!ok) {
+        return 0;
+    }
+    _kc85_state_header_t hdr;
+    hdr.magic = _KC85_STATE_MAGIC;
+    hdr.version = KC85_STATE_VERSION;
+    hdr.type = (uint32_t) sys->type;
+    hdr.size = (uint32_t) (p - start);
+    memcpy(start, &hdr, sizeof(hdr));
+    return (int) hdr.size;
+}
+
+bool kc85_load_state(kc85_t* sys, const void* ptr, int num_bytes) {
+    CHIPS_ASSERT(sys && sys->valid && ptr);
+    _kc85_state_header_t hdr;
+    if (num_bytes < (int)sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, ptr, sizeof(hdr));
+    if ((hdr.magic != _KC85_STATE_MAGIC) ||
+        (hdr.version != KC85_STATE_VERSION) ||
+        (hdr.type != (uint32_t)sys->type) ||
+        (hdr.size != (uint32_t)num_bytes))
+    {
+        return false;
+    }
+    const uint8_t* p = (const uint8_t*)ptr + sizeof(hdr);
+    const uint8_t* end = (const uint8_t*)ptr + num_bytes;
+
+    /* read into temporaries first, so that the emulator remains
+       untouched if the state turns out to be invalid
+    */
+    z80_t cpu; z80ctc_t ctc; z80pio_t pio;
+    beeper_t beeper_1, beeper_2;
+    uint8_t regs[5];
+    int scanline_counter, cur_scanline, sample_pos;
+    clk_t clk; kbd_t kbd; kc85_exp_t exp;
+    bool ok = _kc85_state_get(&p, end, &cpu, sizeof(cpu)) &&
+        _kc85_state_get(&p, end, &ctc, sizeof(ctc)) &&
+        _kc85_state_get(&p, end, &pio, sizeof(pio)) &&
+        _kc85_state_get(&p, end, &beeper_1, sizeof(beeper_1)) &&
+        _kc85_state_get(&p, end, &beeper_2, sizeof(beeper_2)) &&
+        _kc85_state_get(&p, end, regs, sizeof(regs)) &&
+        _kc85_state_get(&p, end, &scanline_counter, sizeof(scanline_counter)) &&
+        _kc85_state_get(&p, end, &cur_scanline, sizeof(cur_scanline)) &&
+        _kc85_state_get(&p, end, &clk, sizeof(clk)) &&
+        _kc85_state_get(&p, end, &kbd, sizeof(kbd)) &&
+        _kc85_state_get(&p, end, &exp, sizeof(exp)) &&
+        _kc85_state_get(&p, end, &sample_pos, sizeof(sample_pos));
+    if (!ok || (sample_pos < 0) || (sample_pos > sys->num_samples) || (exp.buf_top > KC85_EXP_BUFSIZE)) {
+        return false;
+    }
+    int num_ram_bytes = 0;
+    for (int i = 0; i < 8; i++) {
+        if (_kc85_ram_bank_used(sys, i)) {
+            num_ram_bytes += sizeof(sys->ram[i]);
+        }
+    }
+    const int num_tail_bytes = sample_pos * (int)sizeof(float) + num_ram_bytes + (int)exp.buf_top;
+    if ((end - p) != num_tail_bytes) {
+        return false;
+    }
+
+    /* commit the state, keep host callbacks and user data */
+    z80_tick_t tick_cb = sys->cpu.tick_cb;
+    void* cpu_user_data = sys->cpu.user_data;
+    z80_trap_t trap_cb = sys->cpu.trap_cb;
+    void* trap_user_data = sys->cpu.trap_user_data;
+    sys->cpu = cpu;
+    sys->cpu.tick_cb = tick_cb;
+    sys->cpu.user_data = cpu_user_data;
+    sys->cpu.trap_cb = trap_cb;
+    sys->cpu.trap_user_data = trap_user_data;
+    z80pio_in_t in_cb = sys->pio.in_cb;
+    z80pio_out_t out_cb = sys->pio.out_cb;
+    void* pio_user_data = sys->pio.user_data;
+    sys->pio = pio;
+    sys->pio.in_cb = in_cb;
+    sys->pio.out_cb = out_cb;
+    sys->pio.user_data = pio_user_data;
+    sys->ctc = ctc;
+    sys->beeper_1 = beeper_1;
+    sys->beeper_2 = beeper_2;
+    sys->pio_a = regs[0];
+    sys->pio_b = regs[1];
+    sys->io84 = regs[2];
+    sys->io86 = regs[3];
+    sys->blink_flag = regs[4] != 0;
+    sys->scanline_counter = scanline_counter;
+    sys->cur_scanline = cur_scanline;
+    sys->clk = clk;
+    sys->kbd = kbd;
+    sys->exp = exp;
+    sys->sample_pos = sample_pos;
+    _kc85_state_get(&p, end, sys->sample_buffer, sample_pos * (int)sizeof(float));
+    for (int i = 0; i < 8; i++) {
+        if (_kc85_ram_bank_used(sys, i)) {
+            _kc85_state_get(&p, end, sys->ram[i], sizeof(sys->ram[i]));
+        }
+    }
+    _kc85_state_get(&p, end, sys->exp_buf, exp.buf_top);
+    CHIPS_ASSERT(p == end);
+
+    /* rebuild the memory mapping, expansion slots may have changed */
+    mem_unmap_all(&sys->mem);
+    _kc85_update_memory_map(sys);
+    _kc85_dirty_all(sys);
+    return true;
+}
+
 #endif /* CHIPS_IMPL */
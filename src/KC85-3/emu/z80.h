@@ -18,6 +18,14 @@
     ~~~
         your own assert macro (default: assert(c))
 
+    ~~~C
+    Z80_THREADED_DISPATCH
+    ~~~
+        if defined, z80_exec() dispatches through per-prefix opcode
+        handler tables (see _z80_threaded.h) instead of a switch
+        statement, this requires the GCC/clang 'labels as values'
+        extension
+
     ## Emulated Pins
     ***********************************
     *           +-----------+         *
@@ -892,7 +900,11 @@ static inline uint64_t _z80_flush_r1(uint64_t ws, uint64_t r1, uint64_t map_bits
 #pragma warning (push)
 #pragma warning (disable: 4065) // switch statement contains 'default' but no 'case' labels
 #endif
+#ifdef Z80_THREADED_DISPATCH
+#include "_z80_threaded.h"
+#else
 #include "_z80_decoder.h"
+#endif
 #ifdef _MSC_VER
 #pragma warning (pop)
 #endif
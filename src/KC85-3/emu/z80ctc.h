@@ -95,6 +95,23 @@
         - **ZCTO0..ZCTO2**: set when the channels 0..2 are in counter
           mode and the countdown reaches 0
 
+    ~~~C
+    int z80ctc_ticks_to_event(z80ctc_t* ctc, uint64_t pins, int max_ticks)
+    ~~~
+        Return the number of ticks until the next call to z80ctc_tick()
+        would do anything visible (a counter reaching zero, or an
+        edge on a CLKTRG pin), clamped to max_ticks. A return value of 1
+        means that the next tick must be performed with z80ctc_tick().
+
+    ~~~C
+    void z80ctc_skip(z80ctc_t* ctc, int num_ticks)
+    ~~~
+        Advance the prescalers and down counters by num_ticks in one
+        step, num_ticks must be smaller than the result of
+        z80ctc_ticks_to_event(), and the CLKTRG pins must not change
+        during the skipped ticks. The result is identical to calling
+        z80ctc_tick() num_ticks times.
+
     ~~~C
     uint64_t z80ctc_int(z80ctc_t* ctc, uint64_t pins)
     ~~~
@@ -312,6 +329,51 @@ static inline uint64_t z80ctc_tick(z80ctc_t* ctc, uint64_t pins) {
     return pins;
 }
 
+/* return number of ticks until the next CTC event, clamped to max_ticks */
+static inline int z80ctc_ticks_to_event(z80ctc_t* ctc, uint64_t pins, int max_ticks) {
+    int ticks = max_ticks;
+    for (int chn_id = 0; chn_id < Z80CTC_NUM_CHANNELS; chn_id++) {
+        const z80ctc_channel_t* chn = &ctc->chn[chn_id];
+        if (chn->waiting_for_trigger || (chn->control & Z80CTC_CTRL_MODE) == Z80CTC_CTRL_MODE_COUNTER) {
+            /* a pending edge on the trigger pin must be handled in the next tick */
+            bool trg = 0 != (pins & (Z80CTC_CLKTRG0<<chn_id));
+            if (trg != chn->ext_trigger) {
+                return 1;
+            }
+        }
+        else if ((chn->control & (Z80CTC_CTRL_MODE|Z80CTC_CTRL_RESET|Z80CTC_CTRL_CONST_FOLLOWS)) == Z80CTC_CTRL_MODE_TIMER) {
+            /* ticks until the prescaler wraps, then one prescaler period
+               per remaining down counter step (a down counter of 0 means 256)
+            */
+            const int period = chn->prescaler_mask + 1;
+            const int first = (chn->prescaler & chn->prescaler_mask) ? (chn->prescaler & chn->prescaler_mask) : period;
+            const int count = chn->down_counter ? chn->down_counter : 256;
+            const int chn_ticks = first + (count - 1) * period;
+            if (chn_ticks < ticks) {
+                ticks = chn_ticks;
+            }
+        }
+    }
+    return ticks;
+}
+
+/* advance the CTC by num_ticks without an event (see z80ctc_ticks_to_event()) */
+static inline void z80ctc_skip(z80ctc_t* ctc, int num_ticks) {
+    for (int chn_id = 0; chn_id < Z80CTC_NUM_CHANNELS; chn_id++) {
+        z80ctc_channel_t* chn = &ctc->chn[chn_id];
+        if (!chn->waiting_for_trigger &&
+            ((chn->control & (Z80CTC_CTRL_MODE|Z80CTC_CTRL_RESET|Z80CTC_CTRL_CONST_FOLLOWS)) == Z80CTC_CTRL_MODE_TIMER))
+        {
+            const int period = chn->prescaler_mask + 1;
+            const int first = (chn->prescaler & chn->prescaler_mask) ? (chn->prescaler & chn->prescaler_mask) : period;
+            if (num_ticks >= first) {
+                chn->down_counter -= (uint8_t)(1 + (num_ticks - first) / period);
+            }
+            chn->prescaler -= (uint8_t)num_ticks;
+        }
+    }
+}
+
 /* call this once per machine cycle to handle the interrupt daisy chain */
 static inline uint64_t z80ctc_int(z80ctc_t* ctc, uint64_t pins) {
     for (int i = 0; i < Z80CTC_NUM_CHANNELS; i++) {
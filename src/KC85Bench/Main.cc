@@ -0,0 +1,720 @@
+//------------------------------------------------------------------------------
+//  KC85Bench/Main.cc
+//
+//  Command line tool which runs the KC85/3 emulator without graphics,
+//  audio output and input as fast as possible, optionally quickloads
+//  a .kcc or .tap file after CAOS has booted, and reports the emulation
+//  speed. The pixel buffer is hashed at given frames, and the hashes
+//  can be recorded to, or compared against a golden file.
+//
+//  Usage: KC85Bench [-seconds N] [-load file.kcc] [-loadframe N]
+//                   [-hash F,F,...] [-record golden.txt] [-golden golden.txt]
+//                   [-noaudio] [-instructions]
+//         KC85Bench -batch script.txt [-threads N] [-record script.txt]
+//                   [-noaudio]
+//         KC85Bench -selftest
+//
+//  One frame is 20ms of emulated time (one PAL video frame). Without
+//  -seconds, 10 seconds are emulated, or until the last golden frame.
+//  The exit code is 1 if a golden frame doesn't match. -instructions
+//  counts the executed Z80 instructions in a second run, and reports
+//  the host time per instruction.
+//
+//  caos31-boot.txt holds the golden hashes for booting CAOS 3.1
+//  without loading a file.
+//
+//  In batch mode, a script describes any number of runs, each run
+//  boots its own emulator instance, and the runs are distributed over
+//  worker threads (by default one per CPU core). Script commands, one
+//  per line, frame numbers are counted from 1 after power-on:
+//
+//      run name            start a new run
+//      load F file.kcc     quickload a .kcc or .tap file before frame F
+//      type F text         type text starting at frame F, one key per
+//                          6 frames, \r is ENTER and \\ a backslash
+//      hash F [hash]       hash the pixel buffer after frame F, and
+//                          compare against the hash if given
+//      frames N            run N frames (default: up to the last hash)
+//
+//  With -record, the script is written back with the actual hashes.
+//  caos31-batch.txt runs a few BASIC programs.
+//
+//  -selftest checks the table-driven video decoder against the
+//  reference decoder for all pixel, color and blink combinations.
+//
+//  KC85BenchThreaded is the same tool built with Z80_THREADED_DISPATCH
+//  (see emu/_z80_threaded.h), to compare both Z80 cores with
+//  -instructions, and to check the threaded core against the same
+//  golden and batch hashes.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/String/String.h"
+#define CHIPS_IMPL
+#include "emu/emu.h"
+#include "emu/kc85-roms.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace Oryol;
+
+static const uint32_t FrameMicroSeconds = 20000;
+static const int FramesPerSecond = 50;
+
+struct golden {
+    int frame;
+    uint64_t hash;
+};
+
+// an emulator instance with its own pixel buffer and audio sink
+struct machine {
+    kc85_t kc85;
+    uint32_t pixelBuffer[320 * 256];
+    int numAudioSamples = 0;
+};
+
+// a batch script run
+struct scriptEvent {
+    enum { Load, KeyDown, KeyUp } type;
+    int frame;
+    int arg;    // key code or index into run.files
+};
+struct scriptHash {
+    int frame;
+    uint64_t hash;
+    bool compare;
+    int line;   // script line index, for -record
+};
+struct scriptRun {
+    String name;
+    int numFrames = 0;
+    Array<Buffer> files;
+    Array<scriptEvent> events;
+    Array<scriptHash> hashes;
+    // results
+    Array<golden> results;
+    uint64_t numTicks = 0;
+    double hostSecs = 0.0;
+    int numAudioSamples = 0;
+    int numLoadErrors = 0;
+};
+
+static machine bench;
+
+//------------------------------------------------------------------------------
+static bool
+readFile(const char* path, Buffer& outData) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const int size = int(ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    bool success = false;
+    if (size > 0) {
+        uint8_t* ptr = outData.Add(size);
+        success = (fread(ptr, 1, size, fp) == size_t(size));
+    }
+    fclose(fp);
+    return success;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t
+hashPixels(const uint32_t* pixels, int num) {
+    // 64-bit FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint8_t* ptr = (const uint8_t*) pixels;
+    for (int i = 0; i < num * 4; i++) {
+        hash = (hash ^ ptr[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+static void
+countAudio(const float* samples, int num, void* userData) {
+    ((machine*)userData)->numAudioSamples += num;
+}
+
+//------------------------------------------------------------------------------
+static int
+countInstruction(uint16_t pc, int ticks, uint64_t pins, void* userData) {
+    (*(uint64_t*)userData)++;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static void
+setupMachine(machine* m, bool audio) {
+    // boot a KC85/3 with the same config as the KC85-3 sample
+    kc85_desc_t desc = { };
+    desc.type = KC85_TYPE_3;
+    desc.pixel_buffer = m->pixelBuffer;
+    desc.pixel_buffer_size = sizeof(m->pixelBuffer);
+    desc.audio_cb = countAudio;
+    desc.user_data = m;
+    desc.rom_caos31 = dump_caos31;
+    desc.rom_caos31_size = sizeof(dump_caos31);
+    desc.rom_kcbasic = dump_basic_c0;
+    desc.rom_kcbasic_size = sizeof(dump_basic_c0);
+    kc85_init(&m->kc85, &desc);
+    kc85_insert_ram_module(&m->kc85, 0x08, KC85_MODULE_M022_16KBYTE);
+    kc85_enable_audio(&m->kc85, audio);
+    m->numAudioSamples = 0;
+}
+
+//------------------------------------------------------------------------------
+static bool
+readGolden(const char* path, Array<golden>& outGolden) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        if ((line[0] == '#') || (line[0] == '\n')) {
+            continue;
+        }
+        golden g;
+        unsigned long long hash = 0;
+        if (sscanf(line, "%d %llx", &g.frame, &hash) == 2) {
+            g.hash = hash;
+            outGolden.Add(g);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool
+writeGolden(const char* path, const Array<golden>& hashes) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "# KC85Bench golden frame hashes: frame fnv1a64(pixel_buffer)\n");
+    for (const auto& g : hashes) {
+        fprintf(fp, "%d %016llx\n", g.frame, (unsigned long long)g.hash);
+    }
+    fclose(fp);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static void
+parseFrames(const char* str, Array<int>& outFrames) {
+    while (*str) {
+        outFrames.Add(atoi(str));
+        while (*str && (*str != ',')) {
+            str++;
+        }
+        if (*str == ',') {
+            str++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static const char*
+skipSpace(const char* str) {
+    while ((*str == ' ') || (*str == '\t')) {
+        str++;
+    }
+    return str;
+}
+
+//------------------------------------------------------------------------------
+static bool
+isCommand(const char* cmd, int len, const char* name) {
+    return (len == int(strlen(name))) && (0 == strncmp(cmd, name, len));
+}
+
+//------------------------------------------------------------------------------
+static bool
+readScript(const char* path, Array<scriptRun>& outRuns, Array<String>& outLines) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        Log::Error("KC85Bench: failed to read script '%s'\n", path);
+        return false;
+    }
+    bool success = true;
+    char line[1024];
+    while (success && fgets(line, sizeof(line), fp)) {
+        const int lineIndex = outLines.Size();
+        line[strcspn(line, "\r\n")] = 0;
+        outLines.Add(String(line));
+        const char* cmd = skipSpace(line);
+        if ((*cmd == 0) || (*cmd == '#')) {
+            continue;
+        }
+        const char* args = cmd;
+        while (*args && (*args != ' ') && (*args != '\t')) {
+            args++;
+        }
+        const int cmdLen = int(args - cmd);
+        args = skipSpace(args);
+        // all commands except 'run' start with a frame number
+        char* end = nullptr;
+        const int frame = int(strtol(args, &end, 10));
+        const char* rest = skipSpace(end);
+        if (isCommand(cmd, cmdLen, "run")) {
+            outRuns.Add().name = args;
+            continue;
+        }
+        if (outRuns.Empty() || (frame < 1)) {
+            Log::Error("KC85Bench: %s(%d): expected 'run' or a frame number\n", path, lineIndex + 1);
+            success = false;
+            continue;
+        }
+        scriptRun& run = outRuns.Back();
+        if (isCommand(cmd, cmdLen, "load")) {
+            Buffer data;
+            if (!readFile(rest, data)) {
+                Log::Error("KC85Bench: %s(%d): failed to read '%s'\n", path, lineIndex + 1, rest);
+                success = false;
+                continue;
+            }
+            run.events.Add({ scriptEvent::Load, frame, run.files.Size() });
+            run.files.Add(std::move(data));
+        }
+        else if (isCommand(cmd, cmdLen, "type")) {
+            int f = frame;
+            for (const char* c = rest; *c; c++, f += 6) {
+                int key = *c;
+                if ((*c == '\\') && (c[1] == 'r')) {
+                    key = 0x0D;
+                    c++;
+                }
+                else if ((*c == '\\') && (c[1] == '\\')) {
+                    c++;
+                }
+                run.events.Add({ scriptEvent::KeyDown, f, key });
+                run.events.Add({ scriptEvent::KeyUp, f + 3, key });
+            }
+        }
+        else if (isCommand(cmd, cmdLen, "hash")) {
+            scriptHash h;
+            h.frame = frame;
+            h.compare = (*rest != 0);
+            h.hash = h.compare ? strtoull(rest, nullptr, 16) : 0;
+            h.line = lineIndex;
+            run.hashes.Add(h);
+        }
+        else if (isCommand(cmd, cmdLen, "frames")) {
+            run.numFrames = frame;
+        }
+        else {
+            Log::Error("KC85Bench: %s(%d): unknown command\n", path, lineIndex + 1);
+            success = false;
+        }
+    }
+    fclose(fp);
+    // events and hashes are processed in frame order
+    for (auto& run : outRuns) {
+        std::stable_sort(run.events.begin(), run.events.end(), [](const scriptEvent& a, const scriptEvent& b) {
+            return a.frame < b.frame;
+        });
+        std::stable_sort(run.hashes.begin(), run.hashes.end(), [](const scriptHash& a, const scriptHash& b) {
+            return a.frame < b.frame;
+        });
+        for (const auto& h : run.hashes) {
+            run.numFrames = std::max(run.numFrames, h.frame);
+        }
+        if (success && (0 == run.numFrames)) {
+            Log::Error("KC85Bench: %s: run '%s' has no frames\n", path, run.name.AsCStr());
+            success = false;
+        }
+    }
+    return success;
+}
+
+//------------------------------------------------------------------------------
+static void
+runScript(machine* m, scriptRun& run, bool audio) {
+    setupMachine(m, audio);
+    int eventIndex = 0;
+    Duration hostTime;
+    for (int frame = 1; frame <= run.numFrames; frame++) {
+        while ((eventIndex < run.events.Size()) && (run.events[eventIndex].frame == frame)) {
+            const scriptEvent& e = run.events[eventIndex++];
+            switch (e.type) {
+                case scriptEvent::Load:
+                    if (!kc85_quickload(&m->kc85, run.files[e.arg].Data(), run.files[e.arg].Size())) {
+                        run.numLoadErrors++;
+                    }
+                    break;
+                case scriptEvent::KeyDown:
+                    kc85_key_down(&m->kc85, e.arg);
+                    break;
+                case scriptEvent::KeyUp:
+                    kc85_key_up(&m->kc85, e.arg);
+                    break;
+            }
+        }
+        const TimePoint start = Clock::Now();
+        run.numTicks += kc85_exec(&m->kc85, FrameMicroSeconds);
+        hostTime += Clock::Since(start);
+        // one result per hash command, in the same order
+        while ((run.results.Size() < run.hashes.Size()) && (run.hashes[run.results.Size()].frame == frame)) {
+            golden g;
+            g.frame = frame;
+            g.hash = run.results.Empty() || (run.results.Back().frame != frame) ?
+                hashPixels(m->pixelBuffer, 320 * 256) : run.results.Back().hash;
+            run.results.Add(g);
+        }
+    }
+    run.hostSecs = hostTime.AsSeconds();
+    run.numAudioSamples = m->numAudioSamples;
+    kc85_discard(&m->kc85);
+}
+
+//------------------------------------------------------------------------------
+static int
+selfTest() {
+    // decode full scanlines with the line decoder, and compare against
+    // the per-byte reference decoder
+    _kc85_init_decode_luts();
+    const int num = 320 / 8;
+    uint8_t pixels[num];
+    uint8_t colors[num];
+    uint32_t line[num * 8];
+    uint32_t ref[num * 8];
+    int numMismatches = 0;
+    for (int blink = 0; blink < 2; blink++) {
+        for (int c = 0; c < 256; c++) {
+            for (int p0 = 0; p0 < 256; p0 += num) {
+                for (int x = 0; x < num; x++) {
+                    pixels[x] = uint8_t(p0 + x);
+                    colors[x] = uint8_t(c);
+                    _kc85_decode_8pixels(&ref[x * 8], pixels[x], colors[x], blink != 0);
+                }
+                _kc85_decode_line(line, pixels, colors, num, blink != 0);
+                for (int x = 0; x < num; x++) {
+                    if (0 != memcmp(&line[x * 8], &ref[x * 8], 8 * sizeof(uint32_t))) {
+                        Log::Error("video decoder: pixels %02x, colors %02x, blink %d doesn't match reference\n",
+                            pixels[x], colors[x], blink);
+                        numMismatches++;
+                    }
+                }
+            }
+        }
+    }
+    if (numMismatches > 0) {
+        Log::Error("KC85Bench: %d selftest mismatches\n", numMismatches);
+        return 1;
+    }
+    Log::Info("selftest passed\n");
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static int
+runBatch(const char* scriptPath, int numThreads, const char* recordPath, bool audio) {
+    Array<scriptRun> runs;
+    Array<String> lines;
+    if (!readScript(scriptPath, runs, lines)) {
+        return 10;
+    }
+    if (numThreads <= 0) {
+        numThreads = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    numThreads = std::min(numThreads, std::max(1, runs.Size()));
+
+    // one emulator instance per worker thread, the first kc85_init()
+    // initializes lookup tables shared by all instances, so it must
+    // happen before the worker threads are started
+    machine* machines = new machine[numThreads];
+    setupMachine(&machines[0], audio);
+    kc85_discard(&machines[0].kc85);
+
+    // each worker pulls the next run until all runs are done
+    std::atomic<int> nextRun(0);
+    const TimePoint start = Clock::Now();
+    Array<std::thread> threads;
+    for (int i = 0; i < numThreads; i++) {
+        threads.Add(std::thread([&runs, &nextRun, machines, i, audio]() {
+            int runIndex;
+            while ((runIndex = nextRun++) < runs.Size()) {
+                runScript(&machines[i], runs[runIndex], audio);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double wallSecs = Clock::Since(start).AsSeconds();
+    delete[] machines;
+
+    // check results in script order
+    int numFailed = 0;
+    int numFrames = 0;
+    double hostSecs = 0.0;
+    for (auto& run : runs) {
+        int numMismatches = run.numLoadErrors;
+        for (int i = 0; i < run.hashes.Size(); i++) {
+            scriptHash& h = run.hashes[i];
+            const uint64_t hash = run.results[i].hash;
+            if (h.compare && (h.hash != hash)) {
+                Log::Error("%s: frame %d: hash %016llx, expected %016llx\n", run.name.AsCStr(),
+                    h.frame, (unsigned long long)hash, (unsigned long long)h.hash);
+                numMismatches++;
+            }
+            h.hash = hash;
+        }
+        Log::Info("%s: %s (%d frames, %.3f s, %.1f MHz%s)\n", run.name.AsCStr(),
+            numMismatches > 0 ? "FAILED" : "ok", run.numFrames, run.hostSecs,
+            (run.numTicks / run.hostSecs) / 1000000.0, run.numLoadErrors > 0 ? ", quickload failed" : "");
+        if (audio) {
+            Log::Info("%s: audio samples: %d\n", run.name.AsCStr(), run.numAudioSamples);
+        }
+        numFailed += (numMismatches > 0) ? 1 : 0;
+        numFrames += run.numFrames;
+        hostSecs += run.hostSecs;
+    }
+    const double emuSecs = double(numFrames) / FramesPerSecond;
+    Log::Info("%d runs on %d threads, emulated: %.1f s, wall clock: %.3f s (%.1fx realtime, %.2fx parallel)\n",
+        runs.Size(), numThreads, emuSecs, wallSecs, emuSecs / wallSecs, hostSecs / wallSecs);
+
+    int result = (numFailed > 0) ? 1 : 0;
+    if (numFailed > 0) {
+        Log::Error("KC85Bench: %d of %d runs failed\n", numFailed, runs.Size());
+    }
+    if (recordPath) {
+        for (const auto& run : runs) {
+            for (const auto& h : run.hashes) {
+                char str[64];
+                snprintf(str, sizeof(str), "hash %d %016llx", h.frame, (unsigned long long)h.hash);
+                lines[h.line] = str;
+            }
+        }
+        FILE* fp = fopen(recordPath, "w");
+        if (fp) {
+            for (const auto& line : lines) {
+                fprintf(fp, "%s\n", line.AsCStr());
+            }
+            fclose(fp);
+            Log::Info("recorded script with hashes to '%s'\n", recordPath);
+        }
+        else {
+            Log::Error("KC85Bench: failed to write '%s'\n", recordPath);
+            result = 10;
+        }
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, const char** argv) {
+    int seconds = 0;
+    const char* loadPath = nullptr;
+    int loadFrame = 3 * FramesPerSecond;
+    const char* hashFrames = nullptr;
+    const char* recordPath = nullptr;
+    const char* goldenPath = nullptr;
+    const char* batchPath = nullptr;
+    int numThreads = 0;
+    bool audio = true;
+    bool instructions = false;
+    bool selftest = false;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = (i + 1) < argc;
+        if ((0 == strcmp(argv[i], "-seconds")) && hasValue) {
+            seconds = atoi(argv[++i]);
+        }
+        else if ((0 == strcmp(argv[i], "-load")) && hasValue) {
+            loadPath = argv[++i];
+        }
+        else if ((0 == strcmp(argv[i], "-loadframe")) && hasValue) {
+            loadFrame = atoi(argv[++i]);
+        }
+        else if ((0 == strcmp(argv[i], "-hash")) && hasValue) {
+            hashFrames = argv[++i];
+        }
+        else if ((0 == strcmp(argv[i], "-record")) && hasValue) {
+            recordPath = argv[++i];
+        }
+        else if ((0 == strcmp(argv[i], "-golden")) && hasValue) {
+            goldenPath = argv[++i];
+        }
+        else if ((0 == strcmp(argv[i], "-batch")) && hasValue) {
+            batchPath = argv[++i];
+        }
+        else if ((0 == strcmp(argv[i], "-threads")) && hasValue) {
+            numThreads = atoi(argv[++i]);
+        }
+        else if (0 == strcmp(argv[i], "-noaudio")) {
+            audio = false;
+        }
+        else if (0 == strcmp(argv[i], "-instructions")) {
+            instructions = true;
+        }
+        else if (0 == strcmp(argv[i], "-selftest")) {
+            selftest = true;
+        }
+        else {
+            Log::Info("Usage: KC85Bench [-seconds N] [-load file.kcc] [-loadframe N]\n"
+                      "                 [-hash F,F,...] [-record golden.txt] [-golden golden.txt]\n"
+                      "                 [-noaudio] [-instructions]\n"
+                      "       KC85Bench -batch script.txt [-threads N] [-record script.txt]\n"
+                      "                 [-noaudio]\n"
+                      "       KC85Bench -selftest\n");
+            return 10;
+        }
+    }
+    Core::Setup();
+    if (selftest) {
+        const int result = selfTest();
+        Core::Discard();
+        return result;
+    }
+    if (batchPath) {
+        const int result = runBatch(batchPath, numThreads, recordPath, audio);
+        Core::Discard();
+        return result;
+    }
+
+    // frames at which the pixel buffer is hashed, by default once per
+    // emulated second, or the frames listed in the golden file
+    Array<golden> expected;
+    if (goldenPath && !readGolden(goldenPath, expected)) {
+        Log::Error("KC85Bench: failed to read golden file '%s'\n", goldenPath);
+        Core::Discard();
+        return 10;
+    }
+    if (0 == seconds) {
+        // by default run long enough to reach the last golden frame
+        seconds = 10;
+        for (const auto& g : expected) {
+            const int s = (g.frame + FramesPerSecond - 1) / FramesPerSecond;
+            seconds = (s > seconds) ? s : seconds;
+        }
+    }
+    Array<int> frames;
+    if (hashFrames) {
+        parseFrames(hashFrames, frames);
+    }
+    else if (!expected.Empty()) {
+        for (const auto& g : expected) {
+            frames.Add(g.frame);
+        }
+    }
+    else {
+        for (int f = FramesPerSecond; f <= seconds * FramesPerSecond; f += FramesPerSecond) {
+            frames.Add(f);
+        }
+    }
+    Buffer loadData;
+    if (loadPath && !readFile(loadPath, loadData)) {
+        Log::Error("KC85Bench: failed to read '%s'\n", loadPath);
+        Core::Discard();
+        return 10;
+    }
+
+    // run the emulator, only the kc85_exec() calls are timed
+    Array<golden> hashes;
+    uint64_t numTicks = 0;
+    Duration hostTime;
+    const int numFrames = seconds * FramesPerSecond;
+    // with numInstructions, the run is only used to count instructions
+    auto runFrames = [&](uint64_t* numInstructions) {
+        setupMachine(&bench, audio);
+        if (numInstructions) {
+            z80_trap_cb(&bench.kc85.cpu, countInstruction, numInstructions);
+        }
+        for (int frame = 1; frame <= numFrames; frame++) {
+            if (loadPath && (frame == loadFrame)) {
+                if (!kc85_quickload(&bench.kc85, loadData.Data(), loadData.Size()) && !numInstructions) {
+                    Log::Warn("KC85Bench: quickload of '%s' failed\n", loadPath);
+                }
+            }
+            if (numInstructions) {
+                kc85_exec(&bench.kc85, FrameMicroSeconds);
+                continue;
+            }
+            const TimePoint start = Clock::Now();
+            numTicks += kc85_exec(&bench.kc85, FrameMicroSeconds);
+            hostTime += Clock::Since(start);
+            if (frames.FindIndexLinear(frame) != InvalidIndex) {
+                golden g;
+                g.frame = frame;
+                g.hash = hashPixels(bench.pixelBuffer, 320 * 256);
+                hashes.Add(g);
+            }
+        }
+    };
+    runFrames(nullptr);
+
+    const double hostSecs = hostTime.AsSeconds();
+    Log::Info("emulated: %d s, host: %.3f s (%.1fx realtime)\n", seconds, hostSecs, seconds / hostSecs);
+    Log::Info("ticks: %llu, %.3f emulated MHz, %.2f host ns/tick\n",
+        (unsigned long long)numTicks, (numTicks / hostSecs) / 1000000.0, (hostSecs * 1.0e9) / numTicks);
+    if (audio) {
+        Log::Info("audio samples: %d\n", bench.numAudioSamples);
+    }
+    if (instructions) {
+        // count instructions in a second, untimed run, since the trap
+        // callback which counts them slows down the emulation
+        uint64_t numInstructions = 0;
+        kc85_discard(&bench.kc85);
+        runFrames(&numInstructions);
+        Log::Info("instructions: %llu, %.2f ticks/instruction, %.2f host ns/instruction\n",
+            (unsigned long long)numInstructions, double(numTicks) / numInstructions,
+            (hostSecs * 1.0e9) / numInstructions);
+    }
+
+    int result = 0;
+    for (const auto& g : hashes) {
+        Log::Info("frame %d: %016llx\n", g.frame, (unsigned long long)g.hash);
+    }
+    if (recordPath) {
+        if (writeGolden(recordPath, hashes)) {
+            Log::Info("recorded %d hashes to '%s'\n", hashes.Size(), recordPath);
+        }
+        else {
+            Log::Error("KC85Bench: failed to write '%s'\n", recordPath);
+            result = 10;
+        }
+    }
+    if (goldenPath) {
+        int numMismatches = 0;
+        for (const auto& exp : expected) {
+            bool found = false;
+            for (const auto& g : hashes) {
+                if (g.frame == exp.frame) {
+                    found = true;
+                    if (g.hash != exp.hash) {
+                        Log::Error("frame %d: hash %016llx, expected %016llx\n",
+                            g.frame, (unsigned long long)g.hash, (unsigned long long)exp.hash);
+                        numMismatches++;
+                    }
+                }
+            }
+            if (!found) {
+                Log::Error("frame %d: not reached (run with more -seconds)\n", exp.frame);
+                numMismatches++;
+            }
+        }
+        if (numMismatches > 0) {
+            Log::Error("KC85Bench: %d golden frame mismatches\n", numMismatches);
+            result = 1;
+        }
+        else {
+            Log::Info("all %d golden frames match\n", expected.Size());
+        }
+    }
+    kc85_discard(&bench.kc85);
+    Core::Discard();
+    return result;
+}
@@ -0,0 +1,368 @@
+//------------------------------------------------------------------------------
+//  OrbCook/Main.cc
+//
+//  Command line tool which validates an .orb file and appends pre-computed
+//  data (bind poses, inverse bind poses, per-submesh and per-bone bounds,
+//  checksum), optionally also reorders the mesh data with MeshOptimizer.
+//
+//  Usage: OrbCook input.orb output.orb [-optimize]
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Common/OrbFile.h"
+#include "Common/MeshOptimizer.h"
+#include <glm/mat4x4.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stdio.h>
+#include <string.h>
+
+using namespace Oryol;
+
+//------------------------------------------------------------------------------
+static bool
+readFile(const char* path, Buffer& outData) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const int size = int(ftell(fp));
+    fseek(fp, 0, SEEK_SET);
+    bool success = false;
+    if (size > 0) {
+        uint8_t* ptr = outData.Add(size);
+        success = (fread(ptr, 1, size, fp) == size_t(size));
+    }
+    fclose(fp);
+    return success;
+}
+
+//------------------------------------------------------------------------------
+static bool
+writeFile(const char* path, const Buffer& data) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    const bool success = (fwrite(data.Data(), 1, data.Size(), fp) == size_t(data.Size()));
+    fclose(fp);
+    return success;
+}
+
+//------------------------------------------------------------------------------
+static glm::vec4
+readVertexComponent(const uint8_t* ptr, uint32_t fmt) {
+    glm::vec4 v(0.0f, 0.0f, 0.0f, 1.0f);
+    switch (fmt) {
+        case OrbVertexFormat::Float:
+        case OrbVertexFormat::Float2:
+        case OrbVertexFormat::Float3:
+        case OrbVertexFormat::Float4:
+            {
+                const int num = OrbFile::VertexFormatByteSize(fmt) / 4;
+                const float* f = (const float*) ptr;
+                for (int i = 0; i < num; i++) {
+                    v[i] = f[i];
+                }
+            }
+            break;
+        case OrbVertexFormat::Short4N:
+            for (int i = 0; i < 4; i++) {
+                v[i] = ((const int16_t*)ptr)[i] / 32767.0f;
+            }
+            break;
+        case OrbVertexFormat::Byte4N:
+            for (int i = 0; i < 4; i++) {
+                v[i] = ((const int8_t*)ptr)[i] / 127.0f;
+            }
+            break;
+        case OrbVertexFormat::UByte4N:
+            for (int i = 0; i < 4; i++) {
+                v[i] = ptr[i] / 255.0f;
+            }
+            break;
+        case OrbVertexFormat::UByte4:
+            for (int i = 0; i < 4; i++) {
+                v[i] = ptr[i];
+            }
+            break;
+        default:
+            break;
+    }
+    return v;
+}
+
+//------------------------------------------------------------------------------
+struct vertexReader {
+    int stride = 0;
+    int posOffset = -1;
+    uint32_t posFormat = 0;
+    int weightsOffset = -1;
+    uint32_t weightsFormat = 0;
+    int indicesOffset = -1;
+    uint32_t indicesFormat = 0;
+    glm::vec3 mag;
+    const uint8_t* vertices = nullptr;
+
+    void setup(const OrbFile& orb, const uint8_t* data) {
+        this->vertices = data + orb.VertexDataOffset;
+        this->stride = orb.VertexByteSize();
+        this->mag = orb.VertexMagnitude;
+        int offset = 0;
+        for (const auto& comp : orb.VertexComps) {
+            switch (comp.Attr) {
+                case OrbVertexAttr::Position:
+                    this->posOffset = offset; this->posFormat = comp.Format; break;
+                case OrbVertexAttr::Weights:
+                    this->weightsOffset = offset; this->weightsFormat = comp.Format; break;
+                case OrbVertexAttr::Indices:
+                    this->indicesOffset = offset; this->indicesFormat = comp.Format; break;
+                default:
+                    break;
+            }
+            offset += OrbFile::VertexFormatByteSize(comp.Format);
+        }
+    }
+    bool isSkinned() const {
+        return (this->weightsOffset >= 0) && (this->indicesOffset >= 0);
+    }
+    glm::vec3 position(int i) const {
+        glm::vec3 p(readVertexComponent(this->vertices + i*this->stride + this->posOffset, this->posFormat));
+        if (this->posFormat != OrbVertexFormat::Float3 && this->posFormat != OrbVertexFormat::Float4) {
+            // normalized formats are scaled by the vertex magnitude
+            p *= this->mag;
+        }
+        return p;
+    }
+    glm::vec4 weights(int i) const {
+        return readVertexComponent(this->vertices + i*this->stride + this->weightsOffset, this->weightsFormat);
+    }
+    glm::vec4 indices(int i) const {
+        return readVertexComponent(this->vertices + i*this->stride + this->indicesOffset, this->indicesFormat);
+    }
+};
+
+//------------------------------------------------------------------------------
+static void
+extend(OrbCookedBounds& bounds, const glm::vec3& p, bool& empty) {
+    for (int i = 0; i < 3; i++) {
+        if (empty) {
+            bounds.Min[i] = bounds.Max[i] = p[i];
+        }
+        else {
+            bounds.Min[i] = glm::min(bounds.Min[i], p[i]);
+            bounds.Max[i] = glm::max(bounds.Max[i], p[i]);
+        }
+    }
+    empty = false;
+}
+
+//------------------------------------------------------------------------------
+static void
+optimizeMesh(const OrbFile& orb, uint8_t* data) {
+    vertexReader reader;
+    reader.setup(orb, data);
+    int numVertices = 0;
+    int numIndices = 0;
+    for (const auto& mesh : orb.Meshes) {
+        numVertices += mesh.NumVertices;
+        numIndices += mesh.NumIndices;
+    }
+    Array<glm::vec3> positions;
+    positions.Reserve(numVertices);
+    for (int i = 0; i < numVertices; i++) {
+        positions.Add(reader.position(i));
+    }
+    uint16_t* indices = (uint16_t*) (data + orb.IndexDataOffset);
+    for (int i = 0; i < orb.Meshes.Size(); i++) {
+        const auto& mesh = orb.Meshes[i];
+        uint16_t* meshIndices = indices + mesh.FirstIndex;
+        const MeshOptimizer::Stats before = MeshOptimizer::Analyze(meshIndices, mesh.NumIndices, numVertices);
+        MeshOptimizer::OptimizeVertexCache(meshIndices, mesh.NumIndices, numVertices);
+        MeshOptimizer::OptimizeOverdraw(meshIndices, mesh.NumIndices, &positions[0], numVertices);
+        const MeshOptimizer::Stats after = MeshOptimizer::Analyze(meshIndices, mesh.NumIndices, numVertices);
+        Log::Info("  mesh %d: ACMR %.3f => %.3f, ATVR %.3f => %.3f\n",
+            i, before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+    }
+    MeshOptimizer::OptimizeVertexFetch(data + orb.VertexDataOffset, numVertices, reader.stride, indices, numIndices);
+}
+
+//------------------------------------------------------------------------------
+static void
+align(Buffer& buf, int alignment) {
+    while (buf.Size() & (alignment - 1)) {
+        const uint8_t pad = 0;
+        buf.Add(&pad, 1);
+    }
+}
+
+//------------------------------------------------------------------------------
+static int
+cook(const char* srcPath, const char* dstPath, bool optimize) {
+    Buffer src;
+    if (!readFile(srcPath, src)) {
+        Log::Error("Failed to read '%s'\n", srcPath);
+        return 10;
+    }
+    OrbFile orb;
+    if (!orb.Parse(src.Data(), src.Size())) {
+        Log::Error("'%s' is not a valid .orb file\n", srcPath);
+        return 10;
+    }
+    if (!orb.Validate()) {
+        Log::Error("'%s' failed validation\n", srcPath);
+        return 10;
+    }
+    if (orb.IsCooked()) {
+        Log::Info("'%s' is already cooked, replacing cooked data\n", srcPath);
+    }
+
+    // the output starts with the original ORB1 data, without old cooked data
+    Buffer dst;
+    dst.Add(src.Data(), orb.OrbDataSize);
+    OrbFile dstOrb;
+    if (!dstOrb.Parse(dst.Data(), dst.Size())) {
+        Log::Error("Failed to re-parse '%s'\n", srcPath);
+        return 10;
+    }
+    uint32_t flags = OrbCookedFlags::None;
+    if (optimize) {
+        Log::Info("optimizing mesh data:\n");
+        optimizeMesh(dstOrb, dst.Data());
+        flags |= OrbCookedFlags::MeshOptimized;
+    }
+    const uint32_t orbDataSize = uint32_t(dst.Size());
+    const uint32_t checksum = OrbFile::Checksum(dst.Data(), dst.Size());
+
+    // bind poses and inverse bind poses
+    const int numBones = dstOrb.Bones.Size();
+    Array<glm::mat4> bindPoses;
+    Array<glm::mat4> invBindPoses;
+    for (int i = 0; i < numBones; i++) {
+        bindPoses.Add();
+    }
+    if (numBones > 0) {
+        dstOrb.ComputeBindPoses(&bindPoses[0], numBones);
+    }
+    for (int i = 0; i < numBones; i++) {
+        invBindPoses.Add(glm::inverse(bindPoses[i]));
+    }
+
+    // per-submesh bounds in model space and per-bone bounds of
+    // all vertices influenced by a bone in bone space
+    vertexReader reader;
+    reader.setup(dstOrb, dst.Data());
+    const uint16_t* indices = (const uint16_t*) (dst.Data() + dstOrb.IndexDataOffset);
+    Array<OrbCookedBounds> meshBounds;
+    for (const auto& mesh : dstOrb.Meshes) {
+        OrbCookedBounds bounds = { };
+        bool empty = true;
+        for (uint32_t i = mesh.FirstIndex; i < (mesh.FirstIndex + mesh.NumIndices); i++) {
+            extend(bounds, reader.position(indices[i]), empty);
+        }
+        meshBounds.Add(bounds);
+    }
+    Array<OrbCookedBounds> boneBounds;
+    Array<bool> boneEmpty;
+    for (int i = 0; i < numBones; i++) {
+        boneBounds.Add(OrbCookedBounds{ });
+        boneEmpty.Add(true);
+    }
+    if (reader.isSkinned() && (numBones > 0)) {
+        int numVertices = 0;
+        for (const auto& mesh : dstOrb.Meshes) {
+            numVertices += mesh.NumVertices;
+        }
+        for (int vi = 0; vi < numVertices; vi++) {
+            const glm::vec4 pos(reader.position(vi), 1.0f);
+            const glm::vec4 weights = reader.weights(vi);
+            const glm::vec4 boneIndices = reader.indices(vi);
+            for (int i = 0; i < 4; i++) {
+                const int bi = int(boneIndices[i]);
+                if ((weights[i] > 0.0f) && (bi < numBones)) {
+                    extend(boneBounds[bi], glm::vec3(invBindPoses[bi] * pos), boneEmpty[bi]);
+                }
+            }
+        }
+    }
+
+    // append the cooked chunk
+    align(dst, 16);
+    OrbCookedHeader hdr = { };
+    const uint32_t hdrOffset = uint32_t(dst.Size());
+    uint32_t offset = hdrOffset + sizeof(OrbCookedHeader);
+    hdr.Magic = OrbCookedMagic;
+    hdr.Version = OrbCookedVersion;
+    hdr.OrbDataSize = orbDataSize;
+    hdr.Checksum = checksum;
+    hdr.NumBones = numBones;
+    hdr.BindPoseOffset = offset;
+    offset += numBones * sizeof(OrbCookedMatrix);
+    hdr.InvBindPoseOffset = offset;
+    offset += numBones * sizeof(OrbCookedMatrix);
+    hdr.BoneBoundsOffset = offset;
+    offset += numBones * sizeof(OrbCookedBounds);
+    hdr.NumSubmeshes = meshBounds.Size();
+    hdr.SubmeshBoundsOffset = offset;
+    hdr.Flags = flags;
+    dst.Add((const uint8_t*)&hdr, sizeof(hdr));
+    for (const auto& m : bindPoses) {
+        dst.Add((const uint8_t*)&m[0][0], sizeof(OrbCookedMatrix));
+    }
+    for (const auto& m : invBindPoses) {
+        dst.Add((const uint8_t*)&m[0][0], sizeof(OrbCookedMatrix));
+    }
+    for (const auto& b : boneBounds) {
+        dst.Add((const uint8_t*)&b, sizeof(b));
+    }
+    for (const auto& b : meshBounds) {
+        dst.Add((const uint8_t*)&b, sizeof(b));
+    }
+    OrbCookedFooter footer = { hdrOffset, OrbCookedMagic };
+    dst.Add((const uint8_t*)&footer, sizeof(footer));
+
+    // check that the result parses as cooked file
+    OrbFile check;
+    if (!check.Parse(dst.Data(), dst.Size()) || !check.IsCooked()) {
+        Log::Error("Cooked data for '%s' failed to verify\n", srcPath);
+        return 10;
+    }
+    if (!writeFile(dstPath, dst)) {
+        Log::Error("Failed to write '%s'\n", dstPath);
+        return 10;
+    }
+    Log::Info("'%s' => '%s': %d bones, %d submeshes, checksum %08x\n",
+        srcPath, dstPath, numBones, meshBounds.Size(), checksum);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, const char** argv) {
+    const char* srcPath = nullptr;
+    const char* dstPath = nullptr;
+    bool optimize = false;
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-optimize")) {
+            optimize = true;
+        }
+        else if (!srcPath) {
+            srcPath = argv[i];
+        }
+        else if (!dstPath) {
+            dstPath = argv[i];
+        }
+    }
+    if (!srcPath || !dstPath) {
+        Log::Info("Usage: OrbCook input.orb output.orb [-optimize]\n");
+        return 10;
+    }
+    Core::Setup();
+    const int result = cook(srcPath, dstPath, optimize);
+    Core::Discard();
+    return result;
+}
@@ -3,6 +3,7 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "Core/Main.h"
+#include "Core/String/StringBuilder.h"
 #include "Gfx/Gfx.h"
 #include "Input/Input.h"
 #include "IO/IO.h"
@@ -10,10 +11,14 @@
 #include "Anim/Anim.h"
 #include "HttpFS/HTTPFileSystem.h"
 #include "Common/OrbLoader.h"
+#include "Common/TextureStreamer.h"
 #include "Common/CameraHelper.h"
 #include "Common/Wireframe.h"
+#include "Common/HalfFloat.h"
+#include "Common/DualQuatSkin.h"
 #include "glm/mat4x4.hpp"
 #include "glm/geometric.hpp"
+#include "glm/common.hpp"
 #include "glm/gtc/quaternion.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "shaders.h"
@@ -29,10 +34,19 @@ public:
     struct Model {
         OrbModel orb;
         Id pipeline;
+        Id texPipeline;
+        Id dqPipeline;
+        Id diffPipeline;
         Id animInstance;
         LambertShader::vsParams vsParams;
+        LambertTexShader::vsParams texVsParams;
+        LambertDQShader::vsParams dqVsParams;
+        SkinDiffShader::vsParams diffVsParams;
         glm::mat4 transform;
     };
+    struct SkinMode {
+        enum Code { Matrix, DualQuat, Diff };
+    };
 
     void drawUI();
     void drawMainWindow();
@@ -40,34 +54,74 @@ public:
     void drawBoneTextureWindow();
     void loadModel(const Locator& loc);
     void drawModelDebug(const Model& model, const glm::mat4& modelMatrix);
+    const OrbModel& orbModel(int index) const;
+    glm::vec3 modelPosition(int index) const;
+    float screenSize(int index) const;
+    static int diffuseMap(const OrbModel& orb, int materialIndex);
+    Id createBoneTexture(int width, int height);
+    void uploadBoneTexture(Id tex, const float* values, int numValues, Array<uint16_t>& halfBuffer);
+    Id createPipeline(Id shader, const VertexLayout& layout);
 
     static const int BoneTextureWidth = 768;
     static const int BoneTextureHeight = 1;
+    // dual quaternions need 2 instead of 3 texels per bone
+    static const int DQBoneTextureWidth = (BoneTextureWidth * 2) / 3;
 
     struct {
         bool freezeTime = false;
         float timeScale = 1.0f;
         bool meshEnabled = true;
+        bool texturesEnabled = true;
         bool bindPoseEnabled = false;
         bool staticPoseEnabled = false;
         bool jointTrailsEnabled = false;
         bool animatedPoseEnabled = false;
         bool animWindowEnabled = false;
         bool textureWindowEnabled = false;
+        int skinMode = SkinMode::Matrix;
+        float diffScale = 100.0f;
         AnimJob animJob;
     } ui;
 
     int frameIndex = 0;
     GfxSetup gfxSetup;
     Id shader;
+    Id texShader;
+    Id dqShader;
+    Id diffShader;
     Id boneTexture;
+    Id dqBoneTexture;
+    bool halfFloatBoneTexture = false;
+    Array<uint16_t> halfBoneTable;
+    Array<float> dqBoneTable;
+    Array<uint16_t> halfDQBoneTable;
     ImTextureID imguiBoneTextureId = nullptr;
+    // the model and its copies are loaded into one shared mesh, the
+    // copies are skinned with the model's animation instance
+    static const int NumCopies = 2;
+    OrbModelPool pool;
     Model model;
+    OrbModel copies[NumCopies];
+    TextureStreamer textures;
+    // the sample data has no .dds files, so texture streaming
+    // must be enabled with -textures
+    bool streamTextures = false;
     Wireframe wireframe;
     CameraHelper camera;
     Array<glm::mat4> dbgPose;
     static const uint32_t HistorySize = 128;
-    StaticArray<Array<glm::vec3>, HistorySize> dbgHistory;
+    // joint trail ring buffer, joint positions as SoA per history slot,
+    // and the trail line vertices, allocated when the model is loaded
+    struct {
+        int numBones = 0;
+        int head = 0;
+        int count = 0;
+        int frameIndex = -1;
+        Array<float> x, y, z;
+        Array<glm::vec4> points;
+        Array<glm::vec4> colors;
+    } jointTrails;
+    void setupJointTrails(int numBones);
 };
 OryolMain(Main);
 
@@ -97,17 +151,24 @@ Main::OnInit() {
 
     // can setup the shader before loading any assets
     this->shader = Gfx::CreateResource(LambertShader::Setup());
-
-    // RGBA32F texture for the animated skeleton bone info
-    auto texSetup = TextureSetup::Empty2D(BoneTextureWidth, BoneTextureHeight, 1, PixelFormat::RGBA32F, Usage::Stream);
-    texSetup.Sampler.MinFilter = TextureFilterMode::Nearest;
-    texSetup.Sampler.MagFilter = TextureFilterMode::Nearest;
-    texSetup.Sampler.WrapU = TextureWrapMode::ClampToEdge;
-    texSetup.Sampler.WrapV = TextureWrapMode::ClampToEdge;
-    this->boneTexture = Gfx::CreateResource(texSetup);
+    this->texShader = Gfx::CreateResource(LambertTexShader::Setup());
+    this->dqShader = Gfx::CreateResource(LambertDQShader::Setup());
+    this->diffShader = Gfx::CreateResource(SkinDiffShader::Setup());
+
+    // RGBA16F textures for the animated skeleton bone info, the Anim
+    // module's RGBA32F table is converted before upload, RGBA32F is used
+    // if half-float textures are not supported, the second texture holds
+    // the same skin transforms as dual quaternions
+    this->halfFloatBoneTexture = Gfx::QueryFeature(GfxFeature::TextureHalfFloat);
+    this->boneTexture = this->createBoneTexture(BoneTextureWidth, BoneTextureHeight);
+    this->dqBoneTexture = this->createBoneTexture(DQBoneTextureWidth, BoneTextureHeight);
     this->imguiBoneTextureId = IMUI::AllocImage();
     IMUI::BindImage(this->imguiBoneTextureId, this->boneTexture);
 
+    // material textures are streamed in by their size on screen
+    this->streamTextures = OryolArgs.HasArg("-textures");
+    this->textures.Setup(32 * 1024 * 1024, 1024 * 1024);
+
     // load the dragon.orb file (the .txt extension is a hack
     // so that github pages compresses the file)
     this->loadModel("orb:dragon.orb.txt");
@@ -137,36 +198,123 @@ Main::OnRunning() {
 
         // upload bone info to GPU texture
         const AnimSkinMatrixInfo& boneInfo = Anim::SkinMatrixInfo();
-        this->model.vsParams.skin_info = boneInfo.InstanceInfos[0].ShaderInfo;
-        ImageDataAttrs imgAttrs;
-        imgAttrs.NumFaces = 1;
-        imgAttrs.NumMipMaps = 1;
-        imgAttrs.Offsets[0][0] = 0;
-        imgAttrs.Sizes[0][0] = boneInfo.SkinMatrixTableByteSize;
-        Gfx::UpdateTexture(this->boneTexture, boneInfo.SkinMatrixTable, imgAttrs);
+        const glm::vec4& skinInfo = boneInfo.InstanceInfos[0].ShaderInfo;
+        const int numValues = boneInfo.SkinMatrixTableByteSize / sizeof(float);
+        if (SkinMode::Matrix != this->ui.skinMode) {
+            // convert each 3-texel skin matrix into a 2-texel dual
+            // quaternion, the instance's texel offset scales by 2/3
+            const int numBones = numValues / 12;
+            if (this->dqBoneTable.Size() != (numBones * DualQuatSkin::NumValuesPerBone)) {
+                this->dqBoneTable.Clear();
+                this->dqBoneTable.Reserve(numBones * DualQuatSkin::NumValuesPerBone);
+                for (int i = 0; i < numBones * DualQuatSkin::NumValuesPerBone; i++) {
+                    this->dqBoneTable.Add(0.0f);
+                }
+            }
+            DualQuatSkin::FromMatrixRows(boneInfo.SkinMatrixTable, numBones, &this->dqBoneTable[0]);
+            this->uploadBoneTexture(this->dqBoneTexture, &this->dqBoneTable[0], this->dqBoneTable.Size(), this->halfDQBoneTable);
+            const float dqX = ((skinInfo.x * BoneTextureWidth - 0.5f) * 2.0f) / 3.0f;
+            const glm::vec4 dqSkinInfo((dqX + 0.5f) / DQBoneTextureWidth, skinInfo.y, float(DQBoneTextureWidth), 0.0f);
+            this->model.dqVsParams.dq_skin_info = dqSkinInfo;
+            this->model.diffVsParams.dq_skin_info = dqSkinInfo;
+        }
+        if (SkinMode::DualQuat != this->ui.skinMode) {
+            this->uploadBoneTexture(this->boneTexture, boneInfo.SkinMatrixTable, numValues, this->halfBoneTable);
+        }
+        this->model.vsParams.skin_info = skinInfo;
+        this->model.texVsParams.skin_info = skinInfo;
+        this->model.diffVsParams.skin_info = skinInfo;
+    }
+
+    // request texture detail for each model by its size on screen,
+    // and create or grow the textures
+    if (this->ui.texturesEnabled) {
+        for (int i = 0; i <= NumCopies; i++) {
+            if (this->orbModel(i).IsValid) {
+                this->textures.UseModel(this->orbModel(i), this->screenSize(i));
+            }
+        }
+    }
+    this->textures.Update();
+
+    // upload the pool mesh if models have been added
+    if (this->pool.IsValid()) {
+        this->pool.Update();
     }
 
     Gfx::BeginPass();
     if (this->model.orb.IsValid) {
         if (this->ui.meshEnabled) {
+            // all models live in the pool mesh, the draw state only
+            // changes per submesh for the material texture, each model
+            // is drawn with its own transform and the index range of
+            // its copy of the submesh
+            const bool textured = this->ui.texturesEnabled && this->model.texPipeline.IsValid() &&
+                                  (SkinMode::Matrix == this->ui.skinMode);
             DrawState drawState;
-            drawState.Pipeline = this->model.pipeline;
-            drawState.Mesh[0] = this->model.orb.Mesh;
-            drawState.VSTexture[LambertShader::boneTex] = this->boneTexture;
-            Gfx::ApplyDrawState(drawState);
+            drawState.Mesh[0] = this->pool.Mesh();
+            if (textured) {
+                drawState.Pipeline = this->model.texPipeline;
+                drawState.VSTexture[LambertTexShader::boneTex] = this->boneTexture;
+            }
+            else if (SkinMode::Matrix == this->ui.skinMode) {
+                drawState.Pipeline = this->model.pipeline;
+                drawState.VSTexture[LambertShader::boneTex] = this->boneTexture;
+            }
+            else if (SkinMode::DualQuat == this->ui.skinMode) {
+                drawState.Pipeline = this->model.dqPipeline;
+                drawState.VSTexture[LambertDQShader::dqBoneTex] = this->dqBoneTexture;
+            }
+            else {
+                drawState.Pipeline = this->model.diffPipeline;
+                drawState.VSTexture[SkinDiffShader::boneTex] = this->boneTexture;
+                drawState.VSTexture[SkinDiffShader::dqBoneTex] = this->dqBoneTexture;
+            }
             /*
             LambertShader::lightParams lightParams;
             lightParams.lightColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
             lightParams.lightDir = glm::normalize(glm::vec3(0.5f, 1.0f, 0.25f));
             Gfx::ApplyUniformBlock(lightParams);
             */
-            this->model.vsParams.model = glm::mat4();
-            this->model.vsParams.mvp = this->camera.ViewProj * this->model.vsParams.model;
-            Gfx::ApplyUniformBlock(this->model.vsParams);
-            for (const auto& subMesh : this->model.orb.Submeshes) {
-                if (subMesh.Visible) {
-                    //Gfx::ApplyUniformBlock(this->model.materials[subMesh.material].matParams);
-                    Gfx::Draw(subMesh.PrimitiveGroupIndex);
+            const auto& submeshes = this->model.orb.Submeshes;
+            for (int subMeshIndex = 0; subMeshIndex < submeshes.Size(); subMeshIndex++) {
+                if (!submeshes[subMeshIndex].Visible) {
+                    continue;
+                }
+                if (textured) {
+                    const int diffMap = diffuseMap(this->model.orb, submeshes[subMeshIndex].MaterialIndex);
+                    drawState.FSTexture[LambertTexShader::diffTex] = this->textures.Texture(diffMap);
+                }
+                Gfx::ApplyDrawState(drawState);
+                for (int i = 0; i <= NumCopies; i++) {
+                    const OrbModel& orb = this->orbModel(i);
+                    if (!orb.IsValid) {
+                        continue;
+                    }
+                    const glm::mat4 modelMatrix = glm::translate(glm::mat4(1.0f), this->modelPosition(i));
+                    const glm::mat4 mvp = this->camera.ViewProj * modelMatrix;
+                    if (textured) {
+                        this->model.texVsParams.model = modelMatrix;
+                        this->model.texVsParams.mvp = mvp;
+                        Gfx::ApplyUniformBlock(this->model.texVsParams);
+                    }
+                    else if (SkinMode::Matrix == this->ui.skinMode) {
+                        this->model.vsParams.model = modelMatrix;
+                        this->model.vsParams.mvp = mvp;
+                        Gfx::ApplyUniformBlock(this->model.vsParams);
+                    }
+                    else if (SkinMode::DualQuat == this->ui.skinMode) {
+                        this->model.dqVsParams.model = modelMatrix;
+                        this->model.dqVsParams.mvp = mvp;
+                        Gfx::ApplyUniformBlock(this->model.dqVsParams);
+                    }
+                    else {
+                        this->model.diffVsParams.mvp = mvp;
+                        this->model.diffVsParams.diff_scale = glm::vec4(this->ui.diffScale, 0.0f, 0.0f, 0.0f);
+                        Gfx::ApplyUniformBlock(this->model.diffVsParams);
+                    }
+                    const auto& subMesh = orb.Submeshes[subMeshIndex];
+                    Gfx::Draw(PrimitiveGroup(subMesh.FirstIndex, subMesh.NumIndices));
                 }
             }
         }
@@ -185,6 +333,10 @@ Main::OnRunning() {
 //------------------------------------------------------------------------------
 AppState::Code
 Main::OnCleanup() {
+    if (this->pool.IsValid()) {
+        this->pool.Discard();
+    }
+    this->textures.Discard();
     this->wireframe.Discard();
     IMUI::Discard();
     Input::Discard();
@@ -229,6 +381,15 @@ Main::drawMainWindow() {
         if (ImGui::Button("1.5x")) { this->ui.timeScale = 1.5f; }; ImGui::SameLine();
         if (ImGui::Button("2.0x")) { this->ui.timeScale = 2.0f; };
         ImGui::Checkbox("draw mesh", &this->ui.meshEnabled);
+        if (this->model.texPipeline.IsValid()) {
+            ImGui::Checkbox("textures", &this->ui.texturesEnabled);
+            ImGui::Text("textures: %d KB resident, %d loading",
+                this->textures.NumResidentBytes() / 1024, this->textures.NumPending());
+        }
+        ImGui::Combo("skinning", &this->ui.skinMode, "matrix\0dual quaternion\0diff (red: mismatch)\0");
+        if (SkinMode::Diff == this->ui.skinMode) {
+            ImGui::SliderFloat("diff scale", &this->ui.diffScale, 1.0f, 1000.0f, "%.0f", 2.0f);
+        }
         ImGui::Checkbox("draw bind pose", &this->ui.bindPoseEnabled);
         ImGui::Checkbox("draw clip static pose", &this->ui.staticPoseEnabled);
         ImGui::Checkbox("draw animated pose", &this->ui.animatedPoseEnabled);
@@ -330,14 +491,26 @@ Main::drawBoneTextureWindow() {
     ImGui::End();
 }
 
+//------------------------------------------------------------------------------
+static glm::mat4
+trsMatrix(float tx, float ty, float tz, const glm::quat& r, float sx, float sy, float sz) {
+    // same as translate * rotate * scale, without the matrix multiplies
+    glm::mat4 m = glm::mat4_cast(r);
+    m[0] *= sx;
+    m[1] *= sy;
+    m[2] *= sz;
+    m[3] = glm::vec4(tx, ty, tz, 1.0f);
+    return m;
+}
+
 //------------------------------------------------------------------------------
 void
 Main::drawModelDebug(const Model& model, const glm::mat4& modelTransform) {
     const AnimSkeleton& skel = Anim::Skeleton(model.orb.Skeleton);
     const AnimLibrary& lib = Anim::Library(model.orb.AnimLib);
     const AnimClip& clip = lib.Clips[this->ui.animJob.ClipIndex];
-    glm::vec3 t, s;
-    glm::quat r;
+    o_assert_dbg(this->dbgPose.Size() >= skel.NumBones);
+    glm::mat4* pose = &this->dbgPose[0];
 
     auto& wf = this->wireframe;
     wf.Model = modelTransform;
@@ -356,72 +529,87 @@ Main::drawModelDebug(const Model& model, const glm::mat4& modelTransform) {
     // draw current clip's static pose matrix
     if (this->ui.staticPoseEnabled) {
         o_assert(clip.Curves.Size() == skel.NumBones * 3);
-        this->dbgPose.Clear();
-        this->dbgPose.Reserve(skel.NumBones);
         wf.Color = glm::vec4(0.0f, 1.0f, 0.0f, 1.0f);
         for (int i = 0; i < skel.NumBones; i++) {
-            const AnimCurve& tCurve = clip.Curves[i*3 + 0];
-            const AnimCurve& rCurve = clip.Curves[i*3 + 1];
-            const AnimCurve& sCurve = clip.Curves[i*3 + 2];
-            t = glm::vec3(tCurve.StaticValue[0], tCurve.StaticValue[1], tCurve.StaticValue[2]);
-            r = glm::quat(rCurve.StaticValue[3], rCurve.StaticValue[0], rCurve.StaticValue[1], rCurve.StaticValue[2]);
-            s = glm::vec3(sCurve.StaticValue[0], sCurve.StaticValue[1], sCurve.StaticValue[2]);
-            const glm::mat4 tm = glm::translate(glm::mat4(), t);
-            const glm::mat4 rm = glm::mat4_cast(r);
-            const glm::mat4 sm = glm::scale(glm::mat4(), s);
-            glm::mat4 m = tm * rm * sm;
+            const glm::vec4& t = clip.Curves[i*3 + 0].StaticValue;
+            const glm::vec4& r = clip.Curves[i*3 + 1].StaticValue;
+            const glm::vec4& s = clip.Curves[i*3 + 2].StaticValue;
+            glm::mat4 m = trsMatrix(t.x, t.y, t.z, glm::quat(r.w, r.x, r.y, r.z), s.x, s.y, s.z);
             const int parent = skel.ParentIndices[i];
             if (parent != -1) {
-                m = this->dbgPose[parent] * m;
-                wf.Line(m[3], this->dbgPose[parent][3]);
+                m = pose[parent] * m;
+                wf.Line(m[3], pose[parent][3]);
             }
-            this->dbgPose.Add(m);
+            pose[i] = m;
         }
     }
 
-    // draw current animation sampling/mixing result and record history
-    const int histIndex = this->frameIndex % HistorySize;
-    this->dbgHistory[histIndex].Clear();
-    this->dbgHistory[histIndex].Reserve(skel.NumBones);
-    this->dbgPose.Clear();
+    // draw current animation sampling/mixing result and record history,
+    // a new history slot is only recorded when time has advanced
+    auto& trails = this->jointTrails;
+    const bool recordTrails = this->ui.jointTrailsEnabled && (this->frameIndex != trails.frameIndex);
+    if (!this->ui.jointTrailsEnabled) {
+        trails.count = 0;
+    }
+    if (recordTrails) {
+        trails.frameIndex = this->frameIndex;
+        trails.head = (trails.head + 1) & (HistorySize-1);
+        if (trails.count < int(HistorySize)) {
+            trails.count++;
+        }
+    }
+    float* histX = &trails.x[trails.head * trails.numBones];
+    float* histY = &trails.y[trails.head * trails.numBones];
+    float* histZ = &trails.z[trails.head * trails.numBones];
     wf.Color = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
     const Slice<float>& samples = Anim::Samples(model.animInstance);
-    for (int boneIndex=0, i=0; boneIndex<skel.NumBones; boneIndex++, i+=10) {
-        t = glm::vec3(samples[i+0], samples[i+1], samples[i+2]);
-        r = glm::quat(samples[i+6], samples[i+3], samples[i+4], samples[i+5]);
-        s = glm::vec3(samples[i+7], samples[i+8], samples[i+9]);
-        const glm::mat4 tm = glm::translate(glm::mat4(), t);
-        const glm::mat4 rm = glm::mat4_cast(r);
-        const glm::mat4 sm = glm::scale(glm::mat4(), s);
-        glm::mat4 m = tm * rm * sm;
+    const float* smp = &samples[0];
+    for (int boneIndex = 0; boneIndex < skel.NumBones; boneIndex++, smp += 10) {
+        glm::mat4 m = trsMatrix(smp[0], smp[1], smp[2], glm::quat(smp[6], smp[3], smp[4], smp[5]), smp[7], smp[8], smp[9]);
         const int parent = skel.ParentIndices[boneIndex];
         if (parent != -1) {
-            m = this->dbgPose[parent] * m;
+            m = pose[parent] * m;
             if (this->ui.animatedPoseEnabled) {
-                wf.Line(m[3], this->dbgPose[parent][3]);
+                wf.Line(m[3], pose[parent][3]);
             }
         }
-        this->dbgPose.Add(m);
-        if (this->ui.jointTrailsEnabled) {
-            this->dbgHistory[histIndex].Add(m[3]);
+        pose[boneIndex] = m;
+        if (recordTrails) {
+            histX[boneIndex] = m[3].x;
+            histY[boneIndex] = m[3].y;
+            histZ[boneIndex] = m[3].z;
         }
     }
 
-    // draw the bone history
-    glm::vec3 move(0.0f, 0.0f, -0.1f);
-    glm::vec4 fade(-1.0f/float(HistorySize), 0.0f, 0.0f, -1.0/float(HistorySize));
-    for (uint32_t boneIndex = 0; boneIndex < (uint32_t)skel.NumBones; boneIndex++) {
-        for (uint32_t i = 0; i < HistorySize-1; i++) {
-            uint32_t hi0 = (histIndex - i) & (HistorySize-1);
-            uint32_t hi1 = (hi0 - 1) & (HistorySize-1);
-            glm::vec3 d0 = move * float(i);
-            glm::vec3 d1 = move * float(i + 1);
-            wf.Color = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f) + fade * float(i);
-            if (!this->dbgHistory[hi0].Empty() && !this->dbgHistory[hi1].Empty()) {
-                wf.Line(this->dbgHistory[hi0][boneIndex] + d0,
-                        this->dbgHistory[hi1][boneIndex] + d1);
+    // draw the bone history in one batch, each segment connects the
+    // same joint in 2 adjacent history slots, moving away over time
+    if (trails.count > 1) {
+        const float move = -0.1f;
+        const int numSegs = trails.count - 1;
+        glm::vec4* points = &trails.points[0];
+        glm::vec4* colors = &trails.colors[0];
+        int numPoints = 0;
+        for (int i = 0; i < numSegs; i++) {
+            const int slot0 = (trails.head - i) & (HistorySize-1);
+            const int slot1 = (slot0 - 1) & (HistorySize-1);
+            const float* x0 = &trails.x[slot0 * trails.numBones];
+            const float* y0 = &trails.y[slot0 * trails.numBones];
+            const float* z0 = &trails.z[slot0 * trails.numBones];
+            const float* x1 = &trails.x[slot1 * trails.numBones];
+            const float* y1 = &trails.y[slot1 * trails.numBones];
+            const float* z1 = &trails.z[slot1 * trails.numBones];
+            const float d0 = move * float(i);
+            const float d1 = move * float(i + 1);
+            const float fade = float(i) / float(HistorySize);
+            const glm::vec4 color(1.0f - fade, 1.0f, 0.0f, 1.0f - fade);
+            for (int boneIndex = 0; boneIndex < skel.NumBones; boneIndex++) {
+                points[numPoints] = glm::vec4(x0[boneIndex], y0[boneIndex], z0[boneIndex] + d0, 1.0f);
+                colors[numPoints++] = color;
+                points[numPoints] = glm::vec4(x1[boneIndex], y1[boneIndex], z1[boneIndex] + d1, 1.0f);
+                colors[numPoints++] = color;
             }
         }
+        wf.Lines(points, colors, numPoints);
     }
 }
 
@@ -430,20 +618,45 @@ void
 Main::loadModel(const Locator& loc) {
     // start loading the .orb file
     IO::Load(loc.Location(), [this](IO::LoadResult res) {
+        // the pool is sized for the model and its copies, and must
+        // have the model's vertex layout
+        MeshSetup meshSetup;
+        if (!OrbLoader::LoadMeshSetup(res.Data, meshSetup)) {
+            return;
+        }
+        const int numModels = NumCopies + 1;
+        this->pool.Setup(meshSetup.Layout, numModels * meshSetup.NumVertices, numModels * meshSetup.NumIndices);
+        OrbLoader::Options options;
+        options.Pool = &this->pool;
+        if (this->streamTextures) {
+            // only the diffuse map is sampled by the textured shader
+            options.Textures = &this->textures;
+            options.TextureName = "DiffMap0";
+            options.TexturePath = "orb:";
+            options.TextureExt = ".dds";
+        }
+
         auto& orb = this->model.orb;
-        if (OrbLoader::Load(res.Data, "model", orb)) {
+        if (OrbLoader::Load(res.Data, "model", orb, options)) {
             orb.Submeshes[0].Visible = true;
+            for (int i = 0; i < NumCopies; i++) {
+                StringBuilder strBuilder;
+                strBuilder.Format(32, "copy%d", i);
+                OrbLoader::Load(res.Data, strBuilder.GetString(), this->copies[i], options);
+            }
 
-            auto pipSetup = PipelineSetup::FromLayoutAndShader(orb.MeshSetup.Layout, this->shader);
-            pipSetup.DepthStencilState.DepthWriteEnabled = true;
-            pipSetup.DepthStencilState.DepthCmpFunc = CompareFunc::LessEqual;
-            pipSetup.RasterizerState.CullFaceEnabled = true;
-            pipSetup.RasterizerState.SampleCount = this->gfxSetup.SampleCount;
-            pipSetup.BlendState.ColorFormat = this->gfxSetup.ColorFormat;
-            pipSetup.BlendState.DepthFormat = this->gfxSetup.DepthFormat;
-            this->model.pipeline = Gfx::CreateResource(pipSetup);
+            this->model.pipeline = this->createPipeline(this->shader, orb.MeshSetup.Layout);
+            if (this->streamTextures && orb.MeshSetup.Layout.Contains(VertexAttr::TexCoord0)) {
+                this->model.texPipeline = this->createPipeline(this->texShader, orb.MeshSetup.Layout);
+            }
+            this->model.dqPipeline = this->createPipeline(this->dqShader, orb.MeshSetup.Layout);
+            this->model.diffPipeline = this->createPipeline(this->diffShader, orb.MeshSetup.Layout);
             this->model.vsParams.vtx_mag = orb.VertexMagnitude;
+            this->model.texVsParams.vtx_mag = orb.VertexMagnitude;
+            this->model.dqVsParams.vtx_mag = orb.VertexMagnitude;
+            this->model.diffVsParams.vtx_mag = orb.VertexMagnitude;
 
+            this->setupJointTrails(Anim::Skeleton(orb.Skeleton).NumBones);
             if (orb.AnimLib.IsValid()) {
                 auto instSetup = AnimInstanceSetup::FromLibraryAndSkeleton(orb.AnimLib, orb.Skeleton);
                 this->model.animInstance = Anim::Create(instSetup);
@@ -459,3 +672,129 @@ Main::loadModel(const Locator& loc) {
         Log::Error("Failed to load file '%s' with '%s'\n", url.AsCStr(), IOStatus::ToString(ioStatus));
     });
 }
+
+//------------------------------------------------------------------------------
+const OrbModel&
+Main::orbModel(int index) const {
+    return (0 == index) ? this->model.orb : this->copies[index - 1];
+}
+
+//------------------------------------------------------------------------------
+glm::vec3
+Main::modelPosition(int index) const {
+    // copies stand to the left and right behind the model
+    if (0 == index) {
+        return glm::vec3(0.0f);
+    }
+    const float x = (1 == (index & 1)) ? -5.0f : 5.0f;
+    return glm::vec3(x, 0.0f, -5.0f * ((index + 1) / 2));
+}
+
+//------------------------------------------------------------------------------
+float
+Main::screenSize(int index) const {
+    // bounds are only known for cooked .orb files, otherwise
+    // assume the size of the dragon
+    const OrbModel& orb = this->orbModel(index);
+    float radius = 0.5f * glm::length(orb.Bounds.Max - orb.Bounds.Min);
+    if (radius <= 0.0f) {
+        radius = 2.5f;
+    }
+    const float dist = glm::max(glm::length(this->camera.EyePos - this->modelPosition(index)), this->camera.NearZ);
+    return (radius * this->camera.Proj[1][1] * float(this->camera.fbHeight)) / dist;
+}
+
+//------------------------------------------------------------------------------
+int
+Main::diffuseMap(const OrbModel& orb, int materialIndex) {
+    if (materialIndex < orb.Materials.Size()) {
+        for (const auto& tex : orb.Materials[materialIndex].Textures) {
+            if (tex.Name == "DiffMap0") {
+                return tex.Stream;
+            }
+        }
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+Id
+Main::createBoneTexture(int width, int height) {
+    const PixelFormat::Code fmt = this->halfFloatBoneTexture ? PixelFormat::RGBA16F : PixelFormat::RGBA32F;
+    auto texSetup = TextureSetup::Empty2D(width, height, 1, fmt, Usage::Stream);
+    texSetup.Sampler.MinFilter = TextureFilterMode::Nearest;
+    texSetup.Sampler.MagFilter = TextureFilterMode::Nearest;
+    texSetup.Sampler.WrapU = TextureWrapMode::ClampToEdge;
+    texSetup.Sampler.WrapV = TextureWrapMode::ClampToEdge;
+    return Gfx::CreateResource(texSetup);
+}
+
+//------------------------------------------------------------------------------
+void
+Main::uploadBoneTexture(Id tex, const float* values, int numValues, Array<uint16_t>& halfBuffer) {
+    ImageDataAttrs imgAttrs;
+    imgAttrs.NumFaces = 1;
+    imgAttrs.NumMipMaps = 1;
+    imgAttrs.Offsets[0][0] = 0;
+    if (this->halfFloatBoneTexture) {
+        if (halfBuffer.Size() != numValues) {
+            halfBuffer.Clear();
+            halfBuffer.Reserve(numValues);
+            for (int i = 0; i < numValues; i++) {
+                halfBuffer.Add(0);
+            }
+        }
+        HalfFloat::Convert(values, &halfBuffer[0], numValues);
+        imgAttrs.Sizes[0][0] = numValues * sizeof(uint16_t);
+        Gfx::UpdateTexture(tex, &halfBuffer[0], imgAttrs);
+    }
+    else {
+        imgAttrs.Sizes[0][0] = numValues * sizeof(float);
+        Gfx::UpdateTexture(tex, values, imgAttrs);
+    }
+}
+
+//------------------------------------------------------------------------------
+Id
+Main::createPipeline(Id shd, const VertexLayout& layout) {
+    auto pipSetup = PipelineSetup::FromLayoutAndShader(layout, shd);
+    pipSetup.DepthStencilState.DepthWriteEnabled = true;
+    pipSetup.DepthStencilState.DepthCmpFunc = CompareFunc::LessEqual;
+    pipSetup.RasterizerState.CullFaceEnabled = true;
+    pipSetup.RasterizerState.SampleCount = this->gfxSetup.SampleCount;
+    pipSetup.BlendState.ColorFormat = this->gfxSetup.ColorFormat;
+    pipSetup.BlendState.DepthFormat = this->gfxSetup.DepthFormat;
+    return Gfx::CreateResource(pipSetup);
+}
+
+//------------------------------------------------------------------------------
+void
+Main::setupJointTrails(int numBones) {
+    auto& trails = this->jointTrails;
+    trails.numBones = numBones;
+    trails.head = 0;
+    trails.count = 0;
+    const int numSlotValues = HistorySize * numBones;
+    const int numPoints = (HistorySize - 1) * numBones * 2;
+    Array<float>* slotArrays[3] = { &trails.x, &trails.y, &trails.z };
+    for (Array<float>* a : slotArrays) {
+        a->Clear();
+        a->Reserve(numSlotValues);
+        for (int i = 0; i < numSlotValues; i++) {
+            a->Add(0.0f);
+        }
+    }
+    trails.points.Clear();
+    trails.colors.Clear();
+    trails.points.Reserve(numPoints);
+    trails.colors.Reserve(numPoints);
+    for (int i = 0; i < numPoints; i++) {
+        trails.points.Add();
+        trails.colors.Add();
+    }
+    this->dbgPose.Clear();
+    this->dbgPose.Reserve(numBones);
+    for (int i = 0; i < numBones; i++) {
+        this->dbgPose.Add();
+    }
+}
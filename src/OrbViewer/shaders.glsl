@@ -7,6 +7,9 @@ vec4 gamma(vec4 c) {
 @end
 
 @block SkinUtil
+// the bone texture holds 3 transposed matrix rows per bone, either as
+// RGBA32F or RGBA16F, both formats are sampled as float so the decoding
+// is identical
 void skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, out vec4 skin_pos) {
     vec4 weights = skin_weights / dot(skin_weights, vec4(1.0));
     vec2 step = vec2(1.0 / skin_info.z, 0.0);
@@ -47,6 +50,51 @@ void skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, out ve
 }
 @end
 
+@block SkinUtilDQ
+// dual quaternion skinning, dqBoneTex holds 2 texels per bone,
+// the rotation quaternion and the dual part
+void dq_fetch(in float bone_index, in vec4 skin_info, out vec4 real, out vec4 dual) {
+    vec2 uv = vec2(skin_info.x + (2.0*bone_index)/skin_info.z, skin_info.y);
+    real = textureLod(dqBoneTex, uv, 0.0);
+    dual = textureLod(dqBoneTex, uv + vec2(1.0 / skin_info.z, 0.0), 0.0);
+}
+
+void dq_skinned_pos(in vec4 pos, in vec4 skin_weights, in vec4 skin_indices, in vec4 skin_info, out vec4 skin_pos) {
+    vec4 weights = skin_weights / dot(skin_weights, vec4(1.0));
+    vec4 r0, d0, r, d;
+    dq_fetch(skin_indices.x, skin_info, r0, d0);
+    vec4 b_real = r0 * weights.x;
+    vec4 b_dual = d0 * weights.x;
+    // blend along the shortest path relative to the first bone
+    if (weights.y > 0.0) {
+        dq_fetch(skin_indices.y, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.y : weights.y;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    if (weights.z > 0.0) {
+        dq_fetch(skin_indices.z, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.z : weights.z;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    if (weights.w > 0.0) {
+        dq_fetch(skin_indices.w, skin_info, r, d);
+        float w = dot(r0, r) < 0.0 ? -weights.w : weights.w;
+        b_real += r * w;
+        b_dual += d * w;
+    }
+    float len = length(b_real);
+    b_real /= len;
+    b_dual /= len;
+    // rotate, then add translation 2 * dual * conjugate(real)
+    vec3 p = pos.xyz;
+    p += 2.0 * cross(b_real.xyz, cross(b_real.xyz, p) + b_real.w * p);
+    p += 2.0 * (b_real.w * b_dual.xyz - b_dual.w * b_real.xyz + cross(b_real.xyz, b_dual.xyz));
+    skin_pos = vec4(p, 1.0);
+}
+@end
+
 @vs lambertVS
 uniform vsParams {
     mat4 mvp;
@@ -93,5 +141,113 @@ void main() {
 
 @program LambertShader lambertVS lambertFS
 
+// matrix skinning with the material's diffuse texture, only used if
+// the model has texture coordinates
+@vs lambertTexVS
+uniform vsParams {
+    mat4 mvp;
+    mat4 model;
+    vec4 vtx_mag;
+    vec4 skin_info;
+};
+uniform sampler2D boneTex;
+
+@include SkinUtil
+
+in vec4 position;
+in vec3 normal;
+in vec2 texcoord0;
+in vec4 weights;
+in vec4 indices;
+out vec3 N;
+out vec2 texUV;
+void main() {
+    vec4 pos;
+    skinned_pos(position * vtx_mag, weights, indices * 255.0, pos);
+    gl_Position = mvp * pos;
+    N = (model * vec4(normal, 0.0)).xyz;
+    texUV = texcoord0;
+}
+@end
+
+@fs lambertTexFS
+uniform sampler2D diffTex;
+in vec3 N;
+in vec2 texUV;
+out vec4 fragColor;
+
+void main() {
+    vec3 n = normalize(N);
+    float l = dot(n, normalize(vec3(0.5, 1.0, 0.25))) * 0.5 + 0.5;
+    fragColor = vec4(texture(diffTex, texUV).xyz * l, 1.0);
+}
+@end
 
+@program LambertTexShader lambertTexVS lambertTexFS
+
+@vs lambertDQVS
+uniform vsParams {
+    mat4 mvp;
+    mat4 model;
+    vec4 vtx_mag;
+    vec4 dq_skin_info;
+};
+uniform sampler2D dqBoneTex;
+
+@include SkinUtilDQ
+
+in vec4 position;
+in vec3 normal;
+in vec4 weights;
+in vec4 indices;
+out vec3 N;
+void main() {
+    vec4 pos;
+    dq_skinned_pos(position * vtx_mag, weights, indices * 255.0, dq_skin_info, pos);
+    gl_Position = mvp * pos;
+    N = (model * vec4(normal, 0.0)).xyz;
+}
+@end
+
+@program LambertDQShader lambertDQVS lambertFS
+
+// visual diff between matrix and dual quaternion skinning, the mesh
+// is rendered with matrix skinning, the color shows the distance to the
+// dual quaternion skinned position (black: none, red: >= 1/diff_scale.x)
+@vs skinDiffVS
+uniform vsParams {
+    mat4 mvp;
+    vec4 vtx_mag;
+    vec4 skin_info;
+    vec4 dq_skin_info;
+    vec4 diff_scale;
+};
+uniform sampler2D boneTex;
+uniform sampler2D dqBoneTex;
+
+@include SkinUtil
+@include SkinUtilDQ
+
+in vec4 position;
+in vec4 weights;
+in vec4 indices;
+out vec4 color;
+void main() {
+    vec4 mat_pos, dq_pos;
+    skinned_pos(position * vtx_mag, weights, indices * 255.0, mat_pos);
+    dq_skinned_pos(position * vtx_mag, weights, indices * 255.0, dq_skin_info, dq_pos);
+    gl_Position = mvp * mat_pos;
+    float d = clamp(length(mat_pos.xyz - dq_pos.xyz) * diff_scale.x, 0.0, 1.0);
+    color = vec4(mix(vec3(0.25), vec3(1.0, 0.0, 0.0), d), 1.0);
+}
+@end
+
+@fs diffFS
+in vec4 color;
+out vec4 fragColor;
+void main() {
+    fragColor = color;
+}
+@end
 
+@program SkinDiffShader skinDiffVS diffFS